@@ -0,0 +1,675 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/*
+Standalone benchmark of the symmetry core. The solver, seeding, validation,
+table encoding, checksums and index helpers are built without Maya and run
+on generated symmetrical meshes, so that their speed can be compared between
+versions of the plugin.
+
+    polySymmetryBenchmark [options]
+
+    --shapes grid,torus,shells      meshes to generate
+    --faces 10000,100000,1000000    approximate face counts to generate
+    --repeat 3                      runs per mesh; the fastest run of each stage is kept
+    --csv <path>                    writes the results as CSV
+    --baseline <path>               compares the results to a CSV written by --csv
+    --max-regression 0.25           fraction a stage may be slower than the baseline
+
+Exits with 1 if a stage regressed against the baseline, and 2 if a mesh did
+not solve to valid symmetry tables. Open meshes are also solved from a seed
+on their border, whose faces have edges the solver only reaches from the
+seed itself.
+*/
+
+#include "meshGenerator.h"
+
+#include "../src/componentSelection.h"
+#include "../src/meshTopology.h"
+#include "../src/polyChecksum.h"
+#include "../src/polySymmetry.h"
+#include "../src/symmetrySeeds.h"
+#include "../src/symmetryTables.h"
+#include "../src/symmetryValidation.h"
+#include "../src/util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// Stages faster than this are not checked against the baseline, since their timings are mostly noise.
+#define MINIMUM_CHECKED_SECONDS 0.005
+
+// Seeding tolerance used by polySymmetry when none is given, as a fraction of the bounding box diagonal.
+#define RELATIVE_TOLERANCE 0.001
+
+struct StageResult
+{
+    string          name;
+    double          seconds;
+};
+
+struct CaseResult
+{
+    string          shape;
+    int             numberOfFaces;
+    double          peakBytes;
+    bool            isValid;
+    int             unmatchedBorderComponents;
+
+    vector<StageResult> stages;
+};
+
+struct BenchmarkOptions
+{
+    vector<string>  shapes = { "grid", "torus", "shells" };
+    vector<int>     faceCounts = { 10000, 100000, 1000000 };
+    int             repeat = 3;
+
+    string          csvPath;
+    string          baselinePath;
+    double          maximumRegression = 0.25;
+};
+
+/*
+    The high water mark of the process can only be reset on Linux. Elsewhere
+    the peak of a mesh includes the meshes before it, so they are run from
+    the smallest up.
+*/
+static void resetPeakMemory()
+{
+#ifdef __linux__
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+static double getPeakMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return (double) counters.PeakWorkingSetSize;
+#elif defined(__linux__)
+    ifstream status("/proc/self/status");
+    string line;
+
+    while (getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0) { return atof(line.c_str() + 6) * 1024.0; }
+    }
+
+    return 0.0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double) usage.ru_maxrss;
+#endif
+}
+
+static double timeStage(const function<void()> &fn)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    fn();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+static void generateMesh(const string &shape, int numberOfFaces, GeneratedMesh &mesh)
+{
+    if (shape == "grid")
+    {
+        generateGrid(numberOfFaces, mesh);
+    } else if (shape == "torus") {
+        generateTorus(numberOfFaces, mesh);
+    } else {
+        generateShells(numberOfFaces, mesh);
+    }
+}
+
+static float getTolerance(const GeneratedMesh &mesh)
+{
+    float lo[3] = {  HUGE_VALF,  HUGE_VALF,  HUGE_VALF };
+    float hi[3] = { -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+
+    for (int i = 0; i < mesh.numberOfVertices; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            lo[c] = min(lo[c], mesh.points[i * 3 + c]);
+            hi[c] = max(hi[c], mesh.points[i * 3 + c]);
+        }
+    }
+
+    double diagonal = 0.0;
+
+    for (int c = 0; c < 3; c++)
+    {
+        diagonal += (double) (hi[c] - lo[c]) * (hi[c] - lo[c]);
+    }
+
+    return (float) (sqrt(diagonal) * RELATIVE_TOLERANCE);
+}
+
+/*
+    Finds a seed whose faces lie on the border of the mesh, away from the
+    center, with the seed edge inside the mesh. The solver only reaches the
+    border edges of such faces from the seed face itself, so solving from it
+    checks that they are matched. Returns false for a closed mesh.
+*/
+static bool findBorderSeed(const MeshTopology &meshData, const float* points, float tolerance, ComponentSelection &seed)
+{
+    vector<int> mirroredVertices;
+    findMirroredVertices(meshData, points, 0, tolerance, mirroredVertices);
+
+    for (int e = 0; e < meshData.numberOfEdges; e++)
+    {
+        if (meshData.edgeFaces.count(e) != 2) { continue; }
+
+        int vertex0 = meshData.edgeVertices[e][0];
+        int vertex1 = meshData.edgeVertices[e][1];
+
+        int mirroredVertex0 = mirroredVertices[vertex0];
+        int mirroredVertex1 = mirroredVertices[vertex1];
+
+        if (mirroredVertex0 == -1 || mirroredVertex1 == -1) { continue; }
+        if (points[vertex0 * 3] <= tolerance || points[vertex1 * 3] <= tolerance) { continue; }
+
+        int mirroredEdge = -1;
+
+        if (intersectionSize(meshData.vertexEdges[mirroredVertex0], meshData.vertexEdges[mirroredVertex1], mirroredEdge) != 1) { continue; }
+
+        for (const int &f : meshData.edgeFaces[e])
+        {
+            bool isOnBorder = false;
+
+            for (const int &faceEdge : meshData.faceEdges[f])
+            {
+                isOnBorder = isOnBorder || meshData.edgeFaces.count(faceEdge) == 1;
+            }
+
+            if (!isOnBorder) { continue; }
+
+            vector<int> mirroredFaceVertices;
+
+            for (const int &v : meshData.faceVertices[f])
+            {
+                if (mirroredVertices[v] == -1) { break; }
+
+                mirroredFaceVertices.push_back(mirroredVertices[v]);
+            }
+
+            if (mirroredFaceVertices.size() != meshData.faceVertices[f].size()) { continue; }
+
+            for (const int &mirroredFace : meshData.edgeFaces[mirroredEdge])
+            {
+                bool isMirror = true;
+
+                for (const int &v : mirroredFaceVertices)
+                {
+                    isMirror = isMirror && contains(meshData.faceVertices[mirroredFace], v);
+                }
+
+                if (!isMirror) { continue; }
+
+                seed.edgeIndices = pair<int, int>(e, mirroredEdge);
+                seed.faceIndices = pair<int, int>(f, mirroredFace);
+                seed.vertexIndices = pair<int, int>(vertex0, mirroredVertex0);
+                seed.leftVertexIndex = vertex0;
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+    Runs the stages polySymmetry runs on a mesh, in the same order, followed
+    by the helpers the commands run on the tables and topology. Each stage
+    keeps a value computed from its result so that it cannot be optimized
+    away, and the solved tables are validated at the end.
+*/
+static void runStages(const GeneratedMesh &mesh, vector<StageResult> &stages, bool &isValid, int &unmatchedBorderComponents)
+{
+    MeshTopology meshData;
+    PolySymmetryData symmetryData;
+
+    vector<ComponentSelection> seeds;
+    vector<int> unmatchedVertices;
+    vector<int> collidingShells;
+    vector<int> leftSideVertexIndices;
+
+    SymmetryTables tables;
+    SymmetryTables decodedTables;
+    SymmetryReport report;
+
+    vector<unsigned char> bytes;
+
+    float tolerance = getTolerance(mesh);
+    long long sink = 0;
+
+    stages.clear();
+
+    stages.push_back({ "buildTopology", timeStage([&]
+    {
+        meshData.buildTopology(mesh.numberOfVertices, mesh.faceVertexCounts, mesh.faceVertexIndices, mesh.edgeVertexIndices);
+    })});
+
+    stages.push_back({ "findSymmetrySeeds", timeStage([&]
+    {
+        findSymmetrySeeds(meshData, mesh.points.data(), 0, tolerance, seeds, unmatchedVertices);
+    })});
+
+    for (ComponentSelection &seed : seeds)
+    {
+        if (seed.leftVertexIndex != -1) { leftSideVertexIndices.push_back(seed.leftVertexIndex); }
+    }
+
+    stages.push_back({ "findSymmetricalShells", timeStage([&]
+    {
+        symmetryData.initialize(meshData);
+        symmetryData.findSymmetricalShells(seeds, collidingShells);
+    })});
+
+    stages.push_back({ "findVertexSides", timeStage([&]
+    {
+        symmetryData.findVertexSides(leftSideVertexIndices);
+    })});
+
+    stages.push_back({ "finalizeSymmetry", timeStage([&]
+    {
+        symmetryData.finalizeSymmetry();
+    })});
+
+    tables.edgeSymmetry = symmetryData.edgeSymmetryIndices;
+    tables.faceSymmetry = symmetryData.faceSymmetryIndices;
+    tables.vertexSymmetry = symmetryData.vertexSymmetryIndices;
+
+    tables.edgeSides = symmetryData.edgeSides;
+    tables.faceSides = symmetryData.faceSides;
+    tables.vertexSides = symmetryData.vertexSides;
+
+    stages.push_back({ "validateSymmetry", timeStage([&]
+    {
+        validateSymmetry(meshData, tables, mesh.points.data(), 0, tolerance, report);
+    })});
+
+    // Only open meshes have one, so the stage is missing from the results of the others.
+    ComponentSelection borderSeed;
+    SymmetryReport borderReport;
+
+    bool hasBorderSeed = findBorderSeed(meshData, mesh.points.data(), tolerance, borderSeed);
+
+    if (hasBorderSeed)
+    {
+        stages.push_back({ "solveFromBorderSeed", timeStage([&]
+        {
+            PolySymmetryData borderData;
+            vector<ComponentSelection> borderSeeds = { borderSeed };
+            vector<int> borderCollidingShells;
+            vector<int> borderLeftSideVertexIndices = { borderSeed.leftVertexIndex };
+
+            borderData.initialize(meshData);
+            borderData.findSymmetricalShells(borderSeeds, borderCollidingShells);
+            borderData.findVertexSides(borderLeftSideVertexIndices);
+            borderData.finalizeSymmetry();
+
+            SymmetryTables borderTables;
+
+            borderTables.edgeSymmetry = borderData.edgeSymmetryIndices;
+            borderTables.faceSymmetry = borderData.faceSymmetryIndices;
+            borderTables.vertexSymmetry = borderData.vertexSymmetryIndices;
+
+            borderTables.edgeSides = borderData.edgeSides;
+            borderTables.faceSides = borderData.faceSides;
+            borderTables.vertexSides = borderData.vertexSides;
+
+            validateSymmetry(meshData, borderTables, nullptr, 0, tolerance, borderReport);
+        })});
+    }
+
+    stages.push_back({ "encodeTables", timeStage([&]
+    {
+        encodeSymmetryTables(tables, bytes);
+    })});
+
+    stages.push_back({ "decodeTables", timeStage([&]
+    {
+        decodeSymmetryTables(bytes, decodedTables);
+    })});
+
+    // The stream getVertexChecksum reads from MItMeshVertex.
+    stages.push_back({ "vertexChecksum", timeStage([&]
+    {
+        vector<int> buffer;
+        buffer.reserve(meshData.numberOfVertices + meshData.vertexVertices.indices.size());
+
+        for (int i = 0; i < meshData.numberOfVertices; i++)
+        {
+            buffer.push_back(i);
+            buffer.insert(buffer.end(), meshData.vertexVertices[i].begin(), meshData.vertexVertices[i].end());
+        }
+
+        PolyChecksum checksum;
+        checksum.putBytes(buffer.data(), buffer.size() * sizeof(int));
+        sink += checksum.getResult();
+    })});
+
+    stages.push_back({ "fastChecksum", timeStage([&]
+    {
+        PolyChecksum checksum(PolyChecksum::kCRC32C);
+        checksum.putBytes(mesh.faceVertexCounts.data(), mesh.faceVertexCounts.size() * sizeof(int));
+        checksum.putBytes(mesh.faceVertexIndices.data(), mesh.faceVertexIndices.size() * sizeof(int));
+        sink += checksum.getResult();
+    })});
+
+    // The two intersections the solver runs for each edge it visits.
+    stages.push_back({ "intersection", timeStage([&]
+    {
+        vector<int> sharedFaces;
+        int sharedEdge;
+
+        for (int e = 0; e < meshData.numberOfEdges; e++)
+        {
+            IndexRange vertices = meshData.edgeVertices[e];
+
+            intersection(meshData.vertexFaces[vertices[0]], meshData.vertexFaces[vertices[1]], sharedFaces);
+            sink += (long long) sharedFaces.size();
+
+            sink += intersectionSize(meshData.vertexEdges[vertices[0]], meshData.vertexEdges[vertices[1]], sharedEdge);
+        }
+    })});
+
+    stages.push_back({ "contains", timeStage([&]
+    {
+        for (int f = 0; f < meshData.numberOfFaces; f++)
+        {
+            for (const int &v : meshData.faceVertices[f])
+            {
+                sink += contains(meshData.vertexFaces[v], f) ? 1 : 0;
+            }
+        }
+    })});
+
+    unmatchedBorderComponents = (int) (
+        borderReport.unmatchedVertices.size() 
+        + borderReport.unmatchedEdges.size() 
+        + borderReport.unmatchedFaces.size()
+    );
+
+    isValid = report.isValid()
+        && (!hasBorderSeed || borderReport.isValid())
+        && unmatchedVertices.empty()
+        && collidingShells.empty()
+        && decodedTables.vertexSymmetry == tables.vertexSymmetry
+        && sink != 0;
+}
+
+static void runCase(const string &shape, int numberOfFaces, int repeat, CaseResult &result)
+{
+    GeneratedMesh mesh;
+    generateMesh(shape, numberOfFaces, mesh);
+
+    result.shape = shape;
+    result.numberOfFaces = mesh.numberOfFaces();
+    result.isValid = true;
+    result.unmatchedBorderComponents = 0;
+    result.stages.clear();
+
+    resetPeakMemory();
+
+    for (int r = 0; r < repeat; r++)
+    {
+        vector<StageResult> stages;
+        bool isValid = false;
+        int unmatchedBorderComponents = 0;
+
+        runStages(mesh, stages, isValid, unmatchedBorderComponents);
+
+        result.unmatchedBorderComponents = max(result.unmatchedBorderComponents, unmatchedBorderComponents);
+        result.isValid = result.isValid && isValid;
+
+        if (result.stages.empty())
+        {
+            result.stages = stages;
+            continue;
+        }
+
+        for (size_t s = 0; s < stages.size(); s++)
+        {
+            result.stages[s].seconds = min(result.stages[s].seconds, stages[s].seconds);
+        }
+    }
+
+    result.peakBytes = getPeakMemory();
+}
+
+static string getResultKey(const string &shape, int numberOfFaces, const string &stage)
+{
+    ostringstream key;
+    key << shape << "," << numberOfFaces << "," << stage;
+    return key.str();
+}
+
+static bool writeResults(const string &path, vector<CaseResult> &results)
+{
+    ofstream csv(path);
+
+    if (!csv) { return false; }
+
+    csv << "shape,faces,stage,seconds,facesPerSecond,peakBytes\n";
+
+    for (CaseResult &result : results)
+    {
+        for (StageResult &stage : result.stages)
+        {
+            csv << getResultKey(result.shape, result.numberOfFaces, stage.name) << ","
+                << stage.seconds << ","
+                << result.numberOfFaces / max(stage.seconds, 1e-9) << ","
+                << result.peakBytes << "\n";
+        }
+    }
+
+    return true;
+}
+
+static bool readBaseline(const string &path, map<string, double> &baseline)
+{
+    ifstream csv(path);
+
+    if (!csv) { return false; }
+
+    string line;
+    getline(csv, line);
+
+    while (getline(csv, line))
+    {
+        vector<string> fields;
+        istringstream stream(line);
+        string field;
+
+        while (getline(stream, field, ',')) { fields.push_back(field); }
+
+        if (fields.size() < 4) { continue; }
+
+        baseline[fields[0] + "," + fields[1] + "," + fields[2]] = atof(fields[3].c_str());
+    }
+
+    return true;
+}
+
+static void printResult(CaseResult &result)
+{
+    printf("\n%s, %d faces, peak memory %.1f MB%s\n",
+        result.shape.c_str(),
+        result.numberOfFaces,
+        result.peakBytes / (1024.0 * 1024.0),
+        result.isValid ? "" : ", INVALID TABLES"
+    );
+
+    if (result.unmatchedBorderComponents != 0)
+    {
+        printf("    %d components unmatched from the border seed\n", result.unmatchedBorderComponents);
+    }
+
+    for (StageResult &stage : result.stages)
+    {
+        printf("    %-24s %10.3f ms %12.2f Mfaces/s\n",
+            stage.name.c_str(),
+            stage.seconds * 1000.0,
+            result.numberOfFaces / max(stage.seconds, 1e-9) / 1e6
+        );
+    }
+}
+
+static vector<string> splitList(const char* list)
+{
+    vector<string> items;
+    istringstream stream(list);
+    string item;
+
+    while (getline(stream, item, ','))
+    {
+        if (!item.empty()) { items.push_back(item); }
+    }
+
+    return items;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* flag = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (value == nullptr)
+        {
+            fprintf(stderr, "%s requires a value.\n", flag);
+            return false;
+        }
+
+        i++;
+
+        if (strcmp(flag, "--shapes") == 0)
+        {
+            options.shapes = splitList(value);
+
+            for (string &shape : options.shapes)
+            {
+                if (shape != "grid" && shape != "torus" && shape != "shells")
+                {
+                    fprintf(stderr, "Invalid shape %s. Expected \"grid\", \"torus\", or \"shells\".\n", shape.c_str());
+                    return false;
+                }
+            }
+        } else if (strcmp(flag, "--faces") == 0) {
+            options.faceCounts.clear();
+
+            for (string &count : splitList(value)) { options.faceCounts.push_back(max(16, atoi(count.c_str()))); }
+
+            sort(options.faceCounts.begin(), options.faceCounts.end());
+        } else if (strcmp(flag, "--repeat") == 0) {
+            options.repeat = max(1, atoi(value));
+        } else if (strcmp(flag, "--csv") == 0) {
+            options.csvPath = value;
+        } else if (strcmp(flag, "--baseline") == 0) {
+            options.baselinePath = value;
+        } else if (strcmp(flag, "--max-regression") == 0) {
+            options.maximumRegression = atof(value);
+        } else {
+            fprintf(stderr, "Unknown option %s.\n", flag);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+
+    if (!parseOptions(argc, argv, options)) { return 2; }
+
+    map<string, double> baseline;
+
+    if (!options.baselinePath.empty() && !readBaseline(options.baselinePath, baseline))
+    {
+        fprintf(stderr, "Could not read the baseline %s.\n", options.baselinePath.c_str());
+        return 2;
+    }
+
+    vector<CaseResult> results;
+    bool isValid = true;
+
+    for (int &numberOfFaces : options.faceCounts)
+    {
+        for (string &shape : options.shapes)
+        {
+            results.emplace_back();
+            runCase(shape, numberOfFaces, options.repeat, results.back());
+            printResult(results.back());
+
+            isValid = isValid && results.back().isValid;
+        }
+    }
+
+    if (!options.csvPath.empty() && !writeResults(options.csvPath, results))
+    {
+        fprintf(stderr, "Could not write the results to %s.\n", options.csvPath.c_str());
+        return 2;
+    }
+
+    if (!isValid) { return 2; }
+
+    int numberOfRegressions = 0;
+
+    for (CaseResult &result : results)
+    {
+        for (StageResult &stage : result.stages)
+        {
+            map<string, double>::iterator it = baseline.find(getResultKey(result.shape, result.numberOfFaces, stage.name));
+
+            if (it == baseline.end() || stage.seconds < MINIMUM_CHECKED_SECONDS) { continue; }
+
+            if (stage.seconds > it->second * (1.0 + options.maximumRegression))
+            {
+                printf("REGRESSION %s, %d faces, %s: %.3f ms, baseline %.3f ms\n",
+                    result.shape.c_str(),
+                    result.numberOfFaces,
+                    stage.name.c_str(),
+                    stage.seconds * 1000.0,
+                    it->second * 1000.0
+                );
+
+                numberOfRegressions++;
+            }
+        }
+    }
+
+    return numberOfRegressions == 0 ? 0 : 1;
+}
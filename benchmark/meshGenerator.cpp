@@ -0,0 +1,213 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+#define PI 3.14159265358979323846
+
+// Number of shells on the center of the mesh made by generateShells.
+#define CENTER_SHELLS 2
+
+// Faces per shell made by generateShells, and the most shells it makes.
+#define FACES_PER_SHELL 2048
+#define MAXIMUM_SHELLS 256
+
+void GeneratedMesh::clear()
+{
+    numberOfVertices = 0;
+
+    faceVertexCounts.clear();
+    faceVertexIndices.clear();
+    edgeVertexIndices.clear();
+
+    points.clear();
+}
+
+static void addPoint(GeneratedMesh &mesh, double x, double y, double z, bool mirrored)
+{
+    mesh.points.push_back((float) (mirrored ? -x : x));
+    mesh.points.push_back((float) y);
+    mesh.points.push_back((float) z);
+
+    mesh.numberOfVertices++;
+}
+
+/* Mirrored shells are wound the other way, so their normals mirror too. */
+static void addQuad(GeneratedMesh &mesh, int v0, int v1, int v2, int v3, bool mirrored)
+{
+    mesh.faceVertexCounts.push_back(4);
+
+    if (mirrored)
+    {
+        mesh.faceVertexIndices.insert(mesh.faceVertexIndices.end(), { v3, v2, v1, v0 });
+    } else {
+        mesh.faceVertexIndices.insert(mesh.faceVertexIndices.end(), { v0, v1, v2, v3 });
+    }
+}
+
+/* `columns` must be even so that the middle column of vertices lies on the plane of symmetry. */
+static void addGrid(GeneratedMesh &mesh, int columns, int rows)
+{
+    int offset = mesh.numberOfVertices;
+    double spacing = 2.0 / columns;
+
+    for (int r = 0; r <= rows; r++)
+    {
+        for (int c = 0; c <= columns; c++)
+        {
+            double x = c * spacing - 1.0;
+            double y = r * spacing;
+
+            addPoint(mesh, x, y, 0.1 * cos(3.0 * x) * sin(5.0 * y), false);
+        }
+    }
+
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < columns; c++)
+        {
+            int v = offset + r * (columns + 1) + c;
+            addQuad(mesh, v, v + 1, v + columns + 2, v + columns + 1, false);
+        }
+    }
+}
+
+/* 
+    `rings` must be a multiple of 4 for a torus centered on the plane of 
+    symmetry, so that two of its rings lie on it. 
+*/
+static void addTorus(GeneratedMesh &mesh, int rings, int sides, double cx, double cy, double radius, bool mirrored)
+{
+    int offset = mesh.numberOfVertices;
+
+    for (int i = 0; i < rings; i++)
+    {
+        double theta = 2.0 * PI * i / rings;
+
+        for (int j = 0; j < sides; j++)
+        {
+            double phi = 2.0 * PI * j / sides;
+            double d = radius * (1.0 + 0.3 * cos(phi));
+
+            addPoint(mesh, cx + d * cos(theta), cy + radius * 0.3 * sin(phi), d * sin(theta), mirrored);
+        }
+    }
+
+    for (int i = 0; i < rings; i++)
+    {
+        int i1 = (i + 1) % rings;
+
+        for (int j = 0; j < sides; j++)
+        {
+            int j1 = (j + 1) % sides;
+
+            addQuad(
+                mesh,
+                offset + i * sides + j,
+                offset + i * sides + j1,
+                offset + i1 * sides + j1,
+                offset + i1 * sides + j,
+                mirrored
+            );
+        }
+    }
+}
+
+static void getTorusSize(int numberOfFaces, int &rings, int &sides)
+{
+    sides = max(8, (int) sqrt(numberOfFaces / 4.0));
+    rings = max(4, (numberOfFaces / sides + 3) / 4 * 4);
+}
+
+/* Edges are numbered in the order of their vertex pairs, like the edges of a mesh that was never edited. */
+static void addEdges(GeneratedMesh &mesh)
+{
+    vector<uint64_t> edges;
+    edges.reserve(mesh.faceVertexIndices.size());
+
+    int offset = 0;
+
+    for (int &count : mesh.faceVertexCounts)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            uint64_t v0 = (uint64_t) mesh.faceVertexIndices[offset + i];
+            uint64_t v1 = (uint64_t) mesh.faceVertexIndices[offset + (i + 1) % count];
+
+            edges.push_back(v0 < v1 ? (v0 << 32) | v1 : (v1 << 32) | v0);
+        }
+
+        offset += count;
+    }
+
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    mesh.edgeVertexIndices.resize(edges.size() * 2);
+
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        mesh.edgeVertexIndices[e * 2] = (int) (edges[e] >> 32);
+        mesh.edgeVertexIndices[e * 2 + 1] = (int) (edges[e] & 0xffffffff);
+    }
+}
+
+void generateGrid(int numberOfFaces, GeneratedMesh &mesh)
+{
+    mesh.clear();
+
+    int columns = max(2, (int) sqrt((double) numberOfFaces) / 2 * 2);
+    int rows = max(1, numberOfFaces / columns);
+
+    addGrid(mesh, columns, rows);
+    addEdges(mesh);
+}
+
+void generateTorus(int numberOfFaces, GeneratedMesh &mesh)
+{
+    mesh.clear();
+
+    int rings, sides;
+    getTorusSize(numberOfFaces, rings, sides);
+
+    addTorus(mesh, rings, sides, 0.0, 0.0, 1.0, false);
+    addEdges(mesh);
+}
+
+void generateShells(int numberOfFaces, GeneratedMesh &mesh)
+{
+    mesh.clear();
+
+    int numberOfShells = min(MAXIMUM_SHELLS, max(CENTER_SHELLS + 2, numberOfFaces / FACES_PER_SHELL));
+    numberOfShells += (numberOfShells - CENTER_SHELLS) % 2;
+
+    int rings, sides;
+    getTorusSize(numberOfFaces / numberOfShells, rings, sides);
+
+    for (int s = 0; s < CENTER_SHELLS; s++)
+    {
+        addTorus(mesh, rings, sides, 0.0, -3.0 * (s + 1), 1.0, false);
+    }
+
+    int numberOfPairs = (numberOfShells - CENTER_SHELLS) / 2;
+
+    for (int p = 0; p < numberOfPairs; p++)
+    {
+        double cx = 3.0 * (p % 8 + 1);
+        double cy = 3.0 * (p / 8);
+
+        addTorus(mesh, rings, sides, cx, cy, 1.0, false);
+        addTorus(mesh, rings, sides, cx, cy, 1.0, true);
+    }
+
+    addEdges(mesh);
+}
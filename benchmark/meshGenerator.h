@@ -0,0 +1,52 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_MESH_GENERATOR_H
+#define POLY_SYMMETRY_MESH_GENERATOR_H
+
+#include <vector>
+
+using namespace std;
+
+/*
+    Raw polygon description of a mesh, in the form MeshTopology::buildTopology
+    takes, with 3 floats per vertex as returned by `MFnMesh::getRawPoints`.
+*/
+struct GeneratedMesh
+{
+    int             numberOfVertices = 0;
+
+    vector<int>     faceVertexCounts;
+    vector<int>     faceVertexIndices;
+    vector<int>     edgeVertexIndices;
+
+    vector<float>   points;
+
+    int             numberOfFaces() const   { return (int) faceVertexCounts.size(); }
+    int             numberOfEdges() const   { return (int) edgeVertexIndices.size() / 2; }
+
+    void            clear();
+};
+
+/*
+    Generators for quad meshes of about `numberOfFaces` faces that are
+    symmetrical across the YZ plane, with a center loop of vertices that lie
+    on it, like the meshes the solver is run on. The positive side of X is
+    the left side.
+*/
+
+/* A single rippled sheet, with an even number of columns. */
+void        generateGrid(int numberOfFaces, GeneratedMesh &mesh);
+
+/* A single torus lying across the YZ plane. */
+void        generateTorus(int numberOfFaces, GeneratedMesh &mesh);
+
+/*
+    Many small tori, as on a costume: a few on the center, and the rest in
+    pairs of mirrored shells on either side of it. 
+*/
+void        generateShells(int numberOfFaces, GeneratedMesh &mesh);
+
+#endif
@@ -0,0 +1,144 @@
+"""polySymmetry.batch
+
+Headless symmetry solver for publish farms. Scenes are opened in mayapy
+worker processes, and every mesh in them is solved with automatic seeding
+and written to a symmetry table file named after its topology, the same
+layout as the POLY_SYMMETRY_REGISTRY directory. Point the registry at the
+output directory and every session picks the tables up without solving.
+
+Usage
+-----
+    mayapy -m polySymmetry.batch [-p PROCESSES] OUTPUT_DIRECTORY SCENE [SCENE ...]
+
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+
+
+_REGISTRY_VARIABLE = 'POLY_SYMMETRY_REGISTRY'
+_TABLE_FILE_EXTENSION = '.psym'
+
+
+def solveScenes(scenes, outputDirectory, processes=None):
+    """Solves the symmetry of every mesh in the scenes across worker processes.
+
+    Parameters
+    ----------
+    scenes : list of str
+        Paths of the Maya scenes to solve.
+    outputDirectory : str
+        Directory the symmetry table files are written to.
+    processes : int, optional
+        Number of worker processes. By default, one per CPU.
+
+    Returns
+    -------
+    bool
+        True if every worker finished without errors.
+
+    """
+
+    if not os.path.isdir(outputDirectory):
+        os.makedirs(outputDirectory)
+
+    processes = max(1, min(processes or _getNumberOfCPUs(), len(scenes)))
+
+    workers = []
+
+    for i in range(processes):
+        workerScenes = scenes[i::processes]
+
+        if not workerScenes:
+            continue
+
+        args = [sys.executable, '-m', 'polySymmetry.batch', '--worker', outputDirectory] + workerScenes
+        workers.append(subprocess.Popen(args))
+
+    return all(worker.wait() == 0 for worker in workers)
+
+
+def getTableFileName(cacheKey):
+    """Returns the name of the symmetry table file of a topology cache key.
+
+    Matches SymmetryRegistry::getFilePath.
+
+    """
+
+    return cacheKey.replace(':', '_') + _TABLE_FILE_EXTENSION
+
+
+def _solveScenes(scenes, outputDirectory):
+    """Solves the scenes in this process. Returns the number of failures."""
+
+    os.environ[_REGISTRY_VARIABLE] = outputDirectory
+
+    import maya.standalone
+    maya.standalone.initialize(name='python')
+
+    import maya.cmds as cmds
+
+    cmds.loadPlugin('polySymmetry', quiet=True)
+
+    failures = 0
+
+    for scene in scenes:
+        try:
+            cmds.file(scene, open=True, force=True, loadReferenceDepth='all')
+        except RuntimeError as e:
+            sys.stderr.write("Cannot open {}: {}\n".format(scene, e))
+            failures += 1
+            continue
+
+        for mesh in cmds.ls(type='mesh', noIntermediate=True, long=True) or []:
+            cacheKey = cmds.polySymmetry(mesh, query=True, cacheKey=True)
+            tableFile = os.path.join(outputDirectory, getTableFileName(cacheKey))
+
+            # Topology-identical meshes share a file, so each is solved once.
+            if os.path.exists(tableFile):
+                continue
+
+            # The registry points at the output directory, so solving writes the file.
+            try:
+                cmds.polySymmetry(mesh, automatic=True, constructionHistory=False)
+            except RuntimeError as e:
+                sys.stderr.write("Cannot solve {} in {}: {}\n".format(mesh, scene, e))
+                failures += 1
+                continue
+
+            if not os.path.exists(tableFile):
+                sys.stderr.write("Cannot write {} for {} in {}\n".format(tableFile, mesh, scene))
+                failures += 1
+
+    maya.standalone.uninitialize()
+
+    return failures
+
+
+def _getNumberOfCPUs():
+    try:
+        import multiprocessing
+        return multiprocessing.cpu_count()
+    except (ImportError, NotImplementedError):
+        return 1
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog='polySymmetry.batch', description=__doc__.split('\n\n')[1])
+    parser.add_argument('-p', '--processes', type=int, default=None, help="number of worker processes")
+    parser.add_argument('--worker', action='store_true', help=argparse.SUPPRESS)
+    parser.add_argument('outputDirectory')
+    parser.add_argument('scenes', nargs='+')
+
+    args = parser.parse_args(argv)
+
+    if args.worker:
+        return 1 if _solveScenes(args.scenes, args.outputDirectory) else 0
+
+    return 0 if solveScenes(args.scenes, args.outputDirectory, args.processes) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -126,17 +126,15 @@ def polyDeformerWeights(*args, **kwargs):
     logMsg = "Result: {} weights on {} ({})."
     actionName = 'Flipped' if 'flip' in kwargs else 'Mirrored'
 
-    with undoChunk():
-        for mesh, deformer in zip(selectedMeshes, selectedDeformers):
-            cmds.polyDeformerWeights(
-                sourceMesh=mesh,
-                sourceDeformer=deformer,
-                destinationMesh=mesh,
-                destinationDeformer=deformer,
-                **kwargs
-            )
+    # A single call shares the symmetry data between pairs and makes one undo step.
+    cmds.polyDeformerWeights(
+        sourceMesh=selectedMeshes,
+        sourceDeformer=selectedDeformers,
+        **kwargs
+    )
 
-            _INFO(logMsg.format(actionName, mesh, deformer))
+    for mesh, deformer in zip(selectedMeshes, selectedDeformers):
+        _INFO(logMsg.format(actionName, mesh, deformer))
    
 
 def flipMesh(*args):
@@ -190,9 +188,7 @@ def mirrorMesh(*args):
 
     baseMesh = selectedMeshes[0]
 
-    with undoChunk():
-        for mesh in selectedMeshes[1:]:
-            cmds.polyMirror(baseMesh, mesh)
+    cmds.polyMirror(baseMesh, *selectedMeshes[1:])
 
 
 def copyPolySkinWeights(*args):
@@ -0,0 +1,121 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "cpu.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#if defined(__linux__) && defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define POLY_SYMMETRY_X86
+
+static bool cpuid(int leaf, int subleaf, int registers[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(registers, leaf, subleaf);
+    return true;
+#elif defined(__GNUC__)
+    unsigned int a, b, c, d;
+
+    __asm__ __volatile__ ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(leaf), "c"(subleaf));
+
+    registers[0] = (int) a;
+    registers[1] = (int) b;
+    registers[2] = (int) c;
+    registers[3] = (int) d;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+    AVX state has to be enabled by the operating system as well as supported 
+    by the processor, otherwise the first AVX instruction faults.
+*/
+static bool osSavesAVXState()
+{
+#if defined(_MSC_VER)
+    return (_xgetbv(0) & 0x6) == 0x6;
+#elif defined(__GNUC__)
+    unsigned int eax, edx;
+
+    __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (eax & 0x6) == 0x6;
+#else
+    return false;
+#endif
+}
+#endif
+
+static bool detectSSE42()
+{
+#ifdef POLY_SYMMETRY_X86
+    int registers[4] = {0, 0, 0, 0};
+
+    if (!cpuid(0, 0, registers) || registers[0] < 1) { return false; }
+
+    cpuid(1, 0, registers);
+    return (registers[2] & (1 << 20)) != 0;
+#else
+    return false;
+#endif
+}
+
+static bool detectAVX2()
+{
+#ifdef POLY_SYMMETRY_X86
+    int registers[4] = {0, 0, 0, 0};
+
+    if (!cpuid(0, 0, registers) || registers[0] < 7) { return false; }
+
+    cpuid(1, 0, registers);
+
+    bool hasOSXSave = (registers[2] & (1 << 27)) != 0;
+    bool hasAVX     = (registers[2] & (1 << 28)) != 0;
+
+    if (!hasOSXSave || !hasAVX || !osSavesAVXState()) { return false; }
+
+    cpuid(7, 0, registers);
+    return (registers[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+static bool detectARMCRC32()
+{
+#if defined(__ARM_FEATURE_CRC32)
+    return true;
+#elif defined(__linux__) && defined(__aarch64__) && defined(HWCAP_CRC32)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpuHasSSE42()
+{
+    static const bool result = detectSSE42();
+    return result;
+}
+
+bool cpuHasAVX2()
+{
+    static const bool result = detectAVX2();
+    return result;
+}
+
+bool cpuHasARMCRC32()
+{
+    static const bool result = detectARMCRC32();
+    return result;
+}
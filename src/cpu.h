@@ -0,0 +1,18 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_CPU_H
+#define POLY_SYMMETRY_CPU_H
+
+/*
+    Runtime checks for instruction set extensions. The plugin is built for 
+    the baseline architecture, so code that uses these extensions has to 
+    check for them before it is called. Results are computed once.
+*/
+bool        cpuHasSSE42();
+bool        cpuHasAVX2();
+bool        cpuHasARMCRC32();
+
+#endif
@@ -0,0 +1,482 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshCorrespondence.h"
+#include "parallel.h"
+#include "pointKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Triangles per leaf of the tree.
+#define LEAF_SIZE 4
+
+// Deep enough for any tree built from median splits of an int count of triangles.
+#define MAX_TREE_DEPTH 64
+
+// Points per task; each point is a tree query.
+#define QUERY_GRAIN_SIZE 256
+
+// Points per task for the interpolation kernels.
+#define INTERPOLATE_GRAIN_SIZE 8192
+
+unordered_map<string, shared_ptr<const MeshCorrespondence>> MeshCorrespondenceCache::correspondenceCache;
+size_t MeshCorrespondenceCache::maximumSize = 16;
+
+void TriangleBVH::clear()
+{
+    nodes.clear();
+    corners.clear();
+    triangleVertices.clear();
+}
+
+void TriangleBVH::build(PointBuffer points, const int* triangleVertices, int numberOfTriangles)
+{
+    this->clear();
+
+    if (numberOfTriangles == 0) { return; }
+
+    this->corners.resize((size_t) numberOfTriangles * 9);
+    this->triangleVertices.assign(triangleVertices, triangleVertices + (size_t) numberOfTriangles * 3);
+
+    vector<float> centers((size_t) numberOfTriangles * 3);
+    vector<int> order(numberOfTriangles);
+
+    for (int t = 0; t < numberOfTriangles; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            const float* p = points.data + (size_t) triangleVertices[t * 3 + k] * points.stride;
+
+            for (int c = 0; c < 3; c++)
+            {
+                this->corners[t * 9 + k * 3 + c] = p[c];
+                centers[t * 3 + c] += p[c] / 3.0f;
+            }
+        }
+
+        order[t] = t;
+    }
+
+    this->nodes.reserve((size_t) (2 * numberOfTriangles / LEAF_SIZE + 1));
+    this->buildNode(order, centers, 0, numberOfTriangles);
+
+    // Put the corners and vertices of each leaf next to each other.
+    vector<float> sortedCorners(this->corners.size());
+    vector<int> sortedVertices(this->triangleVertices.size());
+
+    for (int i = 0; i < numberOfTriangles; i++)
+    {
+        int t = order[i];
+
+        copy(&this->corners[t * 9], &this->corners[t * 9 + 9], &sortedCorners[i * 9]);
+        copy(&this->triangleVertices[t * 3], &this->triangleVertices[t * 3 + 3], &sortedVertices[i * 3]);
+    }
+
+    this->corners.swap(sortedCorners);
+    this->triangleVertices.swap(sortedVertices);
+}
+
+int TriangleBVH::buildNode(vector<int> &order, vector<float> &centers, int first, int last)
+{
+    int nodeIndex = (int) this->nodes.size();
+    this->nodes.emplace_back();
+
+    float boxMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float boxMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    float centerMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float centerMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (int i = first; i < last; i++)
+    {
+        int t = order[i];
+
+        for (int c = 0; c < 3; c++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                boxMin[c] = min(boxMin[c], this->corners[t * 9 + k * 3 + c]);
+                boxMax[c] = max(boxMax[c], this->corners[t * 9 + k * 3 + c]);
+            }
+
+            centerMin[c] = min(centerMin[c], centers[t * 3 + c]);
+            centerMax[c] = max(centerMax[c], centers[t * 3 + c]);
+        }
+    }
+
+    Node node;
+
+    copy(boxMin, boxMin + 3, node.boxMin);
+    copy(boxMax, boxMax + 3, node.boxMax);
+
+    if (last - first <= LEAF_SIZE)
+    {
+        node.first = first;
+        node.count = last - first;
+
+        this->nodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    int axis = 0;
+
+    for (int c = 1; c < 3; c++)
+    {
+        if (centerMax[c] - centerMin[c] > centerMax[axis] - centerMin[axis]) { axis = c; }
+    }
+
+    int middle = (first + last) / 2;
+
+    nth_element(
+        order.begin() + first,
+        order.begin() + middle,
+        order.begin() + last,
+        [&](int a, int b) { return centers[a * 3 + axis] < centers[b * 3 + axis]; }
+    );
+
+    node.count = 0;
+    this->nodes[nodeIndex] = node;
+
+    // Nodes are added depth first, so the left child always follows its parent.
+    this->buildNode(order, centers, first, middle);
+
+    int rightIndex = this->buildNode(order, centers, middle, last);
+    this->nodes[nodeIndex].first = rightIndex;
+
+    return nodeIndex;
+}
+
+static float boxDistanceSquared(const float* point, const float* boxMin, const float* boxMax)
+{
+    float distanceSquared = 0.0f;
+
+    for (int c = 0; c < 3; c++)
+    {
+        float delta = max(max(boxMin[c] - point[c], point[c] - boxMax[c]), 0.0f);
+        distanceSquared += delta * delta;
+    }
+
+    return distanceSquared;
+}
+
+static float dot(const float* a, const float* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/*
+    Closest point on the triangle `abc` to `p`, from the Voronoi regions of
+    its corners and edges (Ericson, Real-Time Collision Detection, 5.1.5).
+    Returns the squared distance and writes the barycentric weights.
+*/
+static float closestPointOnTriangle(const float* p, const float* a, const float* b, const float* c, float* weights)
+{
+    float ab[3], ac[3], ap[3], bp[3], cp[3];
+
+    for (int k = 0; k < 3; k++)
+    {
+        ab[k] = b[k] - a[k];
+        ac[k] = c[k] - a[k];
+        ap[k] = p[k] - a[k];
+        bp[k] = p[k] - b[k];
+        cp[k] = p[k] - c[k];
+    }
+
+    float d1 = dot(ab, ap);
+    float d2 = dot(ac, ap);
+    float d3 = dot(ab, bp);
+    float d4 = dot(ac, bp);
+    float d5 = dot(ab, cp);
+    float d6 = dot(ac, cp);
+
+    float v, w;
+
+    float va = d3 * d6 - d5 * d4;
+    float vb = d5 * d2 - d1 * d6;
+    float vc = d1 * d4 - d3 * d2;
+
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        v = 0.0f; w = 0.0f;
+    } else if (d3 >= 0.0f && d4 <= d3) {
+        v = 1.0f; w = 0.0f;
+    } else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        v = d1 / (d1 - d3); w = 0.0f;
+    } else if (d6 >= 0.0f && d5 <= d6) {
+        v = 0.0f; w = 1.0f;
+    } else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        v = 0.0f; w = d2 / (d2 - d6);
+    } else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        w = (d4 - d3) / ((d4 - d3) + (d5 - d6)); v = 1.0f - w;
+    } else {
+        float denominator = va + vb + vc;
+
+        // Degenerate triangles have no area, and are as close as their first corner.
+        if (denominator <= 0.0f)
+        {
+            v = 0.0f; w = 0.0f;
+        } else {
+            v = vb / denominator;
+            w = vc / denominator;
+        }
+    }
+
+    weights[0] = 1.0f - v - w;
+    weights[1] = v;
+    weights[2] = w;
+
+    float distanceSquared = 0.0f;
+
+    for (int k = 0; k < 3; k++)
+    {
+        float delta = ap[k] - ab[k] * v - ac[k] * w;
+        distanceSquared += delta * delta;
+    }
+
+    return distanceSquared;
+}
+
+/*
+    Visits the nearer child first, and skips any node whose box is further
+    away than the closest triangle found so far.
+*/
+void TriangleBVH::closestPoint(const float* point, int* vertices, float* weights) const
+{
+    int stack[MAX_TREE_DEPTH * 2];
+    int stackSize = 0;
+
+    float bestDistanceSquared = FLT_MAX;
+    int bestTriangle = 0;
+    float bestWeights[3] = { 1.0f, 0.0f, 0.0f };
+
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node &node = this->nodes[stack[--stackSize]];
+
+        if (boxDistanceSquared(point, node.boxMin, node.boxMax) >= bestDistanceSquared) { continue; }
+
+        if (node.count > 0)
+        {
+            for (int t = node.first; t < node.first + node.count; t++)
+            {
+                const float* c = &this->corners[t * 9];
+                float triangleWeights[3];
+
+                float distanceSquared = closestPointOnTriangle(point, c, c + 3, c + 6, triangleWeights);
+
+                if (distanceSquared < bestDistanceSquared)
+                {
+                    bestDistanceSquared = distanceSquared;
+                    bestTriangle = t;
+                    copy(triangleWeights, triangleWeights + 3, bestWeights);
+                }
+            }
+
+            continue;
+        }
+
+        int left = (int) (&node - this->nodes.data()) + 1;
+        int right = node.first;
+
+        float leftDistance = boxDistanceSquared(point, this->nodes[left].boxMin, this->nodes[left].boxMax);
+        float rightDistance = boxDistanceSquared(point, this->nodes[right].boxMin, this->nodes[right].boxMax);
+
+        // The nearer child goes on top of the stack.
+        if (leftDistance < rightDistance) { swap(left, right); }
+
+        stack[stackSize++] = left;
+        stack[stackSize++] = right;
+    }
+
+    copy(&this->triangleVertices[bestTriangle * 3], &this->triangleVertices[bestTriangle * 3 + 3], vertices);
+    copy(bestWeights, bestWeights + 3, weights);
+}
+
+void buildCorrespondence(
+    const TriangleBVH &surface,
+    PointBuffer points,
+    int numberOfPoints,
+    bool flip,
+    bool mirror,
+    int direction,
+    const MirrorPlane &plane,
+    MeshCorrespondence &result
+) {
+    result.vertices.resize((size_t) numberOfPoints * 3);
+    result.weights.resize((size_t) numberOfPoints * 3);
+
+    parallelForRange(numberOfPoints, QUERY_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            const float* p = points.data + (size_t) i * points.stride;
+            float point[3] = { p[0], p[1], p[2] };
+
+            float side = plane.distance(point) * (float) direction;
+
+            if (flip || (mirror && side < 0.0f)) { plane.reflectPoint(point); }
+
+            surface.closestPoint(point, &result.vertices[i * 3], &result.weights[i * 3]);
+        }
+    });
+}
+
+/*
+    Sum of the weighted points at row `i` of `correspondence`, less the
+    weighted `sub` points when it is given.
+*/
+template <bool SUB>
+static void interpolatePoint(
+    PointBuffer points,
+    PointBuffer sub,
+    const MeshCorrespondence &correspondence,
+    int i,
+    float* result
+) {
+    result[0] = result[1] = result[2] = 0.0f;
+
+    for (int k = 0; k < 3; k++)
+    {
+        int v = correspondence.vertices[i * 3 + k];
+        float w = correspondence.weights[i * 3 + k];
+
+        for (int c = 0; c < 3; c++)
+        {
+            float value = points.data[(size_t) v * points.stride + c];
+
+            if (SUB) { value -= sub.data[(size_t) v * sub.stride + c]; }
+
+            result[c] += w * value;
+        }
+    }
+}
+
+void interpolatePoints(
+    PointBuffer points,
+    const MeshCorrespondence &correspondence,
+    float* result
+) {
+    parallelForRange(correspondence.numberOfPoints(), INTERPOLATE_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            float* r = result + (size_t) i * 4;
+
+            interpolatePoint<false>(points, points, correspondence, i, r);
+            r[3] = 1.0f;
+        }
+    });
+}
+
+void flipPointsThrough(
+    PointBuffer points,
+    PointBuffer reference,
+    const MeshCorrespondence &correspondence,
+    const MirrorPlane &plane,
+    float* result
+) {
+    parallelForRange(correspondence.numberOfPoints(), INTERPOLATE_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            float delta[3];
+            interpolatePoint<true>(points, reference, correspondence, i, delta);
+
+            plane.reflectVector(delta);
+
+            float* r = result + (size_t) i * 4;
+
+            for (int c = 0; c < 3; c++)
+            {
+                r[c] = reference.data[(size_t) i * reference.stride + c] + delta[c];
+            }
+
+            r[3] = 1.0f;
+        }
+    });
+}
+
+void mirrorPointsThrough(
+    PointBuffer points,
+    PointBuffer base,
+    const MeshCorrespondence &correspondence,
+    const MirrorPlane &plane,
+    float* result
+) {
+    parallelForRange(correspondence.numberOfPoints(), INTERPOLATE_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            float opposite[3];
+            interpolatePoint<false>(points, base, correspondence, i, opposite);
+
+            plane.reflectPoint(opposite);
+
+            float* r = result + (size_t) i * 4;
+
+            for (int c = 0; c < 3; c++)
+            {
+                r[c] = points.data[(size_t) i * points.stride + c] + opposite[c] - base.data[(size_t) i * base.stride + c];
+            }
+
+            r[3] = 1.0f;
+        }
+    });
+}
+
+void interpolateWeights(
+    const float* sourceWeights,
+    float* destinationWeights,
+    const vector<int> &vertices,
+    const MeshCorrespondence &correspondence
+) {
+    const int* cv = correspondence.vertices.data();
+    const float* cw = correspondence.weights.data();
+
+    parallelForRange((int) vertices.size(), INTERPOLATE_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int k = first; k < last; k++)
+        {
+            int i = vertices[k];
+
+            destinationWeights[i] =
+                cw[i * 3 + 0] * sourceWeights[cv[i * 3 + 0]] +
+                cw[i * 3 + 1] * sourceWeights[cv[i * 3 + 1]] +
+                cw[i * 3 + 2] * sourceWeights[cv[i * 3 + 2]];
+        }
+    });
+}
+
+bool MeshCorrespondenceCache::getCorrespondence(const string &key, shared_ptr<const MeshCorrespondence> &correspondence)
+{
+    auto it = correspondenceCache.find(key);
+
+    if (it == correspondenceCache.end()) { return false; }
+
+    correspondence = it->second;
+    return true;
+}
+
+/* The cache is emptied when it is full, rather than tracking which entry was used last. */
+void MeshCorrespondenceCache::addCorrespondence(const string &key, shared_ptr<const MeshCorrespondence> &correspondence)
+{
+    if (correspondenceCache.size() >= maximumSize) { correspondenceCache.clear(); }
+
+    correspondenceCache[key] = correspondence;
+}
+
+void MeshCorrespondenceCache::clear()
+{
+    correspondenceCache.clear();
+}
@@ -0,0 +1,139 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_MESH_CORRESPONDENCE_H
+#define POLY_SYMMETRY_MESH_CORRESPONDENCE_H
+
+#include "pointKernels.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/*
+    Bounding volume hierarchy over the triangles of a mesh, used to find the
+    closest point on its surface. Triangles are split at the median of their
+    centers along the longest axis, so the tree is balanced, and the corners
+    are copied into leaf order so a query only reads memory it needs.
+*/
+class TriangleBVH
+{
+public:
+    void                build(PointBuffer points, const int* triangleVertices, int numberOfTriangles);
+    void                clear();
+
+    bool                isEmpty() const     { return nodes.empty(); }
+
+    /*
+        Finds the point on the surface closest to `point`. Writes the vertices
+        of the triangle it lies on and its barycentric weights, 3 of each.
+    */
+    void                closestPoint(const float* point, int* vertices, float* weights) const;
+
+private:
+    /* Leaves have a count. Interior nodes are followed by their left child, and `first` is the right one. */
+    struct Node
+    {
+        float           boxMin[3];
+        float           boxMax[3];
+        int             first;
+        int             count;
+    };
+
+    int                 buildNode(vector<int> &order, vector<float> &centers, int first, int last);
+
+private:
+    vector<Node>        nodes;
+    vector<float>       corners;
+    vector<int>         triangleVertices;
+};
+
+/*
+    Location of each point of one mesh on the surface of another, as 3
+    vertices of the other mesh and their barycentric weights per point.
+*/
+struct MeshCorrespondence
+{
+    vector<int>         vertices;
+    vector<float>       weights;
+
+    int                 numberOfPoints() const  { return (int) weights.size() / 3; }
+};
+
+/*
+    Locates `points` on `surface` in parallel. When flipping, each point is
+    reflected across `plane` before it is located. When mirroring, only 
+    points on the other side from `direction` (1 for the side the normal of
+    the plane points to, -1 for the other) are reflected, and the others are
+    located as they are. `surface` must not be empty.
+*/
+void        buildCorrespondence(
+                const TriangleBVH &surface,
+                PointBuffer points,
+                int numberOfPoints,
+                bool flip,
+                bool mirror,
+                int direction,
+                const MirrorPlane &plane,
+                MeshCorrespondence &result
+            );
+
+/* result[i] = points at correspondence[i] */
+void        interpolatePoints(
+                PointBuffer points,
+                const MeshCorrespondence &correspondence,
+                float* result
+            );
+
+/* result[i] = reference[i] + reflect(points at correspondence[i] - reference at correspondence[i]) */
+void        flipPointsThrough(
+                PointBuffer points,
+                PointBuffer reference,
+                const MeshCorrespondence &correspondence,
+                const MirrorPlane &plane,
+                float* result
+            );
+
+/* result[i] = points[i] + reflect(points at correspondence[i]) - base[i] */
+void        mirrorPointsThrough(
+                PointBuffer points,
+                PointBuffer base,
+                const MeshCorrespondence &correspondence,
+                const MirrorPlane &plane,
+                float* result
+            );
+
+/*
+    Sets `destinationWeights[vertices[k]]` to the source weights interpolated
+    at row `vertices[k]` of `correspondence`, in parallel.
+*/
+void        interpolateWeights(
+                const float* sourceWeights,
+                float* destinationWeights,
+                const vector<int> &vertices,
+                const MeshCorrespondence &correspondence
+            );
+
+/*
+    Correspondences that have already been built, keyed by a checksum of the
+    meshes and options they were built from, so that commands run over the
+    same meshes, such as a chain of LODs, only build them once.
+*/
+class MeshCorrespondenceCache
+{
+public:
+    static bool         getCorrespondence(const string &key, shared_ptr<const MeshCorrespondence> &correspondence);
+    static void         addCorrespondence(const string &key, shared_ptr<const MeshCorrespondence> &correspondence);
+    static void         clear();
+
+public:
+    static unordered_map<string, shared_ptr<const MeshCorrespondence>> correspondenceCache;
+    static size_t       maximumSize;
+};
+
+#endif
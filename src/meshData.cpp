@@ -5,196 +5,126 @@
 
 #include "polyChecksum.h"
 #include "meshData.h"
-#include "util.h"
+#include "profiling.h"
 
-#include <algorithm>
 #include <vector>
-#include <unordered_map>
 
 #include <maya/MDagPath.h>
+#include <maya/MFnMesh.h>
 #include <maya/MIntArray.h>
-#include <maya/MItMeshEdge.h>
-#include <maya/MItMeshPolygon.h>
 #include <maya/MItMeshVertex.h>
 
 using namespace std;
 
 MeshData::MeshData() {}
 
-MeshData::~MeshData()
-{
-    this->clear();
-}
+MeshData::~MeshData() {}
 
-void MeshData::clear()
+/*
+    Checksum of each vertex index followed by its connected vertices, in the 
+    order MItMeshVertex returns them. This value is stored on polySymmetryData 
+    nodes, so the byte stream must stay the same. The stream is collected in 
+    one buffer so the checksum runs over it in a single pass.
+*/
+unsigned long MeshData::getVertexChecksum(MDagPath &meshDagPath)
 {
-    numberOfEdges = 0;
-    numberOfFaces = 0;
-    numberOfVertices = 0;
+    ProfileScope profileScope("vertexChecksum");
 
-    vertexData.clear();
-    edgeData.clear();
-    faceData.clear();  
-}
+    MFnMesh fnMesh(meshDagPath);
 
-unsigned long MeshData::getVertexChecksum(MDagPath &meshDagPath)
-{
-    PolyChecksum checksum;
+    vector<int> buffer;
+    buffer.reserve(fnMesh.numVertices() + fnMesh.numEdges() * 2);
 
+    MIntArray connectedVertices;
     MItMeshVertex itVertex(meshDagPath);
     
     while (!itVertex.isDone())
     {
-        int index = itVertex.index();
-        checksum.putBytes(&index, sizeof(index));
+        buffer.push_back(itVertex.index());
 
-        MIntArray connectedVertices;
         itVertex.getConnectedVertices(connectedVertices);
         uint numConnectedVertices = connectedVertices.length();
 
         for (uint i = 0; i < numConnectedVertices; i++)
         {
-            uint idx = connectedVertices[i];
-            checksum.putBytes(&idx, sizeof(idx));
+            buffer.push_back(connectedVertices[i]);
         }
 
         itVertex.next();
     }
 
-    return checksum.getResult();
-}
+    profileScope.countAllocation(buffer.capacity() * sizeof(int));
 
-void MeshData::unpackMesh(MDagPath &meshDagPath)
-{
-    this->clear();
-    
-    MItMeshEdge edges(meshDagPath);
-    MItMeshPolygon faces(meshDagPath);
-    MItMeshVertex vertices(meshDagPath);
-
-    this->unpackEdges(edges);
-    this->unpackFaces(faces);
-    this->unpackVertices(vertices);
+    PolyChecksum checksum;
+    checksum.putBytes(buffer.data(), buffer.size() * sizeof(int));
 
-    this->unpackVertexSiblings();
+    return checksum.getResult();
 }
 
-void MeshData::unpackEdges(MItMeshEdge &edges)
+/*
+    CRC32C of the polygon counts and connects of the mesh. Both arrays are 
+    read in bulk and the checksum runs in hardware where it can, so this is 
+    much faster than `getVertexChecksum` but does not match the values 
+    stored on polySymmetryData nodes.
+*/
+unsigned long MeshData::getFastChecksum(MDagPath &meshDagPath)
 {
-    this->numberOfEdges = edges.count();
-    this->edgeData.resize(this->numberOfEdges);
+    ProfileScope profileScope("fastChecksum");
 
-    MIntArray connectedEdges;
-    MIntArray connectedFaces;
+    MFnMesh fnMesh(meshDagPath);
 
-    edges.reset();
+    MIntArray polygonCounts;
+    MIntArray polygonConnects;
 
-    while (!edges.isDone())
-    {
-        EdgeData &edge = edgeData[edges.index()];
+    fnMesh.getVertices(polygonCounts, polygonConnects);
 
-        edge.connectedVertices.resize(2);
-        edge.connectedVertices[0] = edges.index(0);
-        edge.connectedVertices[1] = edges.index(1);
+    vector<int> buffer(polygonCounts.length() + polygonConnects.length());
 
-        sort(edge.connectedVertices.begin(), edge.connectedVertices.end());
-        
-        edges.getConnectedFaces(connectedFaces);
-        edges.getConnectedEdges(connectedEdges);
+    polygonCounts.get(buffer.data());
+    polygonConnects.get(buffer.data() + polygonCounts.length());
 
-        insertAll(connectedFaces, edge.connectedFaces);
-        insertAll(connectedEdges, edge.connectedEdges);
+    PolyChecksum checksum(PolyChecksum::kCRC32C);
+    checksum.putBytes(buffer.data(), buffer.size() * sizeof(int));
 
-        edges.next();
-    }
+    return checksum.getResult();
 }
 
-void MeshData::unpackFaces(MItMeshPolygon &faces)
+void MeshData::unpackMesh(MDagPath &meshDagPath)
 {
-    this->numberOfFaces = faces.count();
-    this->faceData.resize(this->numberOfFaces);
+    ProfileScope profileScope("unpackMesh");
 
-    MIntArray connectedEdges;
-    MIntArray connectedFaces;
-    MIntArray connectedVertices;
+    MFnMesh fnMesh(meshDagPath);
 
-    faces.reset();
+    MIntArray polygonCounts;
+    MIntArray polygonConnects;
 
-    while (!faces.isDone())
-    {
-        FaceData &face = faceData[faces.index()];
-
-        faces.getEdges(connectedEdges);
-        faces.getConnectedFaces(connectedFaces);
-        faces.getVertices(connectedVertices);
+    fnMesh.getVertices(polygonCounts, polygonConnects);
 
-        insertAll(connectedFaces, face.connectedFaces);
-        insertAll(connectedEdges, face.connectedEdges);
-        insertAll(connectedVertices, face.connectedVertices);
+    vector<int> faceVertexCounts(polygonCounts.length());
+    vector<int> faceVertexIndices(polygonConnects.length());
 
-        faces.next();
-    }
-}
+    polygonCounts.get(faceVertexCounts.data());
+    polygonConnects.get(faceVertexIndices.data());
 
-void MeshData::unpackVertices(MItMeshVertex &vertices)
-{
-    this->numberOfVertices = vertices.count();
-    this->vertexData.resize(this->numberOfVertices);
+    int numberOfEdges = fnMesh.numEdges();
+    vector<int> edgeVertexIndices(numberOfEdges * 2);
 
-    MIntArray connectedEdges;
-    MIntArray connectedFaces;
-    MIntArray connectedVertices;
+    int2 edgeVertexPair;
 
-    vertices.reset();
-
-    while (!vertices.isDone())
+    for (int e = 0; e < numberOfEdges; e++)
     {
-        VertexData &vertex = vertexData[vertices.index()];
-
-        vertices.getConnectedEdges(connectedEdges);
-        vertices.getConnectedFaces(connectedFaces);
-        vertices.getConnectedVertices(connectedVertices);
-
-        insertAll(connectedFaces, vertex.connectedFaces);
-        insertAll(connectedEdges, vertex.connectedEdges);
-        insertAll(connectedVertices, vertex.connectedVertices);
-
-        vertices.next();
-    }
-}
+        fnMesh.getEdgeVertices(e, edgeVertexPair);
 
-void MeshData::unpackVertexSiblings()
-{
-    for (int vertexIndex = 0; vertexIndex < this->numberOfVertices; vertexIndex++)
-    {
-        for (int &faceIndex : vertexData[vertexIndex].connectedFaces)
-        {
-            vertexData[vertexIndex].faceVertexSiblings.emplace(faceIndex, vector<int>());
-
-            for (int &faceVertexIndex : faceData[faceIndex].connectedVertices)
-            {
-                if (contains(vertexData[faceVertexIndex].connectedVertices, vertexIndex))
-                {
-                    vertexData[vertexIndex].faceVertexSiblings[faceIndex].push_back(faceVertexIndex);
-                }
-            }
-
-            sort(
-                vertexData[vertexIndex].faceVertexSiblings[faceIndex].begin(), 
-                vertexData[vertexIndex].faceVertexSiblings[faceIndex].end()
-            );
-        }
+        edgeVertexIndices[e * 2] = edgeVertexPair[0];
+        edgeVertexIndices[e * 2 + 1] = edgeVertexPair[1];
     }
-}
 
-void MeshData::insertAll(MIntArray &src, vector<int> &dest)
-{
-    dest.resize(src.length());
+    profileScope.countAllocation((faceVertexCounts.size() + faceVertexIndices.size() + edgeVertexIndices.size()) * sizeof(int));
 
-    for (uint i = 0; i < src.length(); i++)
-    {
-        dest[i] = src[i];
-    }
-
-    sort(dest.begin(), dest.end());
-}
\ No newline at end of file
+    this->buildTopology(
+        fnMesh.numVertices(),
+        faceVertexCounts,
+        faceVertexIndices,
+        edgeVertexIndices
+    );
+}
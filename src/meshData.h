@@ -6,62 +6,32 @@
 #ifndef MESH_DATA_CMD_H
 #define MESH_DATA_CMD_H
 
-#include <vector>
-#include <unordered_map>
+#include "meshTopology.h"
+#include "polyChecksum.h"
 
 #include <maya/MDagPath.h>
-#include <maya/MItMeshEdge.h>
-#include <maya/MItMeshPolygon.h>
-#include <maya/MItMeshVertex.h>
 
 using namespace std;
 
-struct ComponentData
-{
-    vector<int> connectedVertices;
-    vector<int> connectedEdges;
-    vector<int> connectedFaces;
-};
-
-struct VertexData : ComponentData
-{
-    unordered_map<int,vector<int>> faceVertexSiblings;
-};
-    
-struct EdgeData : ComponentData {};
-struct FaceData : ComponentData {};
-
-class MeshData
+/*
+    MeshTopology read from a Maya mesh. The polygon description is pulled 
+    from MFnMesh in bulk and all adjacency is derived from it in linear
+    passes, rather than querying an iterator once per component.
+*/
+class MeshData : public MeshTopology
 {
 public:
     MeshData();
     virtual ~MeshData();
 
     virtual void            unpackMesh(MDagPath &meshDagPath);
-    virtual void            clear();
 
     static unsigned long    getVertexChecksum(MDagPath &meshDagPath);
-
-private:
-    
-    virtual void        unpackEdges(MItMeshEdge &edges);
-    virtual void        unpackFaces(MItMeshPolygon &faces);
-    virtual void        unpackVertices(MItMeshVertex &vertices);
-    virtual void        unpackVertexSiblings();
-    
-    virtual void        insertAll(MIntArray &src, vector<int> &dest);
+    static unsigned long    getFastChecksum(MDagPath &meshDagPath);
 
 public:
-    int                     numberOfVertices = 0;
-    int                     numberOfEdges = 0;
-    int                     numberOfFaces = 0;
-    
-    vector<VertexData>      vertexData;
-    vector<EdgeData>        edgeData;
-    vector<FaceData>        faceData;
-
     unsigned long           vertexChecksum;
 };
 
 
-#endif
\ No newline at end of file
+#endif
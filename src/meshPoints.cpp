@@ -0,0 +1,349 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshCorrespondence.h"
+#include "meshPoints.h"
+#include "pointKernels.h"
+#include "polyChecksum.h"
+#include "profiling.h"
+#include "undoDelta.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <maya/MDagPath.h>
+#include <maya/MFloatPointArray.h>
+#include <maya/MFnMesh.h>
+#include <maya/MIntArray.h>
+#include <maya/MMatrix.h>
+#include <maya/MPoint.h>
+#include <maya/MStatus.h>
+#include <maya/MVector.h>
+
+using namespace std;
+
+// Subsets smaller than 1 / SPARSE_POINTS_FRACTION of the mesh are accessed point by point.
+#define SPARSE_POINTS_FRACTION 8
+
+static bool isSparse(MFnMesh &fnMesh, size_t numberOfPoints)
+{
+    return numberOfPoints * SPARSE_POINTS_FRACTION < (size_t) fnMesh.numVertices();
+}
+
+void getSymmetricVertices(
+    const vector<int> &vertexSymmetry,
+    const vector<int> &selectedVertices,
+    const vector<float> &selectedWeights,
+    vector<int> &vertices,
+    vector<int> &symmetry,
+    vector<float> &weights
+) {
+    int numberOfVertices = (int) vertexSymmetry.size();
+
+    vector<float> vertexWeights(numberOfVertices, 0.0f);
+    vector<char> isSelected(numberOfVertices, 0);
+
+    for (size_t k = 0; k < selectedVertices.size(); k++)
+    {
+        int i = selectedVertices[k];
+
+        if (i < 0 || i >= numberOfVertices) { continue; }
+
+        int o = vertexSymmetry[i] < 0 ? i : vertexSymmetry[i];
+
+        isSelected[i] = 1;
+        isSelected[o] = 1;
+
+        vertexWeights[i] = max(vertexWeights[i], selectedWeights[k]);
+        vertexWeights[o] = max(vertexWeights[o], selectedWeights[k]);
+    }
+
+    vector<int> position(numberOfVertices, -1);
+
+    vertices.clear();
+    weights.clear();
+
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        if (!isSelected[i]) { continue; }
+
+        position[i] = (int) vertices.size();
+        vertices.push_back(i);
+        weights.push_back(vertexWeights[i]);
+    }
+
+    symmetry.resize(vertices.size());
+
+    for (size_t k = 0; k < vertices.size(); k++)
+    {
+        int o = vertexSymmetry[vertices[k]];
+        symmetry[k] = o < 0 ? (int) k : position[o];
+    }
+}
+
+void blendVertexPoints(const vector<float> &originalPoints, const vector<float> &weights, vector<float> &newPoints)
+{
+    for (size_t k = 0; k < weights.size(); k++)
+    {
+        float w = weights[k];
+
+        if (w >= 1.0f) { continue; }
+
+        const float* p = originalPoints.data() + k * 4;
+        float* r = newPoints.data() + k * 4;
+
+        for (int c = 0; c < 3; c++) { r[c] = p[c] + (r[c] - p[c]) * w; }
+    }
+}
+
+void blendSelectedPoints(
+    const MFloatPointArray &originalPoints, 
+    const vector<int> &selectedVertices, 
+    const vector<float> &selectedWeights, 
+    MFloatPointArray &newPoints
+) {
+    if (selectedVertices.empty()) { return; }
+
+    int numberOfVertices = (int) originalPoints.length();
+
+    vector<float> vertexWeights(numberOfVertices, 0.0f);
+
+    for (size_t k = 0; k < selectedVertices.size(); k++)
+    {
+        int i = selectedVertices[k];
+
+        if (i >= 0 && i < numberOfVertices) { vertexWeights[i] = max(vertexWeights[i], selectedWeights[k]); }
+    }
+
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        float w = vertexWeights[i];
+
+        if (w >= 1.0f) { continue; }
+
+        const MFloatPoint &p = originalPoints[i];
+        MFloatPoint &r = newPoints[i];
+
+        r.x = p.x + (r.x - p.x) * w;
+        r.y = p.y + (r.y - p.y) * w;
+        r.z = p.z + (r.z - p.z) * w;
+    }
+}
+
+void getVertexPoints(MFnMesh &fnMesh, const vector<int> &vertices, MSpace::Space space, vector<float> &points)
+{
+    MStatus status;
+
+    ProfileScope profileScope("getPoints");
+
+    points.resize(vertices.size() * 4);
+
+    if (space == MSpace::kObject)
+    {
+        const float* rawPoints = fnMesh.getRawPoints(&status);
+
+        for (size_t k = 0; k < vertices.size(); k++)
+        {
+            const float* p = rawPoints + (size_t) vertices[k] * 3;
+            float* r = points.data() + k * 4;
+
+            r[0] = p[0]; r[1] = p[1]; r[2] = p[2]; r[3] = 1.0f;
+        }
+    } else if (isSparse(fnMesh, vertices.size())) {
+        MPoint pnt;
+
+        for (size_t k = 0; k < vertices.size(); k++)
+        {
+            fnMesh.getPoint(vertices[k], pnt, space);
+
+            float* r = points.data() + k * 4;
+            r[0] = (float) pnt.x; r[1] = (float) pnt.y; r[2] = (float) pnt.z; r[3] = 1.0f;
+        }
+    } else {
+        MFloatPointArray meshPoints;
+        fnMesh.getPoints(meshPoints, space);
+
+        for (size_t k = 0; k < vertices.size(); k++)
+        {
+            const MFloatPoint &pnt = meshPoints[vertices[k]];
+
+            float* r = points.data() + k * 4;
+            r[0] = pnt.x; r[1] = pnt.y; r[2] = pnt.z; r[3] = 1.0f;
+        }
+    }
+}
+
+void setVertexPoints(MFnMesh &fnMesh, const vector<int> &vertices, const float* points, int stride, MSpace::Space space)
+{
+    if (vertices.empty()) { return; }
+
+    ProfileScope profileScope("setPoints");
+
+    if (isSparse(fnMesh, vertices.size()))
+    {
+        for (size_t k = 0; k < vertices.size(); k++)
+        {
+            const float* p = points + k * stride;
+            fnMesh.setPoint(vertices[k], MPoint(p[0], p[1], p[2]), space);
+        }
+
+        fnMesh.updateSurface();
+    } else {
+        MFloatPointArray meshPoints;
+        fnMesh.getPoints(meshPoints, space);
+
+        for (size_t k = 0; k < vertices.size(); k++)
+        {
+            const float* p = points + k * stride;
+            meshPoints[vertices[k]] = MFloatPoint(p[0], p[1], p[2]);
+        }
+
+        fnMesh.setPoints(meshPoints, space);
+    }
+}
+
+void restoreVertexPoints(MFnMesh &fnMesh, const RowDelta<float> &delta, MSpace::Space space)
+{
+    if (delta.empty()) { return; }
+
+    vector<int> vertices;
+    delta.getRows(vertices);
+
+    setVertexPoints(fnMesh, vertices, delta.getOldValues().data(), 3, space);
+}
+
+/*
+    The plane is spanned by the frame's other two axes, so that a sheared or
+    non-uniformly scaled frame still mirrors across the plane it draws.
+*/
+MStatus getFramePlane(const MDagPath &frame, int axis, const MDagPath &mesh, MSpace::Space space, MirrorPlane &plane)
+{
+    MMatrix matrix = frame.inclusiveMatrix();
+
+    if (space == MSpace::kObject)
+    {
+        matrix = matrix * mesh.inclusiveMatrixInverse();
+    }
+
+    return getFramePlane(matrix, axis, plane);
+}
+
+MStatus getFramePlane(const MMatrix &matrix, int axis, MirrorPlane &plane)
+{
+    unsigned uAxis = (axis + 1) % 3;
+    unsigned vAxis = (axis + 2) % 3;
+
+    MVector u(matrix(uAxis, 0), matrix(uAxis, 1), matrix(uAxis, 2));
+    MVector v(matrix(vAxis, 0), matrix(vAxis, 1), matrix(vAxis, 2));
+    MVector origin(matrix(3, 0), matrix(3, 1), matrix(3, 2));
+
+    MVector normal = u ^ v;
+
+    if (normal.length() < 1e-10) { return MStatus::kFailure; }
+
+    // The plane normalizes the normal and the offset together.
+    float n[3] = {(float) normal.x, (float) normal.y, (float) normal.z};
+    plane = MirrorPlane(n, (float) (normal * origin));
+
+    return MStatus::kSuccess;
+}
+
+static int getPointsChecksum(PointBuffer points, int numberOfPoints)
+{
+    PolyChecksum checksum(PolyChecksum::kCRC32C);
+
+    for (int i = 0; i < numberOfPoints; i++)
+    {
+        checksum.putBytes(points.data + (size_t) i * points.stride, 3 * sizeof(float));
+    }
+
+    return checksum.getResult();
+}
+
+MStatus getMeshCorrespondence(
+    MFnMesh &surfaceMesh,
+    PointBuffer surfacePoints,
+    PointBuffer points,
+    int numberOfPoints,
+    bool flip,
+    bool mirror,
+    int direction,
+    const MirrorPlane &plane,
+    shared_ptr<const MeshCorrespondence> &correspondence
+) {
+    MStatus status;
+
+    MIntArray triangleCounts;
+    MIntArray triangleVertexArray;
+
+    status = surfaceMesh.getTriangles(triangleCounts, triangleVertexArray);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    int numberOfTriangles = (int) triangleVertexArray.length() / 3;
+
+    if (numberOfTriangles == 0) { return MStatus::kFailure; }
+
+    vector<int> triangleVertices(triangleVertexArray.length());
+    triangleVertexArray.get(triangleVertices.data());
+
+    PolyChecksum surfaceChecksum(PolyChecksum::kCRC32C);
+    surfaceChecksum.putBytes(triangleVertices.data(), triangleVertices.size() * sizeof(int));
+
+    int numberOfSurfacePoints = surfaceMesh.numVertices();
+
+    string key = to_string(numberOfSurfacePoints) 
+        + ":" + to_string(getPointsChecksum(surfacePoints, numberOfSurfacePoints))
+        + ":" + to_string(surfaceChecksum.getResult())
+        + ":" + to_string(numberOfPoints) 
+        + ":" + to_string(getPointsChecksum(points, numberOfPoints))
+        + ":" + to_string(flip) + to_string(mirror) + to_string(direction)
+        + ":" + to_string(plane.normal[0]) + "," + to_string(plane.normal[1]) + "," + to_string(plane.normal[2]) + "," + to_string(plane.offset);
+
+    if (MeshCorrespondenceCache::getCorrespondence(key, correspondence)) { return MStatus::kSuccess; }
+
+    ProfileScope profileScope("buildCorrespondence");
+
+    TriangleBVH surface;
+    surface.build(surfacePoints, triangleVertices.data(), numberOfTriangles);
+
+    shared_ptr<MeshCorrespondence> result = make_shared<MeshCorrespondence>();
+    buildCorrespondence(surface, points, numberOfPoints, flip, mirror, direction, plane, *result);
+
+    profileScope.countAllocation(result->vertices.size() * (sizeof(int) + sizeof(float)));
+
+    correspondence = result;
+    MeshCorrespondenceCache::addCorrespondence(key, correspondence);
+
+    return MStatus::kSuccess;
+}
+
+bool isPointCompatible(MFnMesh &fnMesh, MFnMesh &otherMesh)
+{
+    return fnMesh.numVertices() == otherMesh.numVertices()
+        && fnMesh.numEdges() == otherMesh.numEdges()
+        && fnMesh.numPolygons() == otherMesh.numPolygons();
+}
+
+MStatus getProjectedPoints(
+    MFnMesh &referenceMesh,
+    PointBuffer referencePoints,
+    PointBuffer points,
+    int numberOfPoints,
+    vector<float> &result
+) {
+    MStatus status;
+
+    shared_ptr<const MeshCorrespondence> correspondence;
+
+    status = getMeshCorrespondence(referenceMesh, referencePoints, points, numberOfPoints, false, false, 1, MirrorPlane(), correspondence);
+    if (!status) { return status; }
+
+    result.resize((size_t) numberOfPoints * 4);
+    interpolatePoints(referencePoints, *correspondence, result.data());
+
+    return MStatus::kSuccess;
+}
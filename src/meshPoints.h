@@ -0,0 +1,116 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef MESH_POINTS_H
+#define MESH_POINTS_H
+
+#include "meshCorrespondence.h"
+#include "pointKernels.h"
+#include "undoDelta.h"
+
+#include <memory>
+#include <vector>
+
+#include <maya/MDagPath.h>
+#include <maya/MFloatPointArray.h>
+#include <maya/MFnMesh.h>
+#include <maya/MMatrix.h>
+#include <maya/MStatus.h>
+#include <maya/MTypes.h>
+
+using namespace std;
+
+/*
+    Reads and writes for the points of a subset of a mesh's vertices, used
+    when polyFlip and polyMirror only have to touch a component selection.
+    Small subsets are accessed point by point; large ones go through a
+    single read or write of the whole mesh, which is faster past a point.
+*/
+
+/*
+    Expands a selection of vertices to include their symmetry partners.
+    `vertices` is sorted and holds each selected vertex and its partner once,
+    `symmetry` is `vertexSymmetry` remapped to positions in `vertices`, and
+    each weight is the larger of the vertex weight and its partner's.
+*/
+void        getSymmetricVertices(
+                const vector<int> &vertexSymmetry,
+                const vector<int> &selectedVertices,
+                const vector<float> &selectedWeights,
+                vector<int> &vertices,
+                vector<int> &symmetry,
+                vector<float> &weights
+            );
+
+/* Moves each new point back towards its original point by one minus its weight. */
+void        blendVertexPoints(const vector<float> &originalPoints, const vector<float> &weights, vector<float> &newPoints);
+
+/* 
+    Same as `blendVertexPoints` for every point of a mesh, where the points
+    of vertices that are not selected are moved all the way back. 
+*/
+void        blendSelectedPoints(
+                const MFloatPointArray &originalPoints, 
+                const vector<int> &selectedVertices, 
+                const vector<float> &selectedWeights, 
+                MFloatPointArray &newPoints
+            );
+
+/* Reads the points of `vertices`, packed 4 floats per point. */
+void        getVertexPoints(MFnMesh &fnMesh, const vector<int> &vertices, MSpace::Space space, vector<float> &points);
+
+/* Writes packed points, `stride` floats apart, to `vertices`. */
+void        setVertexPoints(MFnMesh &fnMesh, const vector<int> &vertices, const float* points, int stride, MSpace::Space space);
+
+/* Writes the old points recorded in `delta` back to the mesh. */
+void        restoreVertexPoints(MFnMesh &fnMesh, const RowDelta<float> &delta, MSpace::Space space);
+
+/*
+    Plane through the origin of the transform `frame`, normal to its `axis`,
+    in the `space` that the points of `mesh` are read in. Fails if the frame
+    is scaled flat along the axis.
+*/
+MStatus     getFramePlane(const MDagPath &frame, int axis, const MDagPath &mesh, MSpace::Space space, MirrorPlane &plane);
+
+/* Same as above, for a frame whose matrix is already in the space of the points. */
+MStatus     getFramePlane(const MMatrix &matrix, int axis, MirrorPlane &plane);
+
+/*
+    Locates `points` on the triangles of `surfaceMesh`, with its vertices at
+    `surfacePoints`, for meshes that have no symmetry tables to go through or
+    that do not share a topology. See `buildCorrespondence` for the options.
+    Results are cached by a checksum of the surface, the points, and the
+    options. Fails if the surface has no faces.
+*/
+MStatus     getMeshCorrespondence(
+                MFnMesh &surfaceMesh,
+                PointBuffer surfacePoints,
+                PointBuffer points,
+                int numberOfPoints,
+                bool flip,
+                bool mirror,
+                int direction,
+                const MirrorPlane &plane,
+                shared_ptr<const MeshCorrespondence> &correspondence
+            );
+
+/* True if the meshes have the same number of vertices, edges, and faces. */
+bool        isPointCompatible(MFnMesh &fnMesh, MFnMesh &otherMesh);
+
+/*
+    Rest points for a mesh that is not point compatible with its reference, 
+    such as an LOD or a retopology of it: each of `points` is moved to the 
+    closest point on the surface of `referenceMesh`. Written 4 floats per
+    point. Fails if the reference has no faces.
+*/
+MStatus     getProjectedPoints(
+                MFnMesh &referenceMesh,
+                PointBuffer referencePoints,
+                PointBuffer points,
+                int numberOfPoints,
+                vector<float> &result
+            );
+
+#endif
@@ -0,0 +1,241 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshTopology.h"
+#include "util.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+/*
+    Builds the table mapping each target component back to the source rows
+    that reference it. Sources are visited in ascending order, so every row
+    of the result comes out sorted without a sort pass. Rows of `src` must be
+    sorted so that repeated references can be skipped; negative references
+    are ignored.
+*/
+static void transpose(const AdjacencyTable &src, int numberOfTargets, AdjacencyTable &dest)
+{
+    int numberOfSources = (int) src.offsets.size() - 1;
+
+    dest.offsets.assign(numberOfTargets + 1, 0);
+
+    for (int s = 0; s < numberOfSources; s++)
+    {
+        for (int i = src.offsets[s]; i < src.offsets[s + 1]; i++)
+        {
+            if (src.indices[i] < 0) { continue; }
+
+            if (i == src.offsets[s] || src.indices[i] != src.indices[i - 1])
+            {
+                dest.offsets[src.indices[i] + 1]++;
+            }
+        }
+    }
+
+    for (int t = 0; t < numberOfTargets; t++)
+    {
+        dest.offsets[t + 1] += dest.offsets[t];
+    }
+
+    dest.indices.resize(dest.offsets[numberOfTargets]);
+    vector<int> cursor(dest.offsets.begin(), dest.offsets.end() - 1);
+
+    for (int s = 0; s < numberOfSources; s++)
+    {
+        for (int i = src.offsets[s]; i < src.offsets[s + 1]; i++)
+        {
+            if (src.indices[i] < 0) { continue; }
+
+            if (i == src.offsets[s] || src.indices[i] != src.indices[i - 1])
+            {
+                dest.indices[cursor[src.indices[i]]++] = s;
+            }
+        }
+    }
+}
+
+MeshTopology::MeshTopology() {}
+
+MeshTopology::~MeshTopology()
+{
+    this->clear();
+}
+
+void MeshTopology::clear()
+{
+    numberOfEdges = 0;
+    numberOfFaces = 0;
+    numberOfVertices = 0;
+
+    vertexVertices.clear();
+    vertexEdges.clear();
+    vertexFaces.clear();
+
+    edgeVertices.clear();
+    edgeFaces.clear();
+
+    faceVertices.clear();
+    faceEdges.clear();
+
+    faceVertexSiblings.clear();
+}
+
+/*
+    Derives every adjacency table from the polygon counts and connects of
+    a mesh (as returned by `MFnMesh::getVertices`) plus the two vertices
+    of each edge. Edge indices are taken from `edgeVertexIndices`, so they
+    match the indices of the source mesh.
+*/
+void MeshTopology::buildTopology(
+    int numberOfVertices,
+    const vector<int> &faceVertexCounts,
+    const vector<int> &faceVertexIndices,
+    const vector<int> &edgeVertexIndices
+) {
+    this->clear();
+
+    this->numberOfVertices = numberOfVertices;
+    this->numberOfEdges = (int) edgeVertexIndices.size() / 2;
+    this->numberOfFaces = (int) faceVertexCounts.size();
+
+    this->buildEdges(edgeVertexIndices);
+    this->buildFaces(faceVertexCounts, faceVertexIndices);
+    this->buildVertexSiblings();
+}
+
+IndexRange MeshTopology::getFaceVertexSiblings(int vertexIndex, int faceIndex) const
+{
+    int offset = vertexFaces.offsets[vertexIndex];
+    int numberOfFaces = vertexFaces.count(vertexIndex);
+
+    for (int i = 0; i < numberOfFaces; i++)
+    {
+        if (vertexFaces.indices[offset + i] == faceIndex)
+        {
+            return faceVertexSiblings[offset + i];
+        }
+    }
+
+    return IndexRange();
+}
+
+void MeshTopology::buildEdges(const vector<int> &edgeVertexIndices)
+{
+    edgeVertices.offsets.resize(this->numberOfEdges + 1);
+    edgeVertices.indices.resize(this->numberOfEdges * 2);
+
+    for (int e = 0; e < this->numberOfEdges; e++)
+    {
+        int v0 = edgeVertexIndices[e * 2];
+        int v1 = edgeVertexIndices[e * 2 + 1];
+
+        edgeVertices.offsets[e] = e * 2;
+        edgeVertices.indices[e * 2] = min(v0, v1);
+        edgeVertices.indices[e * 2 + 1] = max(v0, v1);
+    }
+
+    edgeVertices.offsets[this->numberOfEdges] = this->numberOfEdges * 2;
+
+    transpose(edgeVertices, this->numberOfVertices, vertexEdges);
+
+    vertexVertices.offsets = vertexEdges.offsets;
+    vertexVertices.indices.resize(vertexEdges.indices.size());
+
+    for (int v = 0; v < this->numberOfVertices; v++)
+    {
+        int first = vertexEdges.offsets[v];
+        int last = vertexEdges.offsets[v + 1];
+
+        for (int i = first; i < last; i++)
+        {
+            int e = vertexEdges.indices[i];
+            int v0 = edgeVertices.indices[e * 2];
+            int v1 = edgeVertices.indices[e * 2 + 1];
+
+            vertexVertices.indices[i] = v0 == v ? v1 : v0;
+        }
+
+        sort(vertexVertices.indices.begin() + first, vertexVertices.indices.begin() + last);
+    }
+}
+
+void MeshTopology::buildFaces(const vector<int> &faceVertexCounts, const vector<int> &faceVertexIndices)
+{
+    faceVertices.offsets.resize(this->numberOfFaces + 1);
+    faceVertices.indices.assign(faceVertexIndices.begin(), faceVertexIndices.end());
+
+    faceEdges.offsets.resize(this->numberOfFaces + 1);
+    faceEdges.indices.resize(faceVertexIndices.size());
+
+    int offset = 0;
+
+    for (int f = 0; f < this->numberOfFaces; f++)
+    {
+        int count = faceVertexCounts[f];
+
+        faceVertices.offsets[f] = offset;
+        faceEdges.offsets[f] = offset;
+
+        for (int i = 0; i < count; i++)
+        {
+            int v0 = faceVertexIndices[offset + i];
+            int v1 = faceVertexIndices[offset + (i + 1) % count];
+            int edgeIndex = -1;
+
+            for (const int &e : vertexEdges[v0])
+            {
+                if (edgeVertices.indices[e * 2] == min(v0, v1) && edgeVertices.indices[e * 2 + 1] == max(v0, v1))
+                {
+                    edgeIndex = e;
+                    break;
+                }
+            }
+
+            faceEdges.indices[offset + i] = edgeIndex;
+        }
+
+        sort(faceVertices.indices.begin() + offset, faceVertices.indices.begin() + offset + count);
+        sort(faceEdges.indices.begin() + offset, faceEdges.indices.begin() + offset + count);
+
+        offset += count;
+    }
+
+    faceVertices.offsets[this->numberOfFaces] = offset;
+    faceEdges.offsets[this->numberOfFaces] = offset;
+
+    transpose(faceVertices, this->numberOfVertices, vertexFaces);
+    transpose(faceEdges, this->numberOfEdges, edgeFaces);
+}
+
+void MeshTopology::buildVertexSiblings()
+{
+    faceVertexSiblings.offsets.reserve(vertexFaces.indices.size() + 1);
+    faceVertexSiblings.indices.reserve(vertexFaces.indices.size() * 2);
+    faceVertexSiblings.offsets.push_back(0);
+
+    for (int vertexIndex = 0; vertexIndex < this->numberOfVertices; vertexIndex++)
+    {
+        IndexRange neighbors = vertexVertices[vertexIndex];
+
+        for (const int &faceIndex : vertexFaces[vertexIndex])
+        {
+            IndexRange faceVertexIndices = faceVertices[faceIndex];
+
+            set_intersection(
+                neighbors.begin(),
+                neighbors.end(),
+                faceVertexIndices.begin(),
+                faceVertexIndices.end(),
+                back_inserter(faceVertexSiblings.indices)
+            );
+
+            faceVertexSiblings.offsets.push_back((int) faceVertexSiblings.indices.size());
+        }
+    }
+}
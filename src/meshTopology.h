@@ -0,0 +1,79 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef MESH_TOPOLOGY_H
+#define MESH_TOPOLOGY_H
+
+#include "util.h"
+
+#include <vector>
+
+using namespace std;
+
+/*
+    Compressed sparse row storage for one component->component relationship.
+    The indices connected to component `i` are stored contiguously in
+    `indices[offsets[i]]` to `indices[offsets[i + 1]]`.
+*/
+struct AdjacencyTable
+{
+    vector<int>     offsets;
+    vector<int>     indices;
+
+    IndexRange      operator[](int i) const     { return IndexRange(indices.data() + offsets[i], indices.data() + offsets[i + 1]); }
+    int             count(int i) const          { return offsets[i + 1] - offsets[i]; }
+
+    void            clear()                     { offsets.clear(); indices.clear(); }
+};
+
+/*
+    Mesh adjacency derived from the raw polygon description of a mesh.
+    This class has no Maya dependencies so the solver can run on meshes
+    that do not come from a Maya scene.
+*/
+class MeshTopology
+{
+public:
+    MeshTopology();
+    virtual ~MeshTopology();
+
+    virtual void            buildTopology(
+                                int numberOfVertices,
+                                const vector<int> &faceVertexCounts,
+                                const vector<int> &faceVertexIndices,
+                                const vector<int> &edgeVertexIndices
+                            );
+    virtual void            clear();
+
+    IndexRange              getFaceVertexSiblings(int vertexIndex, int faceIndex) const;
+
+private:
+    virtual void            buildEdges(const vector<int> &edgeVertexIndices);
+    virtual void            buildFaces(const vector<int> &faceVertexCounts, const vector<int> &faceVertexIndices);
+    virtual void            buildVertexSiblings();
+
+public:
+    int                     numberOfVertices = 0;
+    int                     numberOfEdges = 0;
+    int                     numberOfFaces = 0;
+
+    AdjacencyTable          vertexVertices;
+    AdjacencyTable          vertexEdges;
+    AdjacencyTable          vertexFaces;
+
+    AdjacencyTable          edgeVertices;
+    AdjacencyTable          edgeFaces;
+
+    AdjacencyTable          faceVertices;
+    AdjacencyTable          faceEdges;
+
+    /*
+        Vertices that share an edge with a vertex on a face, packed per
+        vertex-face pair in the same order as `vertexFaces`.
+    */
+    AdjacencyTable          faceVertexSiblings;
+};
+
+#endif
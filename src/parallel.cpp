@@ -0,0 +1,195 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+    Workers are kept alive between loops so that algorithms which run many 
+    short parallel steps (such as a level-by-level flood fill) do not pay for 
+    thread creation on each step. 
+*/
+class ThreadPool
+{
+public:
+    ~ThreadPool();
+
+    void                    run(int numberOfThreads, const function<void(int)> &task);
+    void                    release();
+
+private:
+    void                    workerLoop(int workerIndex, unsigned int lastGeneration);
+
+private:
+    vector<thread>          workers;
+
+    mutex                   runMutex;
+    mutex                   stateMutex;
+    condition_variable      wakeCondition;
+    condition_variable      doneCondition;
+
+    const function<void(int)>* task = nullptr;
+
+    int                     activeWorkers = 0;
+    int                     pendingWorkers = 0;
+    unsigned int            generation = 0;
+    bool                    stopping = false;
+};
+
+static ThreadPool threadPool;
+static thread_local bool insideParallelLoop = false;
+
+ThreadPool::~ThreadPool()
+{
+    this->release();
+}
+
+void ThreadPool::run(int numberOfThreads, const function<void(int)> &task)
+{
+    // Nested loops, and loops started while another thread owns the pool, 
+    // run on the calling thread.
+    unique_lock<mutex> runLock(runMutex, defer_lock);
+
+    if (numberOfThreads <= 1 || insideParallelLoop || !runLock.try_lock())
+    {
+        for (int t = 0; t < numberOfThreads; t++) { task(t); }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        while ((int) workers.size() < numberOfThreads - 1)
+        {
+            workers.push_back(thread(&ThreadPool::workerLoop, this, (int) workers.size(), generation));
+        }
+
+        this->task = &task;
+        this->activeWorkers = numberOfThreads - 1;
+        this->pendingWorkers = numberOfThreads - 1;
+        this->generation++;
+    }
+
+    wakeCondition.notify_all();
+
+    insideParallelLoop = true;
+    task(0);
+    insideParallelLoop = false;
+
+    unique_lock<mutex> lock(stateMutex);
+    doneCondition.wait(lock, [this] { return pendingWorkers == 0; });
+
+    this->task = nullptr;
+}
+
+void ThreadPool::release()
+{
+    lock_guard<mutex> runLock(runMutex);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopping = true;
+    }
+
+    wakeCondition.notify_all();
+
+    for (thread &t : workers) { t.join(); }
+
+    workers.clear();
+    stopping = false;
+}
+
+void ThreadPool::workerLoop(int workerIndex, unsigned int lastGeneration)
+{
+    insideParallelLoop = true;
+
+    while (true)
+    {
+        unique_lock<mutex> lock(stateMutex);
+
+        wakeCondition.wait(lock, [&] {
+            return stopping || (generation != lastGeneration && workerIndex < activeWorkers);
+        });
+
+        if (stopping) { return; }
+
+        lastGeneration = generation;
+        const function<void(int)> *currentTask = this->task;
+
+        lock.unlock();
+
+        (*currentTask)(workerIndex + 1);
+
+        lock.lock();
+
+        if (--pendingWorkers == 0) 
+        { 
+            doneCondition.notify_one(); 
+        }
+    }
+}
+
+int getNumberOfThreads()
+{
+    unsigned int numberOfThreads = thread::hardware_concurrency();
+
+    return numberOfThreads == 0 ? 1 : (int) numberOfThreads;
+}
+
+void parallelFor(int count, const function<void(int, int)> &fn, int maxThreads)
+{
+    int numberOfThreads = getNumberOfThreads();
+
+    if (maxThreads > 0) { numberOfThreads = min(numberOfThreads, maxThreads); }
+
+    numberOfThreads = min(numberOfThreads, count);
+
+    atomic<int> nextIndex(0);
+
+    threadPool.run(numberOfThreads, [&](int threadIndex)
+    {
+        for (int i = nextIndex++; i < count; i = nextIndex++)
+        {
+            fn(i, threadIndex);
+        }
+    });
+}
+
+void parallelForRange(int count, int grainSize, const function<void(int, int, int)> &fn)
+{
+    if (count <= 0) { return; }
+
+    grainSize = max(grainSize, 1);
+
+    int numberOfChunks = (count + grainSize - 1) / grainSize;
+    int numberOfThreads = min(getNumberOfThreads(), numberOfChunks);
+
+    atomic<int> nextChunk(0);
+
+    threadPool.run(numberOfThreads, [&](int threadIndex)
+    {
+        for (int c = nextChunk++; c < numberOfChunks; c = nextChunk++)
+        {
+            int first = c * grainSize;
+            int last = min(first + grainSize, count);
+
+            fn(first, last, threadIndex);
+        }
+    });
+}
+
+void releaseThreadPool()
+{
+    threadPool.release();
+}
@@ -0,0 +1,40 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_PARALLEL_H
+#define POLY_SYMMETRY_PARALLEL_H
+
+#include <functional>
+
+using namespace std;
+
+/*
+    Number of worker threads used by the parallel helpers below. 
+*/
+int         getNumberOfThreads();
+
+/*
+    Calls `fn(index, threadIndex)` for every index in [0, count) on a pool of 
+    at most `maxThreads` threads (0 uses all of them). Indices are handed 
+    out one at a time, so items of very different cost balance well. 
+    `threadIndex` is in [0, number of threads) and can be used to select 
+    per-thread scratch data.
+*/
+void        parallelFor(int count, const function<void(int, int)> &fn, int maxThreads = 0);
+
+/*
+    Calls `fn(first, last, threadIndex)` over consecutive chunks of [0, count) 
+    of about `grainSize` items. Meant for cheap, uniform per-item work where 
+    the cost of dispatching single items would dominate. 
+*/
+void        parallelForRange(int count, int grainSize, const function<void(int, int, int)> &fn);
+
+/*
+    Stops and joins the worker threads. They are restarted on demand, so 
+    this is safe to call at any time that no parallel loop is running.
+*/
+void        releaseThreadPool();
+
+#endif
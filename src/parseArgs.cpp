@@ -6,12 +6,16 @@
 #include "parseArgs.h"
 
 #include <maya/MArgDatabase.h>
+#include <maya/MArgList.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MGlobal.h>
 #include <maya/MObject.h>
+#include <maya/MObjectArray.h>
 #include <maya/MSelectionList.h>
 #include <maya/MStatus.h>
 #include <maya/MString.h>
+#include <maya/MSyntax.h>
 
 MStatus parseArgs::getNodeArgument(MArgDatabase &argsData, const char* flag, MObject &node, bool required)
 {
@@ -50,6 +54,156 @@ MStatus parseArgs::getDagPathArgument(MArgDatabase &argsData, const char* flag,
     return MStatus::kSuccess; 
 }
 
+/* Reads every use of a multi-use flag. Names that do not resolve to a node are an error. */
+MStatus parseArgs::getNodeArguments(MArgDatabase &argsData, const char* flag, MObjectArray &nodes, bool required)
+{
+    MStatus status;
+
+    nodes.clear();
+
+    unsigned numberOfUses = argsData.numberOfFlagUses(flag);
+
+    if (numberOfUses == 0 && required)
+    {
+        MString errorMsg("The ^1s flag is required.");
+        errorMsg.format(errorMsg, MString(flag));
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
+
+    for (unsigned i = 0; i < numberOfUses; i++)
+    {
+        MArgList flagArgs;
+        MSelectionList selection;
+        MObject node;
+
+        status = argsData.getFlagArgumentList(flag, i, flagArgs);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        MString objectName = flagArgs.asString(0);
+        status = selection.add(objectName);
+
+        if (!status)
+        {
+            MString errorMsg("No object matches name: ^1s");
+            errorMsg.format(errorMsg, objectName);
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        selection.getDependNode(0, node);
+        nodes.append(node);
+    }
+
+    return MStatus::kSuccess;
+}
+
+MStatus parseArgs::getDagPathArguments(MArgDatabase &argsData, const char* flag, MDagPathArray &paths, bool required)
+{
+    MStatus status;
+
+    MObjectArray nodes;
+    status = getNodeArguments(argsData, flag, nodes, required);
+    if (!status) { return status; }
+
+    paths.clear();
+
+    for (unsigned i = 0; i < nodes.length(); i++)
+    {
+        MDagPath path;
+        MDagPath::getAPathTo(nodes[i], path);
+        paths.append(path);
+    }
+
+    return MStatus::kSuccess;
+}
+
+void parseArgs::addMirrorPlaneFlags(MSyntax &syntax)
+{
+    syntax.addFlag(MIRROR_AXIS_FLAG, MIRROR_AXIS_LONG_FLAG, MSyntax::kString);
+    syntax.addFlag(MIRROR_PLANE_FLAG, MIRROR_PLANE_LONG_FLAG, MSyntax::kDouble, MSyntax::kDouble, MSyntax::kDouble, MSyntax::kDouble);
+    syntax.addFlag(MIRROR_FRAME_FLAG, MIRROR_FRAME_LONG_FLAG, MSyntax::kSelectionItem);
+}
+
+MStatus parseArgs::getMirrorPlaneArguments(MArgDatabase &argsData, MirrorPlane &plane, MDagPath &frame)
+{
+    MStatus status;
+
+    int axis = 0;
+
+    if (argsData.isFlagSet(MIRROR_AXIS_FLAG))
+    {
+        MString axisName;
+        status = argsData.getFlagArgument(MIRROR_AXIS_FLAG, 0, axisName);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (axisName == "x")
+        {
+            axis = 0;
+        } else if (axisName == "y") {
+            axis = 1;
+        } else if (axisName == "z") {
+            axis = 2;
+        } else {
+            MString errorMsg("Invalid axis ^1s. Expected \"x\", \"y\", or \"z\".");
+            errorMsg.format(errorMsg, axisName);
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+    }
+
+    plane = MirrorPlane(axis);
+
+    if (argsData.isFlagSet(MIRROR_PLANE_FLAG) && argsData.isFlagSet(MIRROR_FRAME_FLAG))
+    {
+        MString errorMsg("The ^1s and ^2s flags cannot be used together.");
+        errorMsg.format(errorMsg, MString(MIRROR_PLANE_LONG_FLAG), MString(MIRROR_FRAME_LONG_FLAG));
+
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
+
+    if (argsData.isFlagSet(MIRROR_PLANE_FLAG))
+    {
+        double values[4];
+
+        for (unsigned i = 0; i < 4; i++)
+        {
+            status = argsData.getFlagArgument(MIRROR_PLANE_FLAG, i, values[i]);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+        }
+
+        if (values[0] == 0.0 && values[1] == 0.0 && values[2] == 0.0)
+        {
+            MString errorMsg("The ^1s flag needs a normal that is not zero.");
+            errorMsg.format(errorMsg, MString(MIRROR_PLANE_LONG_FLAG));
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        float normal[3] = {(float) values[0], (float) values[1], (float) values[2]};
+        plane = MirrorPlane(normal, (float) values[3]);
+    }
+
+    if (argsData.isFlagSet(MIRROR_FRAME_FLAG))
+    {
+        status = getDagPathArgument(argsData, MIRROR_FRAME_FLAG, frame, false);
+
+        if (!status || !frame.isValid() || !frame.hasFn(MFn::kTransform))
+        {
+            MString errorMsg("The ^1s flag must be a transform.");
+            errorMsg.format(errorMsg, MString(MIRROR_FRAME_LONG_FLAG));
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+    }
+
+    return MStatus::kSuccess;
+}
+
 bool parseArgs::isNodeType(MObject &node, MFn::Type nodeType)
 {
     return !node.isNull() && node.hasFn(nodeType);
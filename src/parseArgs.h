@@ -1,17 +1,48 @@
 #ifndef PARSE_ARGS_H
 #define PARSE_ARGS_H
 
+#include "pointKernels.h"
+
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MFn.h>
 #include <maya/MObject.h>
+#include <maya/MObjectArray.h>
 #include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+#define MIRROR_AXIS_FLAG            "-ax"
+#define MIRROR_AXIS_LONG_FLAG       "-axis"
+
+#define MIRROR_PLANE_FLAG           "-pl"
+#define MIRROR_PLANE_LONG_FLAG      "-plane"
+
+#define MIRROR_FRAME_FLAG           "-fr"
+#define MIRROR_FRAME_LONG_FLAG      "-frame"
 
 namespace parseArgs
 {
     MStatus getNodeArgument(MArgDatabase &argsData, const char* flag, MObject &node, bool required);
     MStatus getDagPathArgument(MArgDatabase &argsData, const char* flag, MDagPath &path, bool required);
 
+    MStatus getNodeArguments(MArgDatabase &argsData, const char* flag, MObjectArray &nodes, bool required);
+    MStatus getDagPathArguments(MArgDatabase &argsData, const char* flag, MDagPathArray &paths, bool required);
+
+    /* 
+        Adds the -axis, -plane, and -frame flags shared by the commands that 
+        mirror points or weights.
+    */
+    void addMirrorPlaneFlags(MSyntax &syntax);
+
+    /*
+        Reads the mirror plane flags. -axis picks "x", "y", or "z", and -plane
+        overrides it with a normal and an offset. -frame is returned as a path
+        instead, since its plane depends on the mesh and space, and `plane`
+        keeps the axis to pass to `getFramePlane`. The default is the YZ plane.
+    */
+    MStatus getMirrorPlaneArguments(MArgDatabase &argsData, MirrorPlane &plane, MDagPath &frame);
+
     bool isNodeType(MObject &node, MFn::Type nodeType);
     bool isNodeType(MDagPath &path, MFn::Type nodeType);
 }
@@ -2,6 +2,7 @@
     Copyright (c) 2017 Ryan Porter
 */
 
+#include "parallel.h"
 #include "polyChecksumCommand.h"
 #include "polyDeformerWeights.h"
 #include "polyFlipCmd.h"
@@ -9,7 +10,13 @@
 #include "polySkinWeights.h"
 #include "polySymmetryTool.h"
 #include "polySymmetryCmd.h"
+#include "polySymmetryDeformer.h"
+#include "polySymmetryGPUDeformer.h"
 #include "polySymmetryNode.h"
+#include "polySymmetryProfileCmd.h"
+#include "polySymmetryTableData.h"
+#include "polySymmetryValidateCmd.h"
+#include "profiling.h"
 #include "sceneCache.h"
 
 #include <maya/MFnPlugin.h>
@@ -30,10 +37,22 @@ MString PolySkinWeightsCommand::COMMAND_NAME        = "polySkinWeights";
 
 MString PolySymmetryContextCmd::COMMAND_NAME        = "polySymmetryCtx";
 MString PolySymmetryCommand::COMMAND_NAME           = "polySymmetry";
+MString PolySymmetryProfileCommand::COMMAND_NAME    = "polySymmetryProfile";
+MString PolySymmetryValidateCommand::COMMAND_NAME   = "polySymmetryValidate";
 
 MString PolySymmetryNode::NODE_NAME                 = "polySymmetryData";
 MTypeId PolySymmetryNode::NODE_ID                   = 0x00126b0d;
 
+MString PolySymmetryTableData::DATA_NAME            = "polySymmetryTables";
+MTypeId PolySymmetryTableData::DATA_ID              = 0x00126b0e;
+
+MString PolySymmetryDeformer::NODE_NAME             = "polySymmetryDeformer";
+MTypeId PolySymmetryDeformer::NODE_ID               = 0x00126b0f;
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER
+MString PolySymmetryGPUDeformer::REGISTRANT_ID      = "polySymmetryDeformerOverride";
+#endif
+
 #define REGISTER_COMMAND(CMD) CHECK_MSTATUS_AND_RETURN_IT(fnPlugin.registerCommand(CMD::COMMAND_NAME, CMD::creator, CMD::getSyntax));
 #define DEREGISTER_COMMAND(CMD) CHECK_MSTATUS_AND_RETURN_IT(fnPlugin.deregisterCommand(CMD::COMMAND_NAME))
 
@@ -54,6 +73,14 @@ MStatus initializePlugin(MObject obj)
 
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = fnPlugin.registerData(
+        PolySymmetryTableData::DATA_NAME,
+        PolySymmetryTableData::DATA_ID,
+        PolySymmetryTableData::creator
+    );
+
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     status = fnPlugin.registerNode(
 	    PolySymmetryNode::NODE_NAME,
         PolySymmetryNode::NODE_ID,
@@ -64,15 +91,40 @@ MStatus initializePlugin(MObject obj)
 
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = fnPlugin.registerNode(
+        PolySymmetryDeformer::NODE_NAME,
+        PolySymmetryDeformer::NODE_ID,
+        PolySymmetryDeformer::creator,
+        PolySymmetryDeformer::initialize,
+        MPxNode::kDeformerNode
+    );
+
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER
+    status = MGPUDeformerRegistry::registerGPUDeformerCreator(
+        PolySymmetryDeformer::NODE_NAME,
+        PolySymmetryGPUDeformer::REGISTRANT_ID,
+        PolySymmetryGPUDeformer::getGPUDeformerInfo()
+    );
+
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+#endif
+
     REGISTER_COMMAND(PolyChecksumCommand);
     REGISTER_COMMAND(PolyDeformerWeightsCommand);
     REGISTER_COMMAND(PolyFlipCommand);
     REGISTER_COMMAND(PolyMirrorCommand);
     REGISTER_COMMAND(PolySkinWeightsCommand);
+    REGISTER_COMMAND(PolySymmetryProfileCommand);
+    REGISTER_COMMAND(PolySymmetryValidateCommand);
 
     status = PolySymmetryCache::initialize();
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = PolySymmetryProfiler::initialize();
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     if (MGlobal::mayaState() == MGlobal::kInteractive)
     {
         status = MGlobal::executePythonCommand("import polySymmetry");
@@ -98,6 +150,11 @@ MStatus uninitializePlugin(MObject obj)
     status = PolySymmetryCache::uninitialize();
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = PolySymmetryProfiler::uninitialize();
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    releaseThreadPool();
+
     status = fnPlugin.deregisterContextCommand(
         PolySymmetryContextCmd::COMMAND_NAME, 
         PolySymmetryCommand::COMMAND_NAME
@@ -110,10 +167,27 @@ MStatus uninitializePlugin(MObject obj)
     DEREGISTER_COMMAND(PolyFlipCommand);
     DEREGISTER_COMMAND(PolyMirrorCommand);
     DEREGISTER_COMMAND(PolySkinWeightsCommand);
+    DEREGISTER_COMMAND(PolySymmetryProfileCommand);
+    DEREGISTER_COMMAND(PolySymmetryValidateCommand);
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER
+    status = MGPUDeformerRegistry::deregisterGPUDeformerCreator(
+        PolySymmetryDeformer::NODE_NAME,
+        PolySymmetryGPUDeformer::REGISTRANT_ID
+    );
+
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+#endif
+
+    status = fnPlugin.deregisterNode(PolySymmetryDeformer::NODE_ID);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
     status = fnPlugin.deregisterNode(PolySymmetryNode::NODE_ID);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = fnPlugin.deregisterData(PolySymmetryTableData::DATA_ID);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     if (MGlobal::mayaState() == MGlobal::kInteractive && menuCreated)
     {
         status = MGlobal::executePythonCommand("import polySymmetry");
@@ -0,0 +1,310 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "cpu.h"
+#include "parallel.h"
+#include "pointKernels.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define POINT_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define POINT_KERNELS_TARGET(name) __attribute__((target(name)))
+#else
+#define POINT_KERNELS_TARGET(name)
+#endif
+
+// Points per task; each point is a handful of loads and stores.
+#define POINT_GRAIN_SIZE 8192
+
+MirrorPlane::MirrorPlane(int axis) : offset(0.0f), axis(axis)
+{
+    for (int c = 0; c < 3; c++) { normal[c] = c == axis ? 1.0f : 0.0f; }
+}
+
+/*
+    The normal does not have to be unit length. Planes that turn out to be 
+    normal to an axis and through the origin take the fast path. The normal 
+    keeps its sign, which the reflection does not depend on but `distance`
+    does.
+*/
+MirrorPlane::MirrorPlane(const float normal[3], float offset) : axis(-1)
+{
+    float length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+    for (int c = 0; c < 3; c++) { this->normal[c] = normal[c] / length; }
+
+    this->offset = offset / length;
+
+    for (int c = 0; c < 3; c++)
+    {
+        if (this->offset == 0.0f && fabs(this->normal[c]) == 1.0f) { this->axis = c; }
+    }
+
+    if (this->axis != -1)
+    {
+        float sign = this->normal[this->axis] < 0.0f ? -1.0f : 1.0f;
+
+        for (int c = 0; c < 3; c++) { this->normal[c] = c == this->axis ? sign : 0.0f; }
+    }
+}
+
+float MirrorPlane::distance(const float* point) const
+{
+    return normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2] - offset;
+}
+
+void MirrorPlane::reflectPoint(float* point) const
+{
+    float d = 2.0f * this->distance(point);
+
+    for (int c = 0; c < 3; c++) { point[c] -= d * normal[c]; }
+}
+
+void MirrorPlane::reflectVector(float* vector) const
+{
+    float d = 2.0f * (normal[0] * vector[0] + normal[1] * vector[1] + normal[2] * vector[2]);
+
+    for (int c = 0; c < 3; c++) { vector[c] -= d * normal[c]; }
+}
+
+/*
+    Every kernel is an instance of
+
+        result[i] = add[i] - sub[i] + reflect(points[o] - subOpposite[o])
+
+    where `o = symmetry[i]` and any of `add`, `sub`, and `subOpposite` may
+    be left out. The template flags let the compiler drop the unused terms,
+    and ON_AXIS the dot product with the normal. The reflected term is a
+    difference of points when `subOpposite` is given, so the offset of the
+    plane only applies without it.
+*/
+struct PointKernelArgs
+{
+    PointBuffer     points;
+    PointBuffer     add;
+    PointBuffer     sub;
+    PointBuffer     subOpposite;
+
+    const int*      symmetry;
+    MirrorPlane     plane;
+    float*          result;
+};
+
+template <bool ADD, bool SUB, bool SUB_OPPOSITE, bool ON_AXIS>
+static void remapPointsScalar(const PointKernelArgs &args, int first, int last)
+{
+    const MirrorPlane &plane = args.plane;
+
+    for (int i = first; i < last; i++)
+    {
+        int o = args.symmetry[i];
+
+        const float* p = args.points.data + (size_t) o * args.points.stride;
+        float* r = args.result + (size_t) i * 4;
+
+        float v[3] = { p[0], p[1], p[2] };
+
+        for (int c = 0; c < 3 && SUB_OPPOSITE; c++)
+        {
+            v[c] -= args.subOpposite.data[(size_t) o * args.subOpposite.stride + c];
+        }
+
+        if (ON_AXIS)
+        {
+            v[plane.axis] = -v[plane.axis];
+        } else if (SUB_OPPOSITE) {
+            plane.reflectVector(v);
+        } else {
+            plane.reflectPoint(v);
+        }
+
+        for (int c = 0; c < 3; c++)
+        {
+            if (ADD) { v[c] += args.add.data[(size_t) i * args.add.stride + c]; }
+            if (SUB) { v[c] -= args.sub.data[(size_t) i * args.sub.stride + c]; }
+
+            r[c] = v[c];
+        }
+
+        r[3] = 1.0f;
+    }
+}
+
+#ifdef POINT_KERNELS_AVX2
+
+/*
+    Eight points per step. Inputs are gathered one coordinate at a time,
+    which handles any stride, and the x/y/z/w registers are transposed back
+    into points for the stores.
+*/
+template <bool ADD, bool SUB, bool SUB_OPPOSITE, bool ON_AXIS>
+POINT_KERNELS_TARGET("avx2")
+static int remapPointsAVX2(const PointKernelArgs &args, int first, int last)
+{
+    const MirrorPlane &plane = args.plane;
+
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    const __m256 normal[3] = {
+        _mm256_set1_ps(plane.normal[0]),
+        _mm256_set1_ps(plane.normal[1]),
+        _mm256_set1_ps(plane.normal[2])
+    };
+
+    const __m256 planeOffset = _mm256_set1_ps(SUB_OPPOSITE ? 0.0f : plane.offset);
+
+    int i = first;
+
+    for (; i + 8 <= last; i += 8)
+    {
+        __m256i opposite = _mm256_loadu_si256((const __m256i*) (args.symmetry + i));
+        __m256i self = _mm256_add_epi32(_mm256_set1_epi32(i), lanes);
+
+        __m256i pointIndex = _mm256_mullo_epi32(opposite, _mm256_set1_epi32(args.points.stride));
+        __m256i addIndex = _mm256_mullo_epi32(self, _mm256_set1_epi32(ADD ? args.add.stride : 0));
+        __m256i subIndex = _mm256_mullo_epi32(self, _mm256_set1_epi32(SUB ? args.sub.stride : 0));
+        __m256i subOppositeIndex = _mm256_mullo_epi32(opposite, _mm256_set1_epi32(SUB_OPPOSITE ? args.subOpposite.stride : 0));
+
+        __m256 coordinates[3];
+
+        for (int c = 0; c < 3; c++)
+        {
+            __m256i offset = _mm256_set1_epi32(c);
+            __m256 v = _mm256_i32gather_ps(args.points.data, _mm256_add_epi32(pointIndex, offset), 4);
+
+            if (SUB_OPPOSITE)
+            {
+                v = _mm256_sub_ps(v, _mm256_i32gather_ps(args.subOpposite.data, _mm256_add_epi32(subOppositeIndex, offset), 4));
+            }
+
+            coordinates[c] = v;
+        }
+
+        if (ON_AXIS)
+        {
+            coordinates[plane.axis] = _mm256_xor_ps(coordinates[plane.axis], signBit);
+        } else {
+            __m256 d = _mm256_mul_ps(coordinates[0], normal[0]);
+            d = _mm256_add_ps(d, _mm256_mul_ps(coordinates[1], normal[1]));
+            d = _mm256_add_ps(d, _mm256_mul_ps(coordinates[2], normal[2]));
+            d = _mm256_sub_ps(d, planeOffset);
+            d = _mm256_add_ps(d, d);
+
+            for (int c = 0; c < 3; c++)
+            {
+                coordinates[c] = _mm256_sub_ps(coordinates[c], _mm256_mul_ps(d, normal[c]));
+            }
+        }
+
+        for (int c = 0; c < 3; c++)
+        {
+            __m256i offset = _mm256_set1_epi32(c);
+            __m256 v = coordinates[c];
+
+            if (ADD) { v = _mm256_add_ps(v, _mm256_i32gather_ps(args.add.data, _mm256_add_epi32(addIndex, offset), 4)); }
+            if (SUB) { v = _mm256_sub_ps(v, _mm256_i32gather_ps(args.sub.data, _mm256_add_epi32(subIndex, offset), 4)); }
+
+            coordinates[c] = v;
+        }
+
+        __m256 xy0 = _mm256_unpacklo_ps(coordinates[0], coordinates[1]);
+        __m256 xy1 = _mm256_unpackhi_ps(coordinates[0], coordinates[1]);
+        __m256 zw0 = _mm256_unpacklo_ps(coordinates[2], one);
+        __m256 zw1 = _mm256_unpackhi_ps(coordinates[2], one);
+
+        __m256 p04 = _mm256_shuffle_ps(xy0, zw0, 0x44);
+        __m256 p15 = _mm256_shuffle_ps(xy0, zw0, 0xEE);
+        __m256 p26 = _mm256_shuffle_ps(xy1, zw1, 0x44);
+        __m256 p37 = _mm256_shuffle_ps(xy1, zw1, 0xEE);
+
+        float* r = args.result + (size_t) i * 4;
+
+        _mm256_storeu_ps(r,      _mm256_permute2f128_ps(p04, p15, 0x20));
+        _mm256_storeu_ps(r + 8,  _mm256_permute2f128_ps(p26, p37, 0x20));
+        _mm256_storeu_ps(r + 16, _mm256_permute2f128_ps(p04, p15, 0x31));
+        _mm256_storeu_ps(r + 24, _mm256_permute2f128_ps(p26, p37, 0x31));
+    }
+
+    return i;
+}
+
+#endif
+
+template <bool ADD, bool SUB, bool SUB_OPPOSITE, bool ON_AXIS>
+static void remapPoints(const PointKernelArgs &args, int numberOfPoints)
+{
+#ifdef POINT_KERNELS_AVX2
+    bool useAVX2 = cpuHasAVX2();
+#else
+    bool useAVX2 = false;
+#endif
+
+    parallelForRange(numberOfPoints, POINT_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+#ifdef POINT_KERNELS_AVX2
+        if (useAVX2) { first = remapPointsAVX2<ADD, SUB, SUB_OPPOSITE, ON_AXIS>(args, first, last); }
+#endif
+        remapPointsScalar<ADD, SUB, SUB_OPPOSITE, ON_AXIS>(args, first, last);
+    });
+}
+
+template <bool ADD, bool SUB, bool SUB_OPPOSITE>
+static void remapPoints(const PointKernelArgs &args, int numberOfPoints)
+{
+    if (args.plane.axis != -1)
+    {
+        remapPoints<ADD, SUB, SUB_OPPOSITE, true>(args, numberOfPoints);
+    } else {
+        remapPoints<ADD, SUB, SUB_OPPOSITE, false>(args, numberOfPoints);
+    }
+}
+
+void flipPoints(
+    PointBuffer points,
+    const int* symmetry,
+    int numberOfPoints,
+    const MirrorPlane &plane,
+    float* result
+) {
+    PointBuffer none(nullptr, 0);
+    PointKernelArgs args = { points, none, none, none, symmetry, plane, result };
+
+    remapPoints<false, false, false>(args, numberOfPoints);
+}
+
+void mirrorPoints(
+    PointBuffer points,
+    PointBuffer base,
+    const int* symmetry,
+    int numberOfPoints,
+    const MirrorPlane &plane,
+    float* result
+) {
+    PointBuffer none(nullptr, 0);
+    PointKernelArgs args = { points, points, base, none, symmetry, plane, result };
+
+    remapPoints<true, true, false>(args, numberOfPoints);
+}
+
+void flipPointsAgainst(
+    PointBuffer points,
+    PointBuffer reference,
+    const int* symmetry,
+    int numberOfPoints,
+    const MirrorPlane &plane,
+    float* result
+) {
+    PointBuffer none(nullptr, 0);
+    PointKernelArgs args = { points, reference, none, reference, symmetry, plane, result };
+
+    remapPoints<true, false, true>(args, numberOfPoints);
+}
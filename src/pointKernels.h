@@ -0,0 +1,82 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POINT_KERNELS_H
+#define POINT_KERNELS_H
+
+/*
+    Point math for polyFlip and polyMirror. The kernels have no Maya
+    dependencies and work on packed float buffers so that input can come
+    straight from `MFnMesh::getRawPoints` (3 floats per point) or an
+    `MFloatPointArray` (4 floats per point). Results are always written
+    4 floats per point with w = 1, which is the layout of `MFloatPointArray`,
+    so they can be passed to `MFnMesh::setPoints` without another copy.
+
+    Points are reflected across a MirrorPlane. Each kernel splits its points
+    across threads and uses AVX2 when the CPU has it.
+*/
+
+struct PointBuffer
+{
+    const float*    data;
+    int             stride;
+
+    PointBuffer(const float* data, int stride) : data(data), stride(stride) {}
+};
+
+/*
+    Plane that points are reflected across, as the unit `normal` and the
+    `offset` of the plane from the origin along it. A plane through the 
+    origin normal to an axis keeps that `axis`, and is applied by negating
+    a coordinate; any other plane has an axis of -1.
+*/
+struct MirrorPlane
+{
+    float           normal[3];
+    float           offset;
+    int             axis;
+
+                    MirrorPlane(int axis = 0);
+                    MirrorPlane(const float normal[3], float offset);
+
+    /* Signed distance of `point` from the plane, positive on the side the normal points to. */
+    float           distance(const float* point) const;
+
+    void            reflectPoint(float* point) const;
+
+    /* Reflects the difference of two points, which the offset does not apply to. */
+    void            reflectVector(float* vector) const;
+};
+
+/* result[i] = reflect(points[symmetry[i]]) */
+void        flipPoints(
+                PointBuffer points,
+                const int* symmetry,
+                int numberOfPoints,
+                const MirrorPlane &plane,
+                float* result
+            );
+
+/* result[i] = points[i] + reflect(points[symmetry[i]]) - base[i] */
+void        mirrorPoints(
+                PointBuffer points,
+                PointBuffer base,
+                const int* symmetry,
+                int numberOfPoints,
+                const MirrorPlane &plane,
+                float* result
+            );
+
+/* result[i] = reference[i] + reflect(points[symmetry[i]] - reference[symmetry[i]]) */
+void        flipPointsAgainst(
+                PointBuffer points,
+                PointBuffer reference,
+                const int* symmetry,
+                int numberOfPoints,
+                const MirrorPlane &plane,
+                float* result
+            );
+
+#endif
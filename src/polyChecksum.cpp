@@ -3,43 +3,233 @@
     You may use, distribute, or modify this code under the terms of the MIT license.
 */
 
+#include "cpu.h"
 #include "polyChecksum.h"
 
-PolyChecksum::PolyChecksum()
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define POLY_CHECKSUM_SSE42
+#include <nmmintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define POLY_CHECKSUM_ARM_CRC32
+#include <arm_acle.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define POLY_CHECKSUM_TARGET(name) __attribute__((target(name)))
+#else
+#define POLY_CHECKSUM_TARGET(name)
+#endif
+
+/*
+    table[k][b] is the checksum of byte `b` followed by `k` zero bytes, 
+    which lets eight table lookups replace eight dependent byte steps.
+*/
+struct ChecksumTables
 {
-	// for all possible byte values
-	for (unsigned i = 0; i < 256; ++i)
-	{
-		unsigned long reg = i << 24;
-		// for all bits in a byte
-		for (int j = 0; j < 8; ++j)
-		{
-			bool topBit = (reg & 0x80000000) != 0;
-			reg <<= 1;
+    uint32_t legacy[8][256];
+    uint32_t crc32c[8][256];
+
+    ChecksumTables()
+    {
+        const uint32_t legacyKey = 0x04c11db7;
+        const uint32_t crc32cKey = 0x82f63b78;
+
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t reg = i << 24;
+
+            for (int j = 0; j < 8; j++)
+            {
+                reg = (reg & 0x80000000) ? (reg << 1) ^ legacyKey : (reg << 1);
+            }
+
+            legacy[0][i] = reg;
+
+            reg = i;
+
+            for (int j = 0; j < 8; j++)
+            {
+                reg = (reg & 1) ? (reg >> 1) ^ crc32cKey : (reg >> 1);
+            }
+
+            crc32c[0][i] = reg;
+        }
+
+        for (int k = 1; k < 8; k++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                legacy[k][i] = (legacy[k - 1][i] << 8) ^ legacy[0][legacy[k - 1][i] >> 24];
+                crc32c[k][i] = (crc32c[k - 1][i] >> 8) ^ crc32c[0][crc32c[k - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+static const ChecksumTables& getTables()
+{
+    static const ChecksumTables tables;
+    return tables;
+}
+
+static uint32_t loadLittleEndian(const unsigned char* ptr)
+{
+    return (uint32_t) ptr[0] | ((uint32_t) ptr[1] << 8) | ((uint32_t) ptr[2] << 16) | ((uint32_t) ptr[3] << 24);
+}
+
+static uint32_t loadBigEndian(const unsigned char* ptr)
+{
+    return ((uint32_t) ptr[0] << 24) | ((uint32_t) ptr[1] << 16) | ((uint32_t) ptr[2] << 8) | (uint32_t) ptr[3];
+}
+
+static uint32_t legacySoftware(uint32_t reg, const unsigned char* ptr, size_t dataSize)
+{
+    const uint32_t (*table)[256] = getTables().legacy;
+
+    while (dataSize >= 8)
+    {
+        uint32_t hi = reg ^ loadBigEndian(ptr);
+        uint32_t lo = loadBigEndian(ptr + 4);
+
+        reg = table[7][hi >> 24]         ^ table[6][(hi >> 16) & 0xff] 
+            ^ table[5][(hi >> 8) & 0xff] ^ table[4][hi & 0xff] 
+            ^ table[3][lo >> 24]         ^ table[2][(lo >> 16) & 0xff] 
+            ^ table[1][(lo >> 8) & 0xff] ^ table[0][lo & 0xff];
+
+        ptr += 8;
+        dataSize -= 8;
+    }
+
+    for (size_t i = 0; i < dataSize; i++)
+    {
+        reg = (reg << 8) ^ table[0][(reg >> 24) ^ ptr[i]];
+    }
+
+    return reg;
+}
+
+static uint32_t crc32cSoftware(uint32_t reg, const unsigned char* ptr, size_t dataSize)
+{
+    const uint32_t (*table)[256] = getTables().crc32c;
+
+    while (dataSize >= 8)
+    {
+        uint32_t lo = reg ^ loadLittleEndian(ptr);
+        uint32_t hi = loadLittleEndian(ptr + 4);
 
-			if (topBit)
-				reg ^= _key;
-		}
-		_table [i] = reg;
-	}
+        reg = table[7][lo & 0xff]         ^ table[6][(lo >> 8) & 0xff] 
+            ^ table[5][(lo >> 16) & 0xff] ^ table[4][lo >> 24] 
+            ^ table[3][hi & 0xff]         ^ table[2][(hi >> 8) & 0xff] 
+            ^ table[1][(hi >> 16) & 0xff] ^ table[0][hi >> 24];
+
+        ptr += 8;
+        dataSize -= 8;
+    }
+
+    for (size_t i = 0; i < dataSize; i++)
+    {
+        reg = (reg >> 8) ^ table[0][(reg ^ ptr[i]) & 0xff];
+    }
+
+    return reg;
 }
 
-void PolyChecksum::putBytes(void* bytes, size_t dataSize)
+#if defined(POLY_CHECKSUM_SSE42)
+POLY_CHECKSUM_TARGET("sse4.2")
+static uint32_t crc32cHardware(uint32_t reg, const unsigned char* ptr, size_t dataSize)
 {
-    unsigned char* ptr = (unsigned char*) bytes;
+    uint64_t reg64 = reg;
+
+    while (dataSize >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, ptr, sizeof(word));
+
+        reg64 = _mm_crc32_u64(reg64, word);
+
+        ptr += 8;
+        dataSize -= 8;
+    }
+
+    reg = (uint32_t) reg64;
 
     for (size_t i = 0; i < dataSize; i++)
     {
-        unsigned byte = *(ptr + i);
-        unsigned top = _register >> 24;
-        top ^= byte;
-        top &= 255;
+        reg = _mm_crc32_u8(reg, ptr[i]);
+    }
+
+    return reg;
+}
+#elif defined(POLY_CHECKSUM_ARM_CRC32)
+static uint32_t crc32cHardware(uint32_t reg, const unsigned char* ptr, size_t dataSize)
+{
+    while (dataSize >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, ptr, sizeof(word));
+
+        reg = __crc32cd(reg, word);
 
-        _register = (_register << 8) ^ _table [top];
+        ptr += 8;
+        dataSize -= 8;
     }
+
+    for (size_t i = 0; i < dataSize; i++)
+    {
+        reg = __crc32cb(reg, ptr[i]);
+    }
+
+    return reg;
+}
+#endif
+
+PolyChecksum::PolyChecksum(Mode mode) : 
+    _mode(mode),
+    _register(mode == kCRC32C ? 0xffffffff : 0)
+{
+}
+
+bool PolyChecksum::hasHardwareCRC32C()
+{
+#if defined(POLY_CHECKSUM_SSE42)
+    return cpuHasSSE42();
+#elif defined(POLY_CHECKSUM_ARM_CRC32)
+    return cpuHasARMCRC32();
+#else
+    return false;
+#endif
+}
+
+void PolyChecksum::putBytes(const void* bytes, size_t dataSize)
+{
+    const unsigned char* ptr = (const unsigned char*) bytes;
+
+    if (_mode == kLegacy)
+    {
+        _register = legacySoftware(_register, ptr, dataSize);
+        return;
+    }
+
+#if defined(POLY_CHECKSUM_SSE42) || defined(POLY_CHECKSUM_ARM_CRC32)
+    static const bool useHardware = PolyChecksum::hasHardwareCRC32C();
+
+    if (useHardware)
+    {
+        _register = crc32cHardware(_register, ptr, dataSize);
+        return;
+    }
+#endif
+
+    _register = crc32cSoftware(_register, ptr, dataSize);
 }
 
-int PolyChecksum::getResult()
+int PolyChecksum::getResult() const
 {
-    return (int) this->_register;
+    return (int) (_mode == kCRC32C ? ~_register : _register);
 }
@@ -7,20 +7,42 @@
 #define POLY_CHECKSUM_H
 
 #include <cstddef>
+#include <cstdint>
 
 // based on code found at http://www.relisoft.com/science/CrcOptim.html
 
+/*
+    Running checksum over a stream of bytes. 
+
+    kLegacy is the MSB-first CRC-32 (polynomial 0x04c11db7, no initial or 
+    final xor) that has always been used for the vertexChecksum stored on 
+    polySymmetryData nodes, so it must not change. It is computed eight 
+    bytes at a time with the slicing-by-8 tables.
+
+    kCRC32C is the Castagnoli CRC, which SSE4.2 and ARMv8 compute in 
+    hardware. The tables are used when neither is available, so the result 
+    does not depend on the machine.
+*/
 class PolyChecksum
 {
 public:
-                        PolyChecksum();
-    virtual void        putBytes(void* bytes, size_t dataSize);
-    virtual int         getResult();
+    enum Mode
+    {
+        kLegacy,
+        kCRC32C
+    };
 
 public:
-	unsigned long       _table[256];
-	unsigned long       _register = 0;
-	unsigned long       _key = 0x04c11db7;
+                        PolyChecksum(Mode mode = kLegacy);
+
+    void                putBytes(const void* bytes, size_t dataSize);
+    int                 getResult() const;
+
+    static bool         hasHardwareCRC32C();
+
+private:
+    Mode                _mode;
+    uint32_t            _register;
 };
 
 #endif
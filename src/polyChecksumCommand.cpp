@@ -5,6 +5,7 @@
 
 #include "meshData.h"
 #include "polyChecksumCommand.h"
+#include "profiling.h"
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
@@ -21,6 +22,9 @@
 
 using namespace std;
 
+#define FAST_FLAG       "-f"
+#define FAST_LONG_FLAG  "-fast"
+
 PolyChecksumCommand::PolyChecksumCommand()  {}
 PolyChecksumCommand::~PolyChecksumCommand() {}
 
@@ -36,6 +40,8 @@ MSyntax PolyChecksumCommand::getSyntax()
     syntax.setObjectType(MSyntax::kSelectionList, 1, 1);
     syntax.useSelectionAsDefault(true);
 
+    syntax.addFlag(FAST_FLAG, FAST_LONG_FLAG);
+
     syntax.enableQuery(false);
     syntax.enableEdit(false);
 
@@ -45,6 +51,9 @@ MSyntax PolyChecksumCommand::getSyntax()
 MStatus PolyChecksumCommand::doIt(const MArgList& argList)
 {
     MStatus status;
+
+    ProfileScope profileScope("polyChecksum");
+
     MArgDatabase argsData(syntax(), argList);
 
     MSelectionList selection;
@@ -58,12 +67,17 @@ MStatus PolyChecksumCommand::doIt(const MArgList& argList)
         return MStatus::kFailure;
     }
 
+    this->fast = argsData.isFlagSet(FAST_FLAG);
+
     return this->redoIt();
 }
 
 MStatus PolyChecksumCommand::redoIt()
 {
-    unsigned long checksum = MeshData::getVertexChecksum(this->mesh);
+    unsigned long checksum = this->fast
+        ? MeshData::getFastChecksum(this->mesh)
+        : MeshData::getVertexChecksum(this->mesh);
+
 	this->setResult((int) checksum);
 
     return MStatus::kSuccess;
@@ -34,6 +34,7 @@ public:
 
 private:    
     MDagPath            mesh;
+    bool                fast = false;
 };
 
 #endif
\ No newline at end of file
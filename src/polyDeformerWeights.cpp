@@ -4,21 +4,32 @@
 */
 
 #include <stdio.h>
+#include <algorithm>
+#include <memory>
 #include <vector>
 
+#include "meshCorrespondence.h"
+#include "meshData.h"
+#include "meshPoints.h"
+#include "parallel.h"
 #include "parseArgs.h"
+#include "pointKernels.h"
 #include "polyDeformerWeights.h"
 #include "polySymmetryNode.h"
+#include "profiling.h"
 #include "sceneCache.h"
 #include "selection.h"
+#include "weightRemap.h"
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MFnMesh.h>
 #include <maya/MFnWeightGeometryFilter.h>
 #include <maya/MFloatArray.h>
 #include <maya/MGlobal.h>
+#include <maya/MItDependencyGraph.h>
 #include <maya/MItGeometry.h>
 #include <maya/MObject.h>
 #include <maya/MObjectArray.h>
@@ -30,19 +41,19 @@
 
 using namespace std;
  
-// Indicates the source deformer.
+// Indicates the source deformer. May be used more than once.
 #define SOURCE_DEFORMER_FLAG            "-sd"
 #define SOURCE_DEFORMER_LONG_FLAG       "-sourceDeformer"
 
-// Indicates the source deformed mesh.
+// Indicates the source deformed mesh. May be used more than once.
 #define SOURCE_MESH_FLAG               "-sm"
 #define SOURCE_MESH_LONG_FLAG          "-sourceMesh"
 
-// Indicates the destination deformer.
+// Indicates the destination deformer. May be used more than once.
 #define DESTINATION_DEFORMER_FLAG       "-dd"
 #define DESTINATION_DEFORMER_LONG_FLAG  "-destinationDeformer"
 
-// Indicates the destination deformed shape.
+// Indicates the destination deformed shape. May be used more than once.
 #define DESTINATION_MESH_FLAG          "-dm"
 #define DESTINATION_MESH_LONG_FLAG     "-destinationMesh"
 
@@ -58,6 +69,10 @@ using namespace std;
 #define FLIP_FLAG                       "-f"
 #define FLIP_LONG_FLAG                  "-flip"
 
+// Indicates that every deformer on the source mesh(es) should be flipped or mirrored in place.
+#define ALL_DEFORMERS_FLAG              "-ad"
+#define ALL_DEFORMERS_LONG_FLAG         "-allDeformers"
+
 #define RETURN_IF_ERROR(s) if (!s) { return s; }
 
 PolyDeformerWeightsCommand::PolyDeformerWeightsCommand() {}
@@ -82,6 +97,14 @@ MSyntax PolyDeformerWeightsCommand::getSyntax()
 
     syntax.addFlag(MIRROR_FLAG, MIRROR_LONG_FLAG);
     syntax.addFlag(FLIP_FLAG, FLIP_LONG_FLAG);
+    syntax.addFlag(ALL_DEFORMERS_FLAG, ALL_DEFORMERS_LONG_FLAG);
+
+    parseArgs::addMirrorPlaneFlags(syntax);
+
+    syntax.makeFlagMultiUse(SOURCE_DEFORMER_FLAG);
+    syntax.makeFlagMultiUse(SOURCE_MESH_FLAG);
+    syntax.makeFlagMultiUse(DESTINATION_DEFORMER_FLAG);
+    syntax.makeFlagMultiUse(DESTINATION_MESH_FLAG);
 
     syntax.enableEdit(false);
     syntax.enableQuery(false);
@@ -93,16 +116,18 @@ MStatus PolyDeformerWeightsCommand::parseArguments(MArgDatabase &argsData)
 {
     MStatus status;
 
-    status = parseArgs::getNodeArgument(argsData, SOURCE_DEFORMER_FLAG, this->sourceDeformer, true);
+    this->allDeformers = argsData.isFlagSet(ALL_DEFORMERS_FLAG);
+
+    status = parseArgs::getNodeArguments(argsData, SOURCE_DEFORMER_FLAG, this->sourceDeformers, !this->allDeformers);
     RETURN_IF_ERROR(status);
 
-    status = parseArgs::getNodeArgument(argsData, DESTINATION_DEFORMER_FLAG, this->destinationDeformer, false);
+    status = parseArgs::getNodeArguments(argsData, DESTINATION_DEFORMER_FLAG, this->destinationDeformers, false);
     RETURN_IF_ERROR(status);
 
-    status = parseArgs::getDagPathArgument(argsData, SOURCE_MESH_FLAG, this->sourceMesh, true);
+    status = parseArgs::getDagPathArguments(argsData, SOURCE_MESH_FLAG, this->sourceMeshes, true);
     RETURN_IF_ERROR(status);
 
-    status = parseArgs::getDagPathArgument(argsData, DESTINATION_MESH_FLAG, this->destinationMesh, false);
+    status = parseArgs::getDagPathArguments(argsData, DESTINATION_MESH_FLAG, this->destinationMeshes, false);
     RETURN_IF_ERROR(status);
 
     this->mirrorWeights = argsData.isFlagSet(MIRROR_FLAG);
@@ -110,9 +135,48 @@ MStatus PolyDeformerWeightsCommand::parseArguments(MArgDatabase &argsData)
 
     status = argsData.getFlagArgument(DIRECTION_FLAG, 0, this->direction);
 
+    status = parseArgs::getMirrorPlaneArguments(argsData, this->mirrorPlane, this->mirrorFrame);
+    RETURN_IF_ERROR(status);
+
     return MStatus::kSuccess;
 }
 
+/* 
+    Returns every weight geometry filter in the history of `mesh` that deforms it. 
+*/
+static void getMeshDeformers(MDagPath &mesh, MObjectArray &deformers)
+{
+    MStatus status;
+    MObject meshNode = mesh.node();
+
+    MItDependencyGraph itGraph(
+        meshNode, 
+        MFn::kWeightGeometryFilt, 
+        MItDependencyGraph::kUpstream, 
+        MItDependencyGraph::kDepthFirst, 
+        MItDependencyGraph::kNodeLevel, 
+        &status
+    );
+
+    while (!itGraph.isDone())
+    {
+        MObject deformer = itGraph.currentItem();
+        MFnWeightGeometryFilter fnDeformer(deformer);
+
+        fnDeformer.indexForOutputShape(meshNode, &status);
+
+        if (status) { deformers.append(deformer); }
+
+        itGraph.next();
+    }
+}
+
+/*
+    Pairs up the source and destination flags into targets. Each flag is used 
+    either once, in which case it applies to every target, or once per target. 
+    Destination flags that are not used default to the source of each target,
+    which flips or mirrors the source in place. 
+*/
 MStatus PolyDeformerWeightsCommand::validateArguments()
 {
     MStatus status;
@@ -126,7 +190,152 @@ MStatus PolyDeformerWeightsCommand::validateArguments()
         return MStatus::kFailure;
     }
 
-    if (!parseArgs::isNodeType(sourceDeformer, MFn::kWeightGeometryFilt))
+    if (this->allDeformers)
+    {
+        if (this->sourceDeformers.length() != 0 || this->destinationDeformers.length() != 0 || this->destinationMeshes.length() != 0)
+        {
+            MString errorMsg("The ^1s/^2s flag can only be combined with the ^3s/^4s flag.");
+            errorMsg.format(
+                errorMsg, 
+                MString(ALL_DEFORMERS_LONG_FLAG), 
+                MString(ALL_DEFORMERS_FLAG), 
+                MString(SOURCE_MESH_LONG_FLAG), 
+                MString(SOURCE_MESH_FLAG)
+            );
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        MDagPathArray meshes(this->sourceMeshes);
+        this->sourceMeshes.clear();
+
+        for (unsigned i = 0; i < meshes.length(); i++)
+        {
+            MDagPath mesh(meshes[i]);
+
+            if (!mesh.node().hasFn(MFn::kMesh)) { mesh.extendToShapeDirectlyBelow(0); }
+
+            MObjectArray deformers;
+            getMeshDeformers(mesh, deformers);
+
+            for (unsigned j = 0; j < deformers.length(); j++)
+            {
+                this->sourceDeformers.append(deformers[j]);
+                this->sourceMeshes.append(meshes[i]);
+            }
+        }
+
+        if (this->sourceDeformers.length() == 0)
+        {
+            MGlobal::displayWarning("No deformers found on the specified mesh(es).");
+            return MStatus::kSuccess;
+        }
+    }
+
+    unsigned numberOfTargets = max(
+        max(this->sourceDeformers.length(), this->sourceMeshes.length()),
+        max(this->destinationDeformers.length(), this->destinationMeshes.length())
+    );
+
+    struct { unsigned count; const char* flag; const char* longFlag; } flagUses[] = {
+        { this->sourceDeformers.length(), SOURCE_DEFORMER_FLAG, SOURCE_DEFORMER_LONG_FLAG },
+        { this->sourceMeshes.length(), SOURCE_MESH_FLAG, SOURCE_MESH_LONG_FLAG },
+        { this->destinationDeformers.length(), DESTINATION_DEFORMER_FLAG, DESTINATION_DEFORMER_LONG_FLAG },
+        { this->destinationMeshes.length(), DESTINATION_MESH_FLAG, DESTINATION_MESH_LONG_FLAG }
+    };
+
+    for (auto &uses : flagUses)
+    {
+        if (uses.count > 1 && uses.count != numberOfTargets)
+        {
+            MString errorMsg("The ^1s/^2s flag should be used once or ^3s times.");
+            errorMsg.format(errorMsg, MString(uses.longFlag), MString(uses.flag), MString() + (int) numberOfTargets);
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+    }
+
+    auto pick = [](unsigned count, unsigned i) { return count == 1 ? 0 : i; };
+
+    this->targets.clear();
+    this->targets.resize(numberOfTargets);
+
+    for (unsigned i = 0; i < numberOfTargets; i++)
+    {
+        DeformerWeightsTarget &target = this->targets[i];
+
+        target.sourceDeformer = this->sourceDeformers[pick(this->sourceDeformers.length(), i)];
+        target.sourceMesh = this->sourceMeshes[pick(this->sourceMeshes.length(), i)];
+
+        target.destinationDeformer = this->destinationDeformers.length() == 0 
+            ? target.sourceDeformer 
+            : this->destinationDeformers[pick(this->destinationDeformers.length(), i)];
+
+        target.destinationMesh = this->destinationMeshes.length() == 0 
+            ? target.sourceMesh 
+            : this->destinationMeshes[pick(this->destinationMeshes.length(), i)];
+
+        status = this->validateTarget(target);
+        RETURN_IF_ERROR(status);
+    }
+
+    if (mirrorWeights || flipWeights)
+    {
+        // Targets usually share a handful of meshes, so each mesh only goes through the cache once.
+        for (unsigned i = 0; i < numberOfTargets; i++)
+        {
+            DeformerWeightsTarget &target = this->targets[i];
+
+            if (target.correspondence != nullptr) { continue; }
+
+            for (unsigned j = 0; j < i; j++)
+            {
+                if (this->targets[j].sourceMesh == target.sourceMesh)
+                {
+                    target.symmetryTables = this->targets[j].symmetryTables;
+                    break;
+                }
+            }
+
+            if (target.symmetryTables != nullptr) { continue; }
+
+            if (!PolySymmetryCache::getSymmetryTables(target.sourceMesh, target.symmetryTables))
+            {
+                MString errorMsg("Mesh specified with the ^1s/^2s flag must have an associated ^3s node.");
+                errorMsg.format(errorMsg, MString(SOURCE_MESH_LONG_FLAG), MString(SOURCE_MESH_FLAG), PolySymmetryNode::NODE_NAME);
+
+                MGlobal::displayError(errorMsg);
+                return MStatus::kFailure;
+            }
+        }
+    }
+
+    return MStatus::kSuccess;
+}
+
+/*
+    Meshes with the same counts can still be connected differently, such as
+    a retopology with as many vertices, so their face vertices are compared
+    as well.
+*/
+static bool hasSameTopology(MDagPath &sourceMesh, MDagPath &destinationMesh)
+{
+    MFnMesh fnSourceMesh(sourceMesh);
+    MFnMesh fnDestinationMesh(destinationMesh);
+
+    if (!isPointCompatible(fnSourceMesh, fnDestinationMesh)) { return false; }
+    if (sourceMesh == destinationMesh) { return true; }
+
+    return MeshData::getFastChecksum(sourceMesh) == MeshData::getFastChecksum(destinationMesh);
+}
+
+MStatus PolyDeformerWeightsCommand::validateTarget(DeformerWeightsTarget &target)
+{
+    MStatus status;
+
+    if (!parseArgs::isNodeType(target.sourceDeformer, MFn::kWeightGeometryFilt))
     {
         MString errorMsg("A deformer node should be specified with the ^1s/^2s flag.");
         errorMsg.format(errorMsg, MString(SOURCE_DEFORMER_LONG_FLAG), MString(SOURCE_DEFORMER_FLAG));
@@ -135,10 +344,8 @@ MStatus PolyDeformerWeightsCommand::validateArguments()
         return MStatus::kFailure;
     }
 
-    if (destinationDeformer.isNull()) 
-    { 
-        destinationDeformer = sourceDeformer; 
-    } else if (!destinationDeformer.hasFn(MFn::kWeightGeometryFilt)) {
+    if (!target.destinationDeformer.hasFn(MFn::kWeightGeometryFilt)) 
+    {
         MString errorMsg("A deformer node should be specified with the ^1s/^2s flag.");
         errorMsg.format(errorMsg, MString(DESTINATION_DEFORMER_LONG_FLAG), MString(DESTINATION_DEFORMER_FLAG));
 
@@ -146,7 +353,7 @@ MStatus PolyDeformerWeightsCommand::validateArguments()
         return MStatus::kFailure;
     }
 
-    if (!parseArgs::isNodeType(this->sourceMesh, MFn::kMesh))
+    if (!parseArgs::isNodeType(target.sourceMesh, MFn::kMesh))
     {
         MString errorMsg("A mesh node should be specified with the ^1s/^2s flag.");
         errorMsg.format(errorMsg, MString(SOURCE_MESH_LONG_FLAG), MString(SOURCE_MESH_FLAG));
@@ -155,58 +362,77 @@ MStatus PolyDeformerWeightsCommand::validateArguments()
         return MStatus::kFailure;
     }
 
-    if (destinationMesh.node().isNull()) 
-    { 
-        destinationMesh.set(sourceMesh); 
-    } else if (!destinationMesh.hasFn(MFn::kMesh)) {
+    if (!target.destinationMesh.hasFn(MFn::kMesh)) 
+    {
         MString errorMsg("A mesh node should be specified with the ^1s/^2s flag.");
         errorMsg.format(errorMsg, MString(DESTINATION_MESH_LONG_FLAG), MString(DESTINATION_MESH_FLAG));
 
         MGlobal::displayError(errorMsg);
         return MStatus::kFailure;
-    } else {
-        MFnMesh fnSourceMesh(this->sourceMesh);
-        MFnMesh fnDestinationMesh(this->destinationMesh);
+    } 
     
-        if (fnSourceMesh.numVertices() != fnDestinationMesh.numVertices())
-        {
-            MString errorMsg("Source mesh and destination mesh are not point compatible. Cannot continue.");
-            MGlobal::displayError(errorMsg);
-            return MStatus::kFailure;
-        }
-    }
-
     MSelectionList activeSelection;
     MSelectionList vertexSelection;
 
     MGlobal::getActiveSelectionList(activeSelection);
 
-    if (destinationMesh.node().hasFn(MFn::kMesh)) { destinationMesh.pop(); }
-    getSelectedComponents(destinationMesh, activeSelection, vertexSelection, MFn::Type::kMeshVertComponent);
+    if (target.destinationMesh.node().hasFn(MFn::kMesh)) { target.destinationMesh.pop(); }
+    getSelectedComponents(target.destinationMesh, activeSelection, vertexSelection, MFn::Type::kMeshVertComponent);
 
     if (!vertexSelection.isEmpty())
     {
-        vertexSelection.getDagPath(0, destinationMesh, components);
+        vertexSelection.getDagPath(0, target.destinationMesh, target.components);
     }
 
-    if (!sourceMesh.node().hasFn(MFn::kMesh))
+    if (!target.sourceMesh.node().hasFn(MFn::kMesh))
     {
-        sourceMesh.extendToShapeDirectlyBelow(0);
+        target.sourceMesh.extendToShapeDirectlyBelow(0);
     }
 
-    if (!destinationMesh.node().hasFn(MFn::kMesh))
+    if (!target.destinationMesh.node().hasFn(MFn::kMesh))
     {
-        destinationMesh.extendToShapeDirectlyBelow(0);
+        target.destinationMesh.extendToShapeDirectlyBelow(0);
     }
 
-    if (mirrorWeights || flipWeights)
+    MFnMesh fnSourceMesh(target.sourceMesh);
+    MFnMesh fnDestinationMesh(target.destinationMesh);
+
+    // Meshes that do not share a topology, such as two LODs, go through their surfaces instead.
+    if (!hasSameTopology(target.sourceMesh, target.destinationMesh))
     {
-        bool cacheHit = PolySymmetryCache::getNodeFromCache(this->sourceMesh, this->polySymmetryData);
+        // Weights are mirrored in object space, so a frame is placed relative to each source mesh.
+        MirrorPlane plane = this->mirrorPlane;
+
+        if (this->mirrorFrame.isValid())
+        {
+            status = getFramePlane(this->mirrorFrame, this->mirrorPlane.axis, target.sourceMesh, MSpace::kObject, plane);
+
+            if (!status)
+            {
+                MString errorMsg("^1s does not span a plane to mirror across.");
+                errorMsg.format(errorMsg, this->mirrorFrame.partialPathName());
+
+                MGlobal::displayError(errorMsg);
+                return MStatus::kFailure;
+            }
+        }
 
-        if (!cacheHit)
+        status = getMeshCorrespondence(
+            fnSourceMesh, 
+            PointBuffer(fnSourceMesh.getRawPoints(&status), 3), 
+            PointBuffer(fnDestinationMesh.getRawPoints(&status), 3), 
+            fnDestinationMesh.numVertices(), 
+            this->flipWeights, 
+            this->mirrorWeights, 
+            this->direction, 
+            plane, 
+            target.correspondence
+        );
+
+        if (!status) 
         {
-            MString errorMsg("Mesh specified with the ^1s/^2s flag must have an associated ^3s node.");
-            errorMsg.format(errorMsg, MString(SOURCE_MESH_LONG_FLAG), MString(SOURCE_MESH_FLAG), PolySymmetryNode::NODE_NAME);
+            MString errorMsg("Source mesh ^1s has no faces.");
+            errorMsg.format(errorMsg, target.sourceMesh.partialPathName());
 
             MGlobal::displayError(errorMsg);
             return MStatus::kFailure;
@@ -220,6 +446,8 @@ MStatus PolyDeformerWeightsCommand::doIt(const MArgList& argList)
 {
     MStatus status;
 
+    ProfileScope profileScope("polyDeformerWeights");
+
     MArgDatabase argsData(syntax(), argList, &status);
     RETURN_IF_ERROR(status);
 
@@ -232,112 +460,183 @@ MStatus PolyDeformerWeightsCommand::doIt(const MArgList& argList)
     return this->redoIt();
 }
 
+/*
+    Every source is read before any destination is written, so targets that 
+    share deformers all see the weights from before the command ran. The 
+    deformer API is only used from the main thread; the remap itself runs 
+    on all targets in parallel. Targets whose meshes do not share a topology
+    interpolate the source weights at the location of each destination 
+    vertex on the source instead.
+*/
 MStatus PolyDeformerWeightsCommand::redoIt()
 {
     MStatus status;
 
-    MFnWeightGeometryFilter fnSourceDeformer(this->sourceDeformer, &status);
-    MFnWeightGeometryFilter fnDestinationDeformer(this->destinationDeformer, &status);
+    size_t numberOfTargets = this->targets.size();
 
-    MObjectArray sourceOutputGeometry;
-    MObjectArray destinationOutputGeometry;
+    vector<MFloatArray> sourceWeights(numberOfTargets);
+    vector<MFloatArray> destinationWeights(numberOfTargets);
+    vector<vector<int>> targetVertices(numberOfTargets);
+    vector<shared_ptr<const SymmetryTables>> targetTables(numberOfTargets);
 
-    int numberOfVertices = MFnMesh(this->sourceMesh).numVertices();
+    for (size_t t = 0; t < numberOfTargets; t++)
+    {
+        DeformerWeightsTarget &target = this->targets[t];
 
-    MObject sourceComponents;
-    MObject destinationComponents;
+        MFnWeightGeometryFilter fnSourceDeformer(target.sourceDeformer, &status);
+        MFnWeightGeometryFilter fnDestinationDeformer(target.destinationDeformer, &status);
 
-    getAllVertices(numberOfVertices, sourceComponents);
-    getAllVertices(numberOfVertices, destinationComponents);
+        int numberOfVertices = MFnMesh(target.sourceMesh).numVertices();
+        int numberOfDestinationVertices = MFnMesh(target.destinationMesh).numVertices();
 
-    MFloatArray sourceWeights(numberOfVertices);
-    MFloatArray destinationWeights(numberOfVertices);
+        MObject sourceComponents;
+        getAllVertices(numberOfVertices, sourceComponents);
+        getAllVertices(numberOfDestinationVertices, target.weightComponents);
 
-    oldWeightValues.setLength(numberOfVertices);
-    
-    uint sourceGeometryIndex = fnSourceDeformer.indexForOutputShape(this->sourceMesh.node(), &status);
+        sourceWeights[t].setLength(numberOfVertices);
+        target.oldWeightValues.setLength(numberOfDestinationVertices);
+        
+        target.sourceGeometryIndex = fnSourceDeformer.indexForOutputShape(target.sourceMesh.node(), &status);
 
-    if (!status)
-    {
-        MString errorMsg("Source mesh ^1s is not deformed by deformer ^2s.");
-        errorMsg.format(errorMsg, this->sourceMesh.partialPathName(), MFnDependencyNode(this->sourceDeformer).name());
+        if (!status)
+        {
+            MString errorMsg("Source mesh ^1s is not deformed by deformer ^2s.");
+            errorMsg.format(errorMsg, target.sourceMesh.partialPathName(), MFnDependencyNode(target.sourceDeformer).name());
 
-        MGlobal::displayError(errorMsg);
-        return MStatus::kFailure;
-    }
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
 
-    uint destinationGeometryIndex = fnDestinationDeformer.indexForOutputShape(this->destinationMesh.node(), &status);
+        target.destinationGeometryIndex = fnDestinationDeformer.indexForOutputShape(target.destinationMesh.node(), &status);
 
-    if (!status)
-    {
-        MString errorMsg("Destination mesh ^1s is not deformed by deformer ^2s.");
-        errorMsg.format(errorMsg, this->destinationMesh.partialPathName(), MFnDependencyNode(this->destinationDeformer).name());
+        if (!status)
+        {
+            MString errorMsg("Destination mesh ^1s is not deformed by deformer ^2s.");
+            errorMsg.format(errorMsg, target.destinationMesh.partialPathName(), MFnDependencyNode(target.destinationDeformer).name());
 
-        MGlobal::displayError(errorMsg);
-        return MStatus::kFailure;
-    }
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
 
-    status = fnSourceDeformer.getWeights(sourceGeometryIndex, sourceComponents, sourceWeights);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+        {
+            ProfileScope readScope("getWeights");
 
-    status = fnDestinationDeformer.getWeights(destinationGeometryIndex, destinationComponents, oldWeightValues);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+            status = fnSourceDeformer.getWeights(target.sourceGeometryIndex, sourceComponents, sourceWeights[t]);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    destinationWeights.copy(sourceWeights);
+            status = fnDestinationDeformer.getWeights(target.destinationGeometryIndex, target.weightComponents, target.oldWeightValues);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    if (mirrorWeights || flipWeights)
-    {
-        vector<int> vertexSymmetry;
-        vector<int> vertexSides;
+            readScope.countAllocation(((size_t) numberOfVertices + numberOfDestinationVertices) * sizeof(float));
+        }
+
+        if (target.correspondence != nullptr)
+        {
+            destinationWeights[t].copy(target.oldWeightValues);
+
+            vector<int> &vertices = targetVertices[t];
+            vertices.reserve(numberOfDestinationVertices);
 
-        MFnDependencyNode fnNode(polySymmetryData);
+            MItGeometry itGeo(target.destinationMesh, target.components);
 
-        PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
-        PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, vertexSides);
+            while (!itGeo.isDone())
+            {
+                vertices.push_back(itGeo.index());
+                itGeo.next();
+            }
 
-        MItGeometry itGeo(destinationMesh, components);
+            sort(vertices.begin(), vertices.end());
+            vertices.erase(unique(vertices.begin(), vertices.end()), vertices.end());
 
-        bool useVertexSelection = !components.isNull();
+            continue;
+        }
 
-        while (!itGeo.isDone())
+        destinationWeights[t].copy(sourceWeights[t]);
+
+        if (mirrorWeights || flipWeights)
         {
-            int i = itGeo.index();
-            int o = vertexSymmetry[i];
+            targetTables[t] = target.symmetryTables;
+
+            const vector<int> &vertexSymmetry = targetTables[t]->vertexSymmetry;
 
-            float wti = this->getWeight(i, sourceWeights, vertexSymmetry, vertexSides);
-            destinationWeights.set(wti, i);  
+            bool useVertexSelection = !target.components.isNull();
 
-            if (useVertexSelection)
+            vector<int> &vertices = targetVertices[t];
+            vector<bool> vertexIsSelected(numberOfVertices, false);
+
+            vertices.reserve(numberOfVertices);
+
+            MItGeometry itGeo(target.destinationMesh, target.components);
+
+            while (!itGeo.isDone())
             {
-                float wto = this->getWeight(o, sourceWeights, vertexSymmetry, vertexSides);
-                destinationWeights.set(wto, o);  
-            }
+                int i = itGeo.index();
+
+                if (!vertexIsSelected[i])
+                {
+                    vertices.push_back(i);
+                    vertexIsSelected[i] = true;
+                }
 
-            itGeo.next();
+                int o = vertexSymmetry[i];
+
+                if (useVertexSelection && o >= 0 && !vertexIsSelected[o])
+                {
+                    vertices.push_back(o);
+                    vertexIsSelected[o] = true;
+                }
+
+                itGeo.next();
+            }
         }
     }
 
-    status = fnDestinationDeformer.setWeight(this->destinationMesh, destinationGeometryIndex, destinationComponents, destinationWeights);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    {
+        ProfileScope remapScope("remapWeights");
 
-    this->geometryIndex = destinationGeometryIndex;
-    this->components = destinationComponents;
+        parallelFor((int) numberOfTargets, [&](int t, int /*threadIndex*/)
+        {
+            const vector<int> &vertices = targetVertices[t];
 
-    return MStatus::kSuccess;    
-}
+            if (vertices.empty()) { return; }
 
-float PolyDeformerWeightsCommand::getWeight(int vertexIndex, MFloatArray &sourceWeights, vector<int> &vertexSymmetry, vector<int> vertexSides)
-{
-    int i = vertexIndex;
-    int o = vertexSymmetry[i];
-    float wt = sourceWeights[i];
+            if (this->targets[t].correspondence != nullptr)
+            {
+                interpolateWeights(&sourceWeights[t][0], &destinationWeights[t][0], vertices, *this->targets[t].correspondence);
+                return;
+            }
 
-    if (flipWeights || (mirrorWeights && vertexSides[i] != direction))
+            vector<int> sourceVertices;
+            vector<char> useOpposite;
+
+            getRemapSources(
+                vertices, 
+                targetTables[t]->vertexSymmetry, 
+                targetTables[t]->vertexSides, 
+                flipWeights, 
+                mirrorWeights, 
+                direction, 
+                sourceVertices, 
+                useOpposite
+            );
+
+            remapWeights(&sourceWeights[t][0], &destinationWeights[t][0], vertices, sourceVertices);
+        });
+    }
+
+    ProfileScope writeScope("setWeights");
+
+    for (size_t t = 0; t < numberOfTargets; t++)
     {
-        wt = sourceWeights[o];
+        DeformerWeightsTarget &target = this->targets[t];
+
+        MFnWeightGeometryFilter fnDestinationDeformer(target.destinationDeformer, &status);
+
+        status = fnDestinationDeformer.setWeight(target.destinationMesh, target.destinationGeometryIndex, target.weightComponents, destinationWeights[t]);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
     }
 
-    return wt;
+    return MStatus::kSuccess;    
 }
 
 
@@ -345,16 +644,21 @@ MStatus PolyDeformerWeightsCommand::undoIt()
 {
     MStatus status;
 
-    MFnWeightGeometryFilter fnDeformer(this->destinationDeformer, &status);
+    for (size_t t = 0; t < this->targets.size(); t++)
+    {
+        DeformerWeightsTarget &target = this->targets[t];
 
-    status = fnDeformer.setWeight(
-        this->destinationMesh,
-        this->geometryIndex,
-        this->components,
-        this->oldWeightValues
-    );
+        MFnWeightGeometryFilter fnDeformer(target.destinationDeformer, &status);
 
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+        status = fnDeformer.setWeight(
+            target.destinationMesh,
+            target.destinationGeometryIndex,
+            target.weightComponents,
+            target.oldWeightValues
+        );
+
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
     return MStatus::kSuccess;
 }
\ No newline at end of file
@@ -6,13 +6,20 @@
 #ifndef POLY_DEFORMER_WEIGHTS_H
 #define POLY_DEFORMER_WEIGHTS_H
 
+#include "meshCorrespondence.h"
+#include "pointKernels.h"
+#include "symmetryTables.h"
+
+#include <memory>
 #include <vector>
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MFloatArray.h>
 #include <maya/MObject.h>
+#include <maya/MObjectArray.h>
 #include <maya/MPxCommand.h>
 #include <maya/MString.h>
 #include <maya/MStatus.h>
@@ -20,6 +27,31 @@
 
 using namespace std;
 
+/*
+    One source deformer/mesh pair and the deformer/mesh pair its weights are 
+    copied, flipped, or mirrored onto. When the meshes do not share a 
+    topology, `correspondence` locates each destination vertex on the 
+    source, and is used instead of the symmetry tables.
+*/
+struct DeformerWeightsTarget
+{
+    MObject             sourceDeformer;
+    MDagPath            sourceMesh;
+
+    MObject             destinationDeformer;
+    MDagPath            destinationMesh;
+
+    shared_ptr<const SymmetryTables> symmetryTables;
+    shared_ptr<const MeshCorrespondence> correspondence;
+    MObject             components;
+
+    uint                sourceGeometryIndex = 0;
+    uint                destinationGeometryIndex = 0;
+
+    MObject             weightComponents;
+    MFloatArray         oldWeightValues;
+};
+
 class PolyDeformerWeightsCommand : public MPxCommand
 {
 public:
@@ -31,13 +63,12 @@ public:
 
     virtual MStatus     parseArguments(MArgDatabase &argsData);
     virtual MStatus     validateArguments();
+    virtual MStatus     validateTarget(DeformerWeightsTarget &target);
 
     virtual MStatus     doIt(const MArgList& argList);
     virtual MStatus     redoIt();
     virtual MStatus     undoIt();
 
-    virtual float       getWeight(int vertexIndex, MFloatArray &sourceWeights, vector<int> &vertexSymmetry, vector<int> vertexSides);
-
     virtual bool        isUndoable() const { return true; }
     virtual bool        hasSyntax()  const { return true; }
 
@@ -48,19 +79,18 @@ private:
     int                 direction     = 1;
     bool                mirrorWeights = false;
     bool                flipWeights   = false;
-    
-    uint                geometryIndex;
+    bool                allDeformers  = false;
 
-    MFloatArray         oldWeightValues;
+    MirrorPlane         mirrorPlane;
+    MDagPath            mirrorFrame;
 
-    MDagPath            sourceMesh;
-    MDagPath            destinationMesh;
+    MObjectArray        sourceDeformers;
+    MDagPathArray       sourceMeshes;
 
-    MObject             polySymmetryData;
+    MObjectArray        destinationDeformers;
+    MDagPathArray       destinationMeshes;
 
-    MObject             sourceDeformer;
-    MObject             destinationDeformer;
-    MObject             components;
+    vector<DeformerWeightsTarget> targets;
 };
 
 #endif 
\ No newline at end of file
@@ -3,23 +3,32 @@
     You may use, distribute, or modify this code under the terms of the MIT license.
 */
 
+#include <memory>
 #include <vector>
 
+#include "meshCorrespondence.h"
+#include "meshPoints.h"
+#include "parseArgs.h"
+#include "pointKernels.h"
 #include "polyFlipCmd.h"
 #include "polySymmetryNode.h"
+#include "profiling.h"
 #include "sceneCache.h"
+#include "selection.h"
+#include "undoDelta.h"
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
 #include <maya/MFnDependencyNode.h>
+#include <maya/MFloatPointArray.h>
 #include <maya/MFnMesh.h>
 #include <maya/MGlobal.h>
-#include <maya/MItGeometry.h>
 #include <maya/MIntArray.h>
 #include <maya/MPoint.h>
 #include <maya/MPointArray.h>
 #include <maya/MPxCommand.h>
+#include <maya/MRichSelection.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
 #include <maya/MStatus.h>
@@ -34,7 +43,14 @@ using namespace std;
 #define OBJECT_SPACE_LONG_FLAG "-objectSpace"
 
 #define REFERENCE_MESH_FLAG "-ref"
-#define REFERENCE_MESH_LONG_FLAG "-referenceFlag"
+#define REFERENCE_MESH_LONG_FLAG "-referenceMesh"
+
+// Long name of -ref before it was renamed, kept so that existing scripts still run.
+#define LEGACY_REFERENCE_MESH_FLAG "-rfl"
+#define LEGACY_REFERENCE_MESH_LONG_FLAG "-referenceFlag"
+
+#define SOFT_SELECTION_FLAG "-ss"
+#define SOFT_SELECTION_LONG_FLAG "-softSelection"
 
 PolyFlipCommand::PolyFlipCommand()  {}
 PolyFlipCommand::~PolyFlipCommand() {}
@@ -54,6 +70,10 @@ MSyntax PolyFlipCommand::getSyntax()
     syntax.addFlag(WORLD_SPACE_FLAG, WORLD_SPACE_LONG_FLAG);
     syntax.addFlag(OBJECT_SPACE_FLAG, OBJECT_SPACE_LONG_FLAG);
     syntax.addFlag(REFERENCE_MESH_FLAG, REFERENCE_MESH_LONG_FLAG, MSyntax::kSelectionItem);
+    syntax.addFlag(LEGACY_REFERENCE_MESH_FLAG, LEGACY_REFERENCE_MESH_LONG_FLAG, MSyntax::kSelectionItem);
+    syntax.addFlag(SOFT_SELECTION_FLAG, SOFT_SELECTION_LONG_FLAG);
+
+    parseArgs::addMirrorPlaneFlags(syntax);
 
     syntax.enableQuery(false);
     syntax.enableEdit(false);
@@ -65,6 +85,8 @@ MStatus PolyFlipCommand::doIt(const MArgList& argList)
 {
     MStatus status;
 
+    ProfileScope profileScope("polyFlip");
+
     MArgDatabase argsData(syntax(), argList);
 
     MSelectionList selection;
@@ -78,58 +100,81 @@ MStatus PolyFlipCommand::doIt(const MArgList& argList)
         return MStatus::kFailure;
     }
     
-    bool cacheHit = PolySymmetryCache::getNodeFromCache(this->selectedMesh, this->polySymmetryData);
+    MSelectionList componentSelection(selection);
 
-    if (!cacheHit)
+    if (argsData.isFlagSet(SOFT_SELECTION_FLAG))
     {
-        MString errorMsg("^1s has not had it's symmetry computed.");
-        errorMsg.format(errorMsg, selectedMesh.partialPathName());
-
-        MGlobal::displayError(errorMsg);
+        MRichSelection richSelection;
+        MGlobal::getRichSelection(richSelection);
 
-        return MStatus::kFailure;
+        componentSelection.clear();
+        richSelection.getSelection(componentSelection);
     }
 
-    if (argsData.isFlagSet(WORLD_SPACE_FLAG))
-    {
-        this->worldSpace = true;
-    }
+    getSelectedVertexWeights(this->selectedMesh, componentSelection, this->selectedVertices, this->selectedWeights);
+
+    this->worldSpace = argsData.isFlagSet(WORLD_SPACE_FLAG);
+    this->objectSpace = !this->worldSpace;
+
+    MDagPath mirrorFrame;
+    status = parseArgs::getMirrorPlaneArguments(argsData, this->mirrorPlane, mirrorFrame);
+    if (!status) { return status; }
 
-    if (argsData.isFlagSet(OBJECT_SPACE_FLAG))
+    if (mirrorFrame.isValid())
     {
-        this->worldSpace = true;
+        MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
+        status = getFramePlane(mirrorFrame, this->mirrorPlane.axis, this->selectedMesh, space, this->mirrorPlane);
+
+        if (!status)
+        {
+            MString errorMsg("^1s does not span a plane to mirror across.");
+            errorMsg.format(errorMsg, mirrorFrame.partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
     }
 
-    if (argsData.isFlagSet(REFERENCE_MESH_FLAG))
-    {
-        MSelectionList referenceMeshSelection;
+    const char* referenceFlag = argsData.isFlagSet(REFERENCE_MESH_FLAG) ? REFERENCE_MESH_FLAG : LEGACY_REFERENCE_MESH_FLAG;
 
-        argsData.getObjects(referenceMeshSelection);
+    status = parseArgs::getDagPathArgument(argsData, referenceFlag, this->referenceMesh, false);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
-        status = referenceMeshSelection.getDagPath(0, this->referenceMesh);
-        
-        if (!status || !this->referenceMesh.hasFn(MFn::kMesh))
+    if (argsData.isFlagSet(referenceFlag))
+    {
+        if (!this->referenceMesh.isValid() || !this->referenceMesh.hasFn(MFn::kMesh))
         {
-            MString errorMsg("%s flag requires a mesh.");
+            MString errorMsg("^1s flag requires a mesh.");
             errorMsg.format(errorMsg, MString(REFERENCE_MESH_LONG_FLAG));
 
             MGlobal::displayError(errorMsg);
             return MStatus::kFailure;
         }
 
-        MFnMesh fnRef(this->selectedMesh);
-        MFnMesh fnSel(this->referenceMesh);
+        MFnMesh fnSel(this->selectedMesh);
+        MFnMesh fnRef(this->referenceMesh);
 
-        if (
-            (fnRef.numVertices() != fnSel.numVertices())
-            || (fnRef.numEdges() != fnSel.numEdges())
-            || (fnRef.numPolygons() != fnSel.numPolygons())
-        ) {
-            MString errorMsg("Reference mesh is not point compatible with selected mesh.");
-            MGlobal::displayError(errorMsg);
+        // A reference with another topology, such as another LOD, is projected onto.
+        this->isReferenceCompatible = isPointCompatible(fnSel, fnRef);
+    }
 
-            return MStatus::kFailure;
-        }
+    // Without symmetry tables, a symmetrical reference is enough to find the opposite of each vertex.
+    if (!PolySymmetryCache::getSymmetryTables(this->selectedMesh, this->symmetryTables) && !this->referenceMesh.isValid())
+    {
+        MString errorMsg("^1s has not had it's symmetry computed.");
+        errorMsg.format(errorMsg, selectedMesh.partialPathName());
+
+        MGlobal::displayError(errorMsg);
+
+        return MStatus::kFailure;
+    }
+
+    if (this->symmetryTables == nullptr)
+    {
+        MString warningMsg("^1s has not had its symmetry computed, so its opposite points are found on the reflected surface of ^2s. Run polySymmetry on it to use its topology instead.");
+        warningMsg.format(warningMsg, selectedMesh.partialPathName(), referenceMesh.partialPathName());
+
+        MGlobal::displayWarning(warningMsg);
     }
 
     return this->redoIt();
@@ -137,49 +182,101 @@ MStatus PolyFlipCommand::doIt(const MArgList& argList)
 
 MStatus PolyFlipCommand::redoIt()
 {
-    if (this->worldSpace || this->objectSpace)
+    if (this->referenceMesh.isValid())
     {
-        return this->flipMesh();
-    } else if (this->referenceMesh.isValid()) {
-        return this->flipMeshAgainst();
-    } else {
-        return MStatus::kSuccess;
+        return this->symmetryTables == nullptr ? this->flipMeshThrough() : this->flipMeshAgainst();
     }
+
+    return this->flipMesh();
 }
 
 
-MStatus PolyFlipCommand::flipMesh()
+/* 
+    Points in object space are read straight from the mesh; world space points 
+    have to be transformed, so they are copied into `buffer`.
+*/
+static PointBuffer getPointBuffer(MFnMesh &fnMesh, MSpace::Space space, MFloatPointArray &buffer)
 {
     MStatus status;
 
-    MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
+    if (space == MSpace::kObject)
+    {
+        return PointBuffer(fnMesh.getRawPoints(&status), 3);
+    }
+
+    ProfileScope readScope("getPoints");
+    fnMesh.getPoints(buffer, space);
+
+    return PointBuffer(&buffer[0].x, 4);
+}
+
+/*
+    Rest points of `points` on the surface of a reference that is not point
+    compatible with the mesh, written 4 floats per point.
+*/
+static MStatus getProjectedReferencePoints(const MDagPath &referenceMesh, MSpace::Space space, PointBuffer points, int numberOfPoints, vector<float> &result)
+{
+    MStatus status;
+
+    MFnMesh fnReference(referenceMesh);
+
+    MFloatPointArray referenceBuffer;
+    PointBuffer referencePoints = getPointBuffer(fnReference, space, referenceBuffer);
 
-    vector<int> vertexSymmetry;
-    vector<int> vertexSides;
+    status = getProjectedPoints(fnReference, referencePoints, points, numberOfPoints, result);
+
+    if (!status)
+    {
+        MString errorMsg("Reference mesh ^1s has no faces.");
+        errorMsg.format(errorMsg, referenceMesh.partialPathName());
 
-    MFnDependencyNode fnNode(this->polySymmetryData);
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
 
-    PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
-    PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, vertexSides);
+    return MStatus::kSuccess;
+}
+
+MStatus PolyFlipCommand::flipMesh()
+{
+    MStatus status;
+
+    if (!this->selectedVertices.empty()) { return this->flipSelectedVertices(false); }
+
+    MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
+
+    const vector<int> &vertexSymmetry = this->symmetryTables->vertexSymmetry;
 
     MFnMesh fnMesh(this->selectedMesh);
-    MItGeometry itGeo(this->selectedMesh);
-    itGeo.allPositions(this->originalPoints, space);
+    MFloatPointArray originalPoints;
 
-    uint numberOfVertices = fnMesh.numVertices();
-    MPointArray newPoints(numberOfVertices);
+    {
+        ProfileScope readScope("getPoints");
+        fnMesh.getPoints(originalPoints, space);
+    }
 
-    MPoint pnt;
+    int numberOfVertices = (int) originalPoints.length();
+    if (numberOfVertices == 0) { return MStatus::kSuccess; }
+
+    MFloatPointArray newPoints(numberOfVertices);
 
-    for (uint i = 0; i < numberOfVertices; i++)
     {
-        int o = vertexSymmetry[i];
-        pnt = this->originalPoints[o];
+        ProfileScope kernelScope("flipPoints");
+        flipPoints(
+            PointBuffer(&originalPoints[0].x, 4), 
+            vertexSymmetry.data(), 
+            numberOfVertices, 
+            this->mirrorPlane, 
+            &newPoints[0].x
+        );
+    }
 
-        newPoints.set(i, pnt.x * -1.0, pnt.y, pnt.z);
+    {
+        ProfileScope writeScope("setPoints");
+        fnMesh.setPoints(newPoints, space);
     }
 
-    itGeo.setAllPositions(newPoints, space);
+    this->pointDelta.record(&originalPoints[0].x, &newPoints[0].x, numberOfVertices, 3, 4);
 
     return MStatus::kSuccess;
 }
@@ -188,64 +285,224 @@ MStatus PolyFlipCommand::flipMeshAgainst()
 {
     MStatus status;
 
+    if (!this->selectedVertices.empty()) { return this->flipSelectedVertices(true); }
+
     MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
 
-    vector<int> vertexSymmetry;
-    vector<int> vertexSides;
+    const vector<int> &vertexSymmetry = this->symmetryTables->vertexSymmetry;
 
-    MPointArray referencePoints;
-    MFnDependencyNode fnNode(this->polySymmetryData);
+    MFnMesh fnMesh(this->selectedMesh);
+    MFnMesh fnReference(this->referenceMesh);
+
+    MFloatPointArray originalPoints;
 
-    PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
-    PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, vertexSides);
+    {
+        ProfileScope readScope("getPoints");
+        fnMesh.getPoints(originalPoints, space);
+    }
+
+    int numberOfVertices = (int) originalPoints.length();
+    if (numberOfVertices == 0) { return MStatus::kSuccess; }
+
+    MFloatPointArray referenceBuffer;
+    vector<float> projectedPoints;
+    PointBuffer referencePoints(nullptr, 4);
+
+    if (this->isReferenceCompatible)
+    {
+        referencePoints = getPointBuffer(fnReference, space, referenceBuffer);
+    } else {
+        status = getProjectedReferencePoints(this->referenceMesh, space, PointBuffer(&originalPoints[0].x, 4), numberOfVertices, projectedPoints);
+        if (!status) { return status; }
+
+        referencePoints = PointBuffer(projectedPoints.data(), 4);
+    }
+
+    MFloatPointArray newPoints(numberOfVertices);
+
+    {
+        ProfileScope kernelScope("flipPointsAgainst");
+        flipPointsAgainst(
+            PointBuffer(&originalPoints[0].x, 4), 
+            referencePoints, 
+            vertexSymmetry.data(), 
+            numberOfVertices, 
+            this->mirrorPlane, 
+            &newPoints[0].x
+        );
+    }
+
+    {
+        ProfileScope writeScope("setPoints");
+        fnMesh.setPoints(newPoints, space);
+    }
+
+    this->pointDelta.record(&originalPoints[0].x, &newPoints[0].x, numberOfVertices, 3, 4);
+
+    return MStatus::kSuccess;
+}
+
+/*
+    Flips against the reference without symmetry tables. The opposite of each
+    vertex is found on the reflected surface of the reference, so it works on
+    a mesh whose topology is not symmetrical, as long as its reference shape
+    is. With a component selection, only the selected vertices are moved.
+
+    A reference that is not point compatible with the mesh gives the rest 
+    point of each vertex on its surface, and the opposite of each vertex is 
+    found on the reflected rest shape of the mesh.
+*/
+MStatus PolyFlipCommand::flipMeshThrough()
+{
+    MStatus status;
+
+    MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
 
     MFnMesh fnMesh(this->selectedMesh);
+    MFnMesh fnReference(this->referenceMesh);
 
-    MItGeometry itRef(this->referenceMesh);
-    MItGeometry itGeo(this->selectedMesh);
+    MFloatPointArray originalPoints;
 
-    itRef.allPositions(referencePoints, space);
-    itGeo.allPositions(this->originalPoints, space);
+    {
+        ProfileScope readScope("getPoints");
+        fnMesh.getPoints(originalPoints, space);
+    }
 
-    uint numberOfVertices = fnMesh.numVertices();
-    MPointArray newPoints(numberOfVertices);
+    int numberOfVertices = (int) originalPoints.length();
+    if (numberOfVertices == 0) { return MStatus::kSuccess; }
 
-    MPoint pnt;
-    MPoint ref;
-    MVector delta;
+    MFloatPointArray referenceBuffer;
+    vector<float> projectedPoints;
+    PointBuffer referencePoints(nullptr, 4);
 
-    for (uint i = 0; i < numberOfVertices; i++)
+    if (this->isReferenceCompatible)
     {
-        if (vertexSides[i] == 0)
-        {
-            newPoints.set(this->originalPoints[i], i);
-        }
+        referencePoints = getPointBuffer(fnReference, space, referenceBuffer);
+    } else {
+        status = getProjectedReferencePoints(this->referenceMesh, space, PointBuffer(&originalPoints[0].x, 4), numberOfVertices, projectedPoints);
+        if (!status) { return status; }
+
+        referencePoints = PointBuffer(projectedPoints.data(), 4);
+    }
 
-        int o = vertexSymmetry[i];
-        pnt = this->originalPoints[o];
-        ref = referencePoints[o];
+    // The projected rest points are laid out over the faces of the mesh itself.
+    MDagPath surfaceMesh = this->isReferenceCompatible ? this->referenceMesh : this->selectedMesh;
+    MFnMesh fnSurface(surfaceMesh);
 
-        delta = pnt - ref;
+    shared_ptr<const MeshCorrespondence> correspondence;
 
-        ref = referencePoints[i];
+    status = getMeshCorrespondence(fnSurface, referencePoints, referencePoints, numberOfVertices, true, false, 1, this->mirrorPlane, correspondence);
+
+    if (!status)
+    {
+        MString errorMsg("^1s has no faces.");
+        errorMsg.format(errorMsg, surfaceMesh.partialPathName());
+
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
 
-        newPoints.set(
-            i,
-            (delta.x * -1.0) + ref.x,
-            delta.y + ref.y,
-            delta.z + ref.z
+    MFloatPointArray newPoints(numberOfVertices);
+
+    {
+        ProfileScope kernelScope("flipPointsThrough");
+        flipPointsThrough(
+            PointBuffer(&originalPoints[0].x, 4), 
+            referencePoints, 
+            *correspondence, 
+            this->mirrorPlane, 
+            &newPoints[0].x
+        );
+    }
+
+    blendSelectedPoints(originalPoints, this->selectedVertices, this->selectedWeights, newPoints);
+
+    {
+        ProfileScope writeScope("setPoints");
+        fnMesh.setPoints(newPoints, space);
+    }
+
+    this->pointDelta.record(&originalPoints[0].x, &newPoints[0].x, numberOfVertices, 3, 4);
+
+    return MStatus::kSuccess;
+}
+
+/*
+    Only the selected vertices and their partners are read and written. The
+    kernels run on the packed points of those vertices, with the symmetry 
+    table remapped to positions in the packed buffers.
+*/
+MStatus PolyFlipCommand::flipSelectedVertices(bool againstReference)
+{
+    MStatus status;
+
+    MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
+
+    vector<int> vertices;
+    vector<int> symmetry;
+    vector<float> weights;
+
+    getSymmetricVertices(this->symmetryTables->vertexSymmetry, this->selectedVertices, this->selectedWeights, vertices, symmetry, weights);
+
+    int numberOfVertices = (int) vertices.size();
+    if (numberOfVertices == 0) { return MStatus::kSuccess; }
+
+    MFnMesh fnMesh(this->selectedMesh);
+
+    vector<float> originalPoints;
+    getVertexPoints(fnMesh, vertices, space, originalPoints);
+
+    vector<float> newPoints((size_t) numberOfVertices * 4);
+
+    if (againstReference)
+    {
+        vector<float> referencePoints;
+
+        if (this->isReferenceCompatible)
+        {
+            MFnMesh fnReference(this->referenceMesh);
+            getVertexPoints(fnReference, vertices, space, referencePoints);
+        } else {
+            status = getProjectedReferencePoints(this->referenceMesh, space, PointBuffer(originalPoints.data(), 4), numberOfVertices, referencePoints);
+            if (!status) { return status; }
+        }
+
+        {
+            ProfileScope kernelScope("flipPointsAgainst");
+            flipPointsAgainst(
+                PointBuffer(originalPoints.data(), 4), 
+                PointBuffer(referencePoints.data(), 4), 
+                symmetry.data(), 
+                numberOfVertices, 
+                this->mirrorPlane, 
+                newPoints.data()
+            );
+        }
+    } else {
+        ProfileScope kernelScope("flipPoints");
+        flipPoints(
+            PointBuffer(originalPoints.data(), 4), 
+            symmetry.data(), 
+            numberOfVertices, 
+            this->mirrorPlane, 
+            newPoints.data()
         );
     }
 
-    itGeo.setAllPositions(newPoints, space);
+    blendVertexPoints(originalPoints, weights, newPoints);
+    setVertexPoints(fnMesh, vertices, newPoints.data(), 4, space);
+
+    this->pointDelta.recordRows(vertices.data(), originalPoints.data(), newPoints.data(), numberOfVertices, 3, 4);
 
     return MStatus::kSuccess;
 }
 
 MStatus PolyFlipCommand::undoIt()
 {   
+    MSpace::Space space = this->worldSpace ? MSpace::kWorld : MSpace::kObject;
+
     MFnMesh fnMesh(this->selectedMesh);
-    fnMesh.setPoints(this->originalPoints, MSpace::kObject);
+    restoreVertexPoints(fnMesh, this->pointDelta, space);
 
     return MStatus::kSuccess;
-}
+}
\ No newline at end of file
@@ -6,9 +6,17 @@
 #ifndef POLY_FLIP_CMD_H
 #define POLY_FLIP_CMD_H
 
+#include "pointKernels.h"
+#include "symmetryTables.h"
+#include "undoDelta.h"
+
+#include <memory>
+#include <vector>
+
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MFloatPointArray.h>
 #include <maya/MPoint.h>
 #include <maya/MPointArray.h>
 #include <maya/MPxCommand.h>
@@ -33,6 +41,8 @@ public:
 
     virtual MStatus     flipMesh();
     virtual MStatus     flipMeshAgainst();
+    virtual MStatus     flipMeshThrough();
+    virtual MStatus     flipSelectedVertices(bool againstReference);
 
     virtual bool        isUndoable() const { return true; }
     virtual bool        hasSyntax()  const { return true; }
@@ -44,10 +54,16 @@ private:
     bool                worldSpace = false;
     bool                objectSpace = true;
 
-    MPointArray         originalPoints;
-    MObject             polySymmetryData;
+    MirrorPlane         mirrorPlane;
+
+    vector<int>         selectedVertices;
+    vector<float>       selectedWeights;
+
+    RowDelta<float>     pointDelta;
+    shared_ptr<const SymmetryTables> symmetryTables;
     MDagPath            selectedMesh;
     MDagPath            referenceMesh;
+    bool                isReferenceCompatible = true;
 };
 
 #endif
\ No newline at end of file
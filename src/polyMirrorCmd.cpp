@@ -3,23 +3,34 @@
     You may use, distribute, or modify this code under the terms of the MIT license.
 */
 
+#include <memory>
 #include <vector>
 
+#include "meshCorrespondence.h"
+#include "meshPoints.h"
+#include "parallel.h"
+#include "parseArgs.h"
+#include "pointKernels.h"
 #include "polyMirrorCmd.h"
 #include "polySymmetryNode.h"
+#include "profiling.h"
 #include "sceneCache.h"
+#include "selection.h"
+#include "undoDelta.h"
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MFnDependencyNode.h>
+#include <maya/MFloatPointArray.h>
 #include <maya/MFnMesh.h>
 #include <maya/MGlobal.h>
-#include <maya/MItGeometry.h>
 #include <maya/MIntArray.h>
 #include <maya/MPoint.h>
 #include <maya/MPointArray.h>
 #include <maya/MPxCommand.h>
+#include <maya/MRichSelection.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
 #include <maya/MStatus.h>
@@ -27,6 +38,9 @@
 
 using namespace std;
 
+#define SOFT_SELECTION_FLAG "-ss"
+#define SOFT_SELECTION_LONG_FLAG "-softSelection"
+
 PolyMirrorCommand::PolyMirrorCommand()  {}
 PolyMirrorCommand::~PolyMirrorCommand() {}
 
@@ -39,9 +53,13 @@ MSyntax PolyMirrorCommand::getSyntax()
 {
     MSyntax syntax;
 
-    syntax.setObjectType(MSyntax::kSelectionList, 2, 2);
+    syntax.setObjectType(MSyntax::kSelectionList, 2);
     syntax.useSelectionAsDefault(true);
 
+    syntax.addFlag(SOFT_SELECTION_FLAG, SOFT_SELECTION_LONG_FLAG);
+
+    parseArgs::addMirrorPlaneFlags(syntax);
+
     syntax.enableQuery(false);
     syntax.enableEdit(false);
 
@@ -52,6 +70,8 @@ MStatus PolyMirrorCommand::doIt(const MArgList& argList)
 {
     MStatus status;
 
+    ProfileScope profileScope("polyMirror");
+
     MArgDatabase argsData(syntax(), argList);
 
     MSelectionList selection;
@@ -59,100 +79,328 @@ MStatus PolyMirrorCommand::doIt(const MArgList& argList)
 
     MStatus baseMeshStatus = selection.getDagPath(0, this->baseMesh);
 
-    MStatus targetMeshStatus = selection.getDagPath(1, this->targetMesh);
-
-    if (!this->baseMesh.hasFn(MFn::kMesh) || !this->targetMesh.hasFn(MFn::kMesh))
+    if (!this->baseMesh.hasFn(MFn::kMesh) || selection.length() < 2)
     {
         MGlobal::displayError("polyMirror command requires a a base mesh and a target mesh.");
         return MStatus::kFailure;
     }
 
     MFnMesh fnBaseMesh(this->baseMesh);
-    MFnMesh fnTargetMesh(this->targetMesh);
 
-    if (
-        (fnBaseMesh.numVertices() != fnTargetMesh.numVertices())
-        || (fnBaseMesh.numEdges() != fnTargetMesh.numEdges())
-        || (fnBaseMesh.numPolygons() != fnTargetMesh.numPolygons())
-    ) {
-        MString errorMsg("Base mesh and target mesh are not point compatible.");
-        MGlobal::displayError(errorMsg);
+    // Points are mirrored in object space, so a frame is placed relative to the base mesh.
+    MDagPath mirrorFrame;
+    status = parseArgs::getMirrorPlaneArguments(argsData, this->mirrorPlane, mirrorFrame);
+    if (!status) { return status; }
 
-        return MStatus::kFailure;
+    if (mirrorFrame.isValid())
+    {
+        status = getFramePlane(mirrorFrame, this->mirrorPlane.axis, this->baseMesh, MSpace::kObject, this->mirrorPlane);
+
+        if (!status)
+        {
+            MString errorMsg("^1s does not span a plane to mirror across.");
+            errorMsg.format(errorMsg, mirrorFrame.partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
     }
 
-    bool cacheHit = PolySymmetryCache::getNodeFromCache(this->targetMesh, this->polySymmetryData);
+    this->targetMeshes.clear();
+    this->symmetryTables.clear();
+    this->isTargetCompatible.clear();
+    this->selectedVertices.clear();
+    this->selectedWeights.clear();
+
+    MSelectionList componentSelection(selection);
 
-    if (!cacheHit)
+    if (argsData.isFlagSet(SOFT_SELECTION_FLAG))
     {
-        MString errorMsg("^1s has not had it's symmetry computed.");
-        errorMsg.format(errorMsg, this->targetMesh.partialPathName());
+        MRichSelection richSelection;
+        MGlobal::getRichSelection(richSelection);
 
-        MGlobal::displayError(errorMsg);
+        componentSelection.clear();
+        richSelection.getSelection(componentSelection);
+    }
 
-        return MStatus::kFailure;
+    for (unsigned i = 1; i < selection.length(); i++)
+    {
+        MDagPath targetMesh;
+        selection.getDagPath(i, targetMesh);
+
+        if (!targetMesh.hasFn(MFn::kMesh))
+        {
+            MGlobal::displayError("polyMirror command requires a a base mesh and a target mesh.");
+            return MStatus::kFailure;
+        }
+
+        MFnMesh fnTargetMesh(targetMesh);
+
+        // Targets without symmetry tables find their opposite points on the base instead.
+        shared_ptr<const SymmetryTables> tables;
+
+        if (!PolySymmetryCache::getSymmetryTables(targetMesh, tables))
+        {
+            MString warningMsg("^1s has not had its symmetry computed, so its opposite points are found on the reflected surface of ^2s. Run polySymmetry on it to use its topology instead.");
+            warningMsg.format(warningMsg, targetMesh.partialPathName(), this->baseMesh.partialPathName());
+
+            MGlobal::displayWarning(warningMsg);
+        }
+
+        this->targetMeshes.append(targetMesh);
+        this->symmetryTables.push_back(tables);
+
+        // A target with another topology, such as another LOD, is projected onto the base.
+        this->isTargetCompatible.push_back(isPointCompatible(fnBaseMesh, fnTargetMesh));
+
+        this->selectedVertices.emplace_back();
+        this->selectedWeights.emplace_back();
+
+        getSelectedVertexWeights(targetMesh, componentSelection, this->selectedVertices.back(), this->selectedWeights.back());
     }
 
     return this->redoIt();
 }
 
+/*
+    The base points are read once for all of the targets. Reading and writing 
+    points stays on the main thread; the point math runs over the targets in 
+    parallel, or over the points of the target when there is only one.
+
+    Targets with a component selection only touch the selected vertices and
+    their partners, and are mirrored on their own. Every target is checked 
+    before the first one is written, so an error leaves the meshes as they 
+    were. Targets without symmetry tables are mirrored through the points of the base, 
+    reflected onto its own surface, and a selection only limits which of 
+    their points move.
+
+    Targets that are not point compatible with the base are mirrored against
+    their rest points, the closest points on the surface of the base. The 
+    opposite of each vertex comes from its symmetry tables, or else from the
+    reflected rest shape of the target. A selection only limits which of 
+    their points move.
+*/
 MStatus PolyMirrorCommand::redoIt()
 {
-    vector<int> vertexSymmetry;
-    vector<int> vertexSides;
+    MStatus status;
+
+    unsigned numberOfTargets = this->targetMeshes.length();
 
-    MFnDependencyNode fnNode(this->polySymmetryData);
+    const vector<shared_ptr<const SymmetryTables>> &tables = this->symmetryTables;
 
-    PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
-    PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, vertexSides);
+    MFnMesh fnBaseMesh(this->baseMesh);
 
-    MPointArray basePoints;
+    int numberOfBaseVertices = fnBaseMesh.numVertices();
+    PointBuffer basePoints(fnBaseMesh.getRawPoints(&status), 3);
 
-    MItGeometry itBaseGeo(this->baseMesh);
-    MItGeometry itTargetGeo(this->targetMesh);
+    vector<MFloatPointArray> originalPoints(numberOfTargets);
+    vector<MFloatPointArray> newPoints(numberOfTargets);
+    vector<vector<float>> projectedPoints(numberOfTargets);
 
-    itBaseGeo.allPositions(basePoints, MSpace::kObject);
-    itTargetGeo.allPositions(originalPoints, MSpace::kObject);
+    vector<PointBuffer> restPoints(numberOfTargets, basePoints);
+    vector<shared_ptr<const MeshCorrespondence>> correspondences(numberOfTargets);
 
-    int numberOfVertices = -1;
-    PolySymmetryNode::getValue(fnNode, NUMBER_OF_VERTICES, numberOfVertices);
-    MPointArray newPoints(numberOfVertices);
+    this->pointDeltas.assign(numberOfTargets, RowDelta<float>());
 
-    MPoint basePnt;
-    MPoint origPnt;
-    MPoint newPnt;
+    shared_ptr<const MeshCorrespondence> baseCorrespondence;
 
-    for (int i = 0; i < numberOfVertices; i++)
+    // Targets with a component selection only read and write their selected vertices.
+    vector<char> mirrorsSelection(numberOfTargets, 0);
+
+    // Every target is checked, and its points and correspondence prepared, before any is written.
+    for (unsigned t = 0; t < numberOfTargets; t++)
+    {
+        MFnMesh fnTargetMesh(this->targetMeshes[t]);
+        int numberOfVertices = fnTargetMesh.numVertices();
+
+        if (tables[t] != nullptr && (int) tables[t]->vertexSymmetry.size() != numberOfVertices)
+        {
+            MString errorMsg("^1s does not match its symmetry data.");
+            errorMsg.format(errorMsg, this->targetMeshes[t].partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        if (tables[t] != nullptr && this->isTargetCompatible[t] && !this->selectedVertices[t].empty())
+        {
+            mirrorsSelection[t] = 1;
+            continue;
+        }
+
+        {
+            ProfileScope readScope("getPoints");
+            fnTargetMesh.getPoints(originalPoints[t], MSpace::kObject);
+        }
+
+        if (numberOfVertices == 0) { continue; }
+
+        newPoints[t].setLength(numberOfVertices);
+
+        if (!this->isTargetCompatible[t])
+        {
+            status = getProjectedPoints(fnBaseMesh, basePoints, PointBuffer(&originalPoints[t][0].x, 4), numberOfVertices, projectedPoints[t]);
+
+            if (!status)
+            {
+                MString errorMsg("Base mesh ^1s has no faces.");
+                errorMsg.format(errorMsg, this->baseMesh.partialPathName());
+
+                MGlobal::displayError(errorMsg);
+                return MStatus::kFailure;
+            }
+
+            restPoints[t] = PointBuffer(projectedPoints[t].data(), 4);
+        }
+
+        if (tables[t] != nullptr) { continue; }
+
+        if (!this->isTargetCompatible[t])
+        {
+            status = getMeshCorrespondence(fnTargetMesh, restPoints[t], restPoints[t], numberOfVertices, true, false, 1, this->mirrorPlane, correspondences[t]);
+        } else if (baseCorrespondence == nullptr) {
+            status = getMeshCorrespondence(fnBaseMesh, basePoints, basePoints, numberOfBaseVertices, true, false, 1, this->mirrorPlane, baseCorrespondence);
+            correspondences[t] = baseCorrespondence;
+        } else {
+            correspondences[t] = baseCorrespondence;
+        }
+
+        if (!status)
+        {
+            MDagPath surfaceMesh = this->isTargetCompatible[t] ? this->baseMesh : this->targetMeshes[t];
+
+            MString errorMsg("^1s has no faces.");
+            errorMsg.format(errorMsg, surfaceMesh.partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+    }
+
+    // With a single target, the kernel splits the points across threads instead.
+    parallelFor((int) numberOfTargets, [&](int t, int /*threadIndex*/)
     {
-        int o = vertexSymmetry[i];
-        newPnt = originalPoints[o];
+        if (newPoints[t].length() == 0) { return; }
+
+        if (tables[t] == nullptr)
+        {
+            {
+                ProfileScope kernelScope("mirrorPointsThrough");
+                mirrorPointsThrough(
+                    PointBuffer(&originalPoints[t][0].x, 4), 
+                    restPoints[t], 
+                    *correspondences[t], 
+                    this->mirrorPlane, 
+                    &newPoints[t][0].x
+                );
+            }
+
+            blendSelectedPoints(originalPoints[t], this->selectedVertices[t], this->selectedWeights[t], newPoints[t]);
+            return;
+        }
+
+        {
+            ProfileScope kernelScope("mirrorPoints");
+            mirrorPoints(
+                PointBuffer(&originalPoints[t][0].x, 4), 
+                restPoints[t], 
+                tables[t]->vertexSymmetry.data(), 
+                (int) newPoints[t].length(), 
+                this->mirrorPlane, 
+                &newPoints[t][0].x
+            );
+        }
+
+        blendSelectedPoints(originalPoints[t], this->selectedVertices[t], this->selectedWeights[t], newPoints[t]);
+    });
+
+    for (unsigned t = 0; t < numberOfTargets; t++)
+    {
+        if (mirrorsSelection[t])
+        {
+            status = this->mirrorSelectedVertices(t, *tables[t]);
+
+            // Put back the targets that were already written, so a failure leaves no partial edit.
+            if (!status)
+            {
+                this->undoIt();
+                return status;
+            }
+
+            continue;
+        }
 
-        newPoints.set(i, newPnt.x * -1.0, newPnt.y, newPnt.z);
+        if (newPoints[t].length() == 0) { continue; }
+
+        MFnMesh fnTargetMesh(this->targetMeshes[t]);
+
+        {
+            ProfileScope writeScope("setPoints");
+            fnTargetMesh.setPoints(newPoints[t], MSpace::kObject);
+        }
+
+        this->pointDeltas[t].record(&originalPoints[t][0].x, &newPoints[t][0].x, (int) newPoints[t].length(), 3, 4);
     }
-    
-    for (int i = 0; i < numberOfVertices; i++)
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolyMirrorCommand::mirrorSelectedVertices(unsigned targetIndex, const SymmetryTables &tables)
+{
+    vector<int> vertices;
+    vector<int> symmetry;
+    vector<float> weights;
+
+    getSymmetricVertices(
+        tables.vertexSymmetry, 
+        this->selectedVertices[targetIndex], 
+        this->selectedWeights[targetIndex], 
+        vertices, 
+        symmetry, 
+        weights
+    );
+
+    int numberOfVertices = (int) vertices.size();
+    if (numberOfVertices == 0) { return MStatus::kSuccess; }
+
+    MFnMesh fnBaseMesh(this->baseMesh);
+    MFnMesh fnTargetMesh(this->targetMeshes[targetIndex]);
+
+    vector<float> basePoints;
+    vector<float> originalPoints;
+
+    getVertexPoints(fnBaseMesh, vertices, MSpace::kObject, basePoints);
+    getVertexPoints(fnTargetMesh, vertices, MSpace::kObject, originalPoints);
+
+    vector<float> newPoints((size_t) numberOfVertices * 4);
+
     {
-        origPnt = originalPoints[i];
-        basePnt = basePoints[i];
-        newPnt = newPoints[i];
-
-        newPoints.set(
-            i, 
-            origPnt.x + newPnt.x - basePnt.x,
-            origPnt.y + newPnt.y - basePnt.y,
-            origPnt.z + newPnt.z - basePnt.z
+        ProfileScope kernelScope("mirrorPoints");
+        mirrorPoints(
+            PointBuffer(originalPoints.data(), 4), 
+            PointBuffer(basePoints.data(), 4), 
+            symmetry.data(), 
+            numberOfVertices, 
+            this->mirrorPlane, 
+            newPoints.data()
         );
     }
 
-    itTargetGeo.setAllPositions(newPoints, MSpace::kObject);
+    blendVertexPoints(originalPoints, weights, newPoints);
+    setVertexPoints(fnTargetMesh, vertices, newPoints.data(), 4, MSpace::kObject);
+
+    this->pointDeltas[targetIndex].recordRows(vertices.data(), originalPoints.data(), newPoints.data(), numberOfVertices, 3, 4);
 
     return MStatus::kSuccess;
 }
 
 MStatus PolyMirrorCommand::undoIt()
 {   
-    MFnMesh fnMesh(this->targetMesh);
-    fnMesh.setPoints(originalPoints, MSpace::kObject);
+    for (size_t t = 0; t < this->pointDeltas.size(); t++)
+    {
+        MFnMesh fnMesh(this->targetMeshes[(unsigned) t]);
+        restoreVertexPoints(fnMesh, this->pointDeltas[t], MSpace::kObject);
+    }
 
     return MStatus::kSuccess;
-}
+}
\ No newline at end of file
@@ -6,9 +6,18 @@
 #ifndef POLY_MIRROR_COMMAND_H
 #define POLY_MIRROR_COMMAND_H
 
+#include "pointKernels.h"
+#include "symmetryTables.h"
+#include "undoDelta.h"
+
+#include <memory>
+#include <vector>
+
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MFloatPointArray.h>
 #include <maya/MPoint.h>
 #include <maya/MPointArray.h>
 #include <maya/MPxCommand.h>
@@ -16,6 +25,8 @@
 #include <maya/MStatus.h>
 #include <maya/MSyntax.h>
 
+using namespace std;
+
 class PolyMirrorCommand : public MPxCommand
 {
 public:
@@ -29,6 +40,8 @@ public:
     virtual MStatus     redoIt();
     virtual MStatus     undoIt();
 
+    virtual MStatus     mirrorSelectedVertices(unsigned targetIndex, const SymmetryTables &tables);
+
     virtual bool        isUndoable() const { return true; }
     virtual bool        hasSyntax()  const { return true; }
 
@@ -36,10 +49,16 @@ public:
     static MString      COMMAND_NAME;
 
 private:    
-    MPointArray         originalPoints;
-    MObject             polySymmetryData;
-
     MDagPath            baseMesh;
-    MDagPath            targetMesh;
+    MDagPathArray       targetMeshes;
+
+    MirrorPlane         mirrorPlane;
+
+    vector<shared_ptr<const SymmetryTables>> symmetryTables;
+    vector<bool>        isTargetCompatible;
+    vector<vector<int>> selectedVertices;
+    vector<vector<float>> selectedWeights;
+
+    vector<RowDelta<float>> pointDeltas;
 };
 #endif 
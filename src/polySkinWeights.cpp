@@ -5,7 +5,7 @@
  
 #include <algorithm>
 #include <iostream>
-#include <regex>
+#include <memory>
 #include <stdio.h>
 #include <sstream>
 #include <string>
@@ -15,8 +15,11 @@
 #include "parseArgs.h"
 #include "polySkinWeights.h"
 #include "polySymmetryNode.h"
+#include "profiling.h"
 #include "sceneCache.h"
 #include "selection.h"
+#include "weightRemap.h"
+#include "wildcard.h"
 
 #include "../pystring/pystring.h"
 
@@ -25,6 +28,7 @@
 #include <maya/MDagPath.h>
 #include <maya/MDagPathArray.h>
 #include <maya/MDoubleArray.h>
+#include <maya/MFnDependencyNode.h>
 #include <maya/MFnMesh.h>
 #include <maya/MFnSkinCluster.h>
 #include <maya/MFnNumericData.h>
@@ -84,6 +88,10 @@ using namespace std;
 #define FLIP_FLAG                       "-f"
 #define FLIP_LONG_FLAG                  "-flip"
 
+// Indicates that only nonzero weights should be read, and only changed weights written.
+#define SPARSE_FLAG                     "-sp"
+#define SPARSE_LONG_FLAG                "-sparse"
+
 #define CENTER_SIDE 0
 #define LEFT_SIDE 1
 #define RIGHT_SIDE 2
@@ -96,10 +104,9 @@ PolySkinWeightsCommand::PolySkinWeightsCommand() {}
 PolySkinWeightsCommand::~PolySkinWeightsCommand()
 {
     influenceSymmetry.clear();
-    oldWeights.clear();
-    newWeights.clear();
+    sourceInfluenceColumns.clear();
 
-    oldWeightValues.setLength(0);
+    weightDelta.clear();
 }
 
 void* PolySkinWeightsCommand::creator()
@@ -128,6 +135,7 @@ MSyntax PolySkinWeightsCommand::getSyntax()
     syntax.addFlag(FLIP_FLAG, FLIP_LONG_FLAG);
     syntax.addFlag(MIRROR_FLAG, MIRROR_LONG_FLAG);
     syntax.addFlag(NORMALIZE_FLAG, NORMALIZE_LONG_FLAG);    
+    syntax.addFlag(SPARSE_FLAG, SPARSE_LONG_FLAG);
 
     syntax.enableQuery(true);
     syntax.enableEdit(true);
@@ -163,6 +171,7 @@ MStatus PolySkinWeightsCommand::parseArguments(MArgDatabase &argsData)
     this->mirrorWeights = argsData.isFlagSet(MIRROR_FLAG);
     this->flipWeights = argsData.isFlagSet(FLIP_FLAG);
     this->normalizeWeights = argsData.isFlagSet(NORMALIZE_FLAG);
+    this->sparseWeights = argsData.isFlagSet(SPARSE_FLAG);
 
     return MStatus::kSuccess;
 }
@@ -346,9 +355,7 @@ MStatus PolySkinWeightsCommand::validateArguments()
     // Source/destination mesh must have polySymmetryData cached if the weights are going to be mirrored or flipped.
     if (mirrorWeights || flipWeights)
     {
-        bool cacheHit = PolySymmetryCache::getNodeFromCache(this->sourceMesh, this->polySymmetryData);
-
-        if (!cacheHit)
+        if (!PolySymmetryCache::getSymmetryTables(this->sourceMesh, this->symmetryTables))
         {
             MString errorMsg("Mesh specified with the ^1s/^2s flag must have an associated ^3s node.");
             errorMsg.format(errorMsg, MString(SOURCE_MESH_LONG_FLAG), MString(SOURCE_MESH_FLAG), PolySymmetryNode::NODE_NAME);
@@ -391,12 +398,9 @@ MStatus PolySkinWeightsCommand::validateArguments()
         itGeo.next();
     }
 
-    if (!selectedVertices.isNull() && !polySymmetryData.isNull())
+    if (!selectedVertices.isNull() && this->symmetryTables != nullptr)
     {
-        vector<int> vertexSymmetry;
-
-        MFnDependencyNode fnNode(this->polySymmetryData);
-        PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
+        const vector<int> &vertexSymmetry = this->symmetryTables->vertexSymmetry;
 
         for (uint i = 0; i < numSelectedVertices; i++)
         {
@@ -579,6 +583,9 @@ bool PolySkinWeightsCommand::isDeformedBy(MObject &skin, MDagPath &mesh)
 MStatus PolySkinWeightsCommand::doIt(const MArgList& argList)
 {
     MStatus status;
+
+    ProfileScope profileScope("polySkinWeights");
+
     MArgDatabase argsData(syntax(), argList, &status);
     RETURN_IF_ERROR(status);
 
@@ -640,24 +647,12 @@ MStatus PolySkinWeightsCommand::queryPolySkinWeights()
 
     this->makeInfluenceSymmetryTable(influences, influenceKeys, jointLabels);
 
-    MStringArray results;
-
-    unordered_map<string, MDagPath> influencesMap;
-
-    for (uint i = 0; i < numberOfInfluences; i++)
-    {
-        influencesMap.emplace(influenceKeys[i], influences[i]);
-    }
-
     for (uint i = 0; i < numberOfInfluences; i++)
     {
         MString pair("^1s:^2s");
 
-        string lhsKey = influenceKeys[i];
-        string rhsKey = influenceSymmetry[lhsKey];
-
-        MString lhs = influencesMap[lhsKey].partialPathName();
-        MString rhs = influencesMap[rhsKey].partialPathName();
+        MString lhs = influences[i].partialPathName();
+        MString rhs = influences[influenceSymmetry[i]].partialPathName();
 
         pair.format(pair, lhs, rhs);
         
@@ -756,54 +751,100 @@ MStatus PolySkinWeightsCommand::copyPolySkinWeights()
     getJointLabels(destinationInfluences, destinationInfluenceKeys, jointLabels);
 
     this->makeInfluenceSymmetryTable(destinationInfluences, destinationInfluenceKeys, jointLabels);    
-    this->setupWeightTables(sourceInfluenceKeys);
+    this->makeSourceInfluenceColumns(sourceInfluenceKeys, destinationInfluenceKeys);
 
-    if (!destinationIsSource)
+    this->numberOfSourceInfluences = numSourceInfluences;
+    this->numberOfDestinationInfluences = numDestinationInfluences;
+
+    if (this->sparseWeights)
     {
-        this->setupWeightTables(destinationInfluenceKeys);
+        return this->copySparseSkinWeights(fnSourceSkin, sourceInfluences, fnDestinationSkin, destinationInfluences);
     }
 
-    status = fnSourceSkin.getWeights(
-        sourceMesh, 
-        sourceComponents, 
-        sourceInfluenceIndices,
-        sourceWeights
-    );
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    if (destinationIsSource)
     {
-        destinationWeights.copy(sourceWeights);
-    } else {
-        status = fnDestinationSkin.getWeights(
-            destinationMesh, 
-            destinationComponents, 
-            destinationInfluenceIndices, 
-            destinationWeights
+        ProfileScope readScope("getWeights");
+
+        status = fnSourceSkin.getWeights(
+            sourceMesh, 
+            sourceComponents, 
+            sourceInfluenceIndices,
+            sourceWeights
         );
         CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (!destinationIsSource)
+        {
+            status = fnDestinationSkin.getWeights(
+                destinationMesh, 
+                destinationComponents, 
+                destinationInfluenceIndices, 
+                destinationWeights
+            );
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+        }
+
+        readScope.countAllocation(((size_t) sourceWeights.length() + destinationWeights.length()) * sizeof(double));
     }
 
-    this->setWeightsTable(this->oldWeights, sourceWeights, sourceInfluenceKeys);
+    // The current weights stay untouched, since the new rows are packed on their own.
+    const MDoubleArray &currentWeights = destinationIsSource ? sourceWeights : destinationWeights;
+
+    int ni = (int) numDestinationInfluences;
+
+    if (nv == 0 || ni == 0 || selectedVertexIndices.empty()) { return MStatus::kSuccess; }
+
+    MDoubleArray remappedWeights;
 
-    if (flipWeights)
     {
-        this->flipWeightsTable(destinationInfluenceKeys);
-    } else if (mirrorWeights) {
-        this->mirrorWeightsTable(destinationInfluenceKeys);
-    } else {
-        this->copyWeightsTable(destinationInfluenceKeys);
+        ProfileScope remapScope("remapWeights");
+        this->remapWeightsTable(sourceWeights, remappedWeights);
     }
-    
-    this->getWeightsTable(this->newWeights, destinationWeights, destinationInfluenceKeys);
+
+    // Only rows that changed are written, and only their old values are kept for undo.
+    // Rows are visited in vertex order, which the undo record needs.
+    vector<int> selectedRows(selectedVertexIndices.size());
+
+    for (size_t k = 0; k < selectedRows.size(); k++) { selectedRows[k] = (int) k; }
+
+    sort(selectedRows.begin(), selectedRows.end(), [&](int a, int b) { return selectedVertexIndices[a] < selectedVertexIndices[b]; });
+
+    vector<int> changedVertices;
+    vector<double> changedOldWeights;
+
+    MDoubleArray changedWeights((unsigned) (selectedRows.size() * ni));
+    unsigned numberOfChangedWeights = 0;
+
+    for (int &k : selectedRows)
+    {
+        int v = selectedVertexIndices[k];
+
+        const double* oldRow = &currentWeights[(unsigned) ((size_t) v * ni)];
+        const double* newRow = &remappedWeights[(unsigned) ((size_t) k * ni)];
+
+        if (equal(oldRow, oldRow + ni, newRow)) { continue; }
+
+        changedVertices.push_back(v);
+        changedOldWeights.insert(changedOldWeights.end(), oldRow, oldRow + ni);
+
+        for (int j = 0; j < ni; j++) { changedWeights[numberOfChangedWeights++] = newRow[j]; }
+    }
+
+    this->weightDelta.assign(changedVertices, changedOldWeights, ni);
+
+    if (this->weightDelta.empty()) { return MStatus::kSuccess; }
+
+    changedWeights.setLength(numberOfChangedWeights);
+
+    getVertexComponents(changedVertices, this->destinationComponents);
+
+    ProfileScope writeScope("setWeights");
 
     status = fnDestinationSkin.setWeights(
         this->destinationMesh,
         this->destinationComponents,
         destinationInfluenceIndices,
-        destinationWeights,
-        this->normalizeWeights,
-        &this->oldWeightValues
+        changedWeights,
+        this->normalizeWeights
     );
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
@@ -893,7 +934,27 @@ MStatus PolySkinWeightsCommand::makeInfluencesMatch(MFnSkinCluster &fnSourceSkin
 }
 
 
-/* Constructs an influence->influence symmetry map. */
+/* Returns the key under which influences with matching labels are bucketed. */
+static string getJointLabelKey(const JointLabel &label)
+{
+    string key = to_string(label.type);
+
+    if (label.type == OTHER_TYPE)
+    {
+        key += ":";
+        key += label.otherType.asChar();
+    }
+
+    return key;
+}
+
+
+/* 
+    Constructs an influence->influence symmetry map, indexed by the position 
+    of the influence in `influences`. Left and right influences are bucketed 
+    by label, and each one is paired with the first influence on the other 
+    side of its bucket.
+*/
 MStatus PolySkinWeightsCommand::makeInfluenceSymmetryTable(
     MDagPathArray &influences, 
     vector<string> &influenceKeys,
@@ -903,108 +964,73 @@ MStatus PolySkinWeightsCommand::makeInfluenceSymmetryTable(
 
     uint numberOfInfluences = influences.length();
 
-    for (string key : influenceKeys)
-    {
-        this->influenceSymmetry.emplace(key, key);
-    }
+    this->influenceSymmetry.resize(numberOfInfluences);
+
+    vector<int> sides(numberOfInfluences);
+    vector<string> labelKeys(numberOfInfluences);
+
+    // first: the first left influence with a given label, second: the first right influence.
+    unordered_map<string, pair<int, int>> firstInfluences;
+    firstInfluences.reserve(numberOfInfluences);
 
     for (uint i = 0; i < numberOfInfluences; i++)
     {
-        string thisInfluence = influenceKeys[i];
-        JointLabel thisLabel = jointLabels[thisInfluence];
+        this->influenceSymmetry[i] = (int) i;
 
-        for (uint j = 0; j < numberOfInfluences; j++)
-        {
-            bool isTaggedCenter = thisLabel.side == CENTER_SIDE || thisLabel.side == NONE_SIDE;
+        JointLabel &label = jointLabels[influenceKeys[i]];
+        sides[i] = label.side;
 
-            if ((i == j) && isTaggedCenter)
-            {
-                this->influenceSymmetry[thisInfluence] = thisInfluence;
-                break;
-            } else if (i == j) {
-                continue;
-            }
+        if (label.side != LEFT_SIDE && label.side != RIGHT_SIDE) { continue; }
 
-            string otherInfluence = influenceKeys[j];
-            JointLabel otherLabel = jointLabels[otherInfluence];
+        labelKeys[i] = getJointLabelKey(label);
 
-            bool leftToRight = (thisLabel.side == LEFT_SIDE && otherLabel.side == RIGHT_SIDE);
-            bool rightToLeft = (thisLabel.side == RIGHT_SIDE && otherLabel.side == LEFT_SIDE);
+        pair<int, int> &first = firstInfluences.emplace(labelKeys[i], make_pair(-1, -1)).first->second;
+        int &firstOnThisSide = label.side == LEFT_SIDE ? first.first : first.second;
 
-            if (leftToRight || rightToLeft)
-            {                
-                if (thisLabel.type == OTHER_TYPE && otherLabel.type == OTHER_TYPE)
-                {
-                    if (thisLabel.otherType == otherLabel.otherType)
-                    {
-                        this->influenceSymmetry[thisInfluence] = otherInfluence;
-                        break;
-                    }
-                } else if (thisLabel.type == otherLabel.type) {
-                    this->influenceSymmetry[thisInfluence] = otherInfluence;
-                    break;
-                }
-            }
+        if (firstOnThisSide == -1) 
+        { 
+            firstOnThisSide = (int) i; 
         }
     }
 
-    return MStatus::kSuccess;
-}
-
-
-/* Constructs a pair of maps (influence->weights) from the influences of the desination skin cluster. */
-void PolySkinWeightsCommand::setupWeightTables(vector<string> &influenceKeys) 
-{
-    for (string ii : influenceKeys)
+    for (uint i = 0; i < numberOfInfluences; i++)
     {
-        if (oldWeights.find(ii) == oldWeights.end())
-        {
-            oldWeights.emplace(ii, vector<double>(this->numberOfVertices));
-        }
+        if (sides[i] != LEFT_SIDE && sides[i] != RIGHT_SIDE) { continue; }
 
-        if (newWeights.find(ii) == newWeights.end())
+        const pair<int, int> &first = firstInfluences[labelKeys[i]];
+        int otherInfluence = sides[i] == LEFT_SIDE ? first.second : first.first;
+
+        if (otherInfluence != -1)
         {
-            newWeights.emplace(ii, vector<double>(this->numberOfVertices));
+            this->influenceSymmetry[i] = otherInfluence;
         }
     }
+
+    return MStatus::kSuccess;
 }
 
 
-/* Copies the weights from the weight array to the weight table. */
-void PolySkinWeightsCommand::setWeightsTable(unordered_map<string, vector<double>> &weightTable, MDoubleArray &weights, vector<string> &influenceKeys)
+/* 
+    Maps each destination influence to its column in the source weights, or -1 
+    if the source skin cluster does not have it. This is the only place the 
+    influences are matched by name.
+*/
+void PolySkinWeightsCommand::makeSourceInfluenceColumns(vector<string> &sourceInfluenceKeys, vector<string> &destinationInfluenceKeys)
 {
-    uint numberOfInfluences = (uint) influenceKeys.size();
-    
-    for (uint j = 0; j < numberOfInfluences; j++)
-    {
-        vector<double> &weightList = oldWeights[influenceKeys[j]];
+    unordered_map<string, int> sourceColumns;
+    sourceColumns.reserve(sourceInfluenceKeys.size());
 
-        for (uint i = 0; i < this->numberOfVertices; i++)
-        {
-            uint wi = (i * numberOfInfluences) + j;
-            weightList[i] = weights[wi];
-        }
+    for (size_t i = 0; i < sourceInfluenceKeys.size(); i++)
+    {
+        sourceColumns.emplace(sourceInfluenceKeys[i], (int) i);
     }
-}
 
-/* Copies the weights from the weight table to the weight array. */
-void PolySkinWeightsCommand::getWeightsTable(unordered_map<string, vector<double>> &weightTable, MDoubleArray &weights, vector<string> &influenceKeys)
-{
-    uint numberOfInfluences = (uint) influenceKeys.size();
-
-    weights.setLength(this->numberOfVertices * numberOfInfluences);
+    this->sourceInfluenceColumns.resize(destinationInfluenceKeys.size());
 
-    for (uint j = 0; j < numberOfInfluences; j++)
+    for (size_t j = 0; j < destinationInfluenceKeys.size(); j++)
     {
-        vector<double> &weightList = weightTable[influenceKeys[j]];
-
-        for (int &i : selectedVertexIndices)
-        {            
-            uint wi = (i * numberOfInfluences) + j;            
-            double wt = weightList[i];
-
-            weights.set(wt, wi);
-        }
+        auto got = sourceColumns.find(destinationInfluenceKeys[j]);
+        this->sourceInfluenceColumns[j] = got == sourceColumns.end() ? -1 : got->second;
     }
 }
 
@@ -1052,81 +1078,239 @@ MStatus PolySkinWeightsCommand::getInfluenceKeys(MFnSkinCluster &fnSkin, vector<
     return MStatus::kSuccess;
 }
 
-/* Copy the weights from the old weights table to the new weights table */
-void PolySkinWeightsCommand::copyWeightsTable(vector<string> &influenceKeys)
+/* Maps each destination influence to the source column of its opposite influence. */
+void PolySkinWeightsCommand::getOppositeInfluenceColumns(vector<int> &oppositeColumns)
 {
-    for (string &ii : influenceKeys)
-    {
-        vector<double> &newWeightsList = newWeights[ii];
-        vector<double> &oldWeightsList = oldWeights[ii];
+    oppositeColumns.resize(sourceInfluenceColumns.size());
 
-        for (uint i = 0; i < numberOfVertices; i++)
-        {
-            newWeightsList[i] = oldWeightsList[i];
-        }
+    for (size_t j = 0; j < sourceInfluenceColumns.size(); j++)
+    {
+        oppositeColumns[j] = sourceInfluenceColumns[influenceSymmetry[j]];
     }
 }
 
 
-/* Copy the weights from the old weights table indices to the opposite indices in the new weights table. */
-void PolySkinWeightsCommand::flipWeightsTable(vector<string> &influenceKeys)
+/* 
+    Copies, flips, or mirrors the source weights of each selected vertex into 
+    `remappedWeights`, whose k-th row holds the new weights of the k-th 
+    selected vertex.
+
+    Both arrays hold one row of weights per vertex, with one column per influence 
+    of their skin cluster. Destination columns are looked up in the source through 
+    `sourceInfluenceColumns`; influences the source does not have get no weight.
+*/
+void PolySkinWeightsCommand::remapWeightsTable(MDoubleArray &sourceWeights, MDoubleArray &remappedWeights)
 {
-    vector<int> vertexSymmetry;
+    if (selectedVertexIndices.empty()) { return; }
 
-    MFnDependencyNode fnNode(this->polySymmetryData);
-    PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
+    vector<int> sourceVertices;
+    vector<char> useOpposite;
 
-    for (string &ii : influenceKeys)
-    {        
-        string &oi = influenceSymmetry[ii];
+    this->getRemapSources(sourceVertices, useOpposite);
 
-        vector<double> &newWeightsList = newWeights[ii];
-        vector<double> &oldWeightsList = oldWeights[oi];
+    vector<int> oppositeColumns;
+    this->getOppositeInfluenceColumns(oppositeColumns);
 
-        for (int &i : selectedVertexIndices)
-        {
-            int &o = vertexSymmetry[i];
+    vector<int> rows(selectedVertexIndices.size());
 
-            newWeightsList[i] = oldWeightsList[o];
-            newWeightsList[o] = oldWeightsList[i];
-        }
+    for (size_t k = 0; k < rows.size(); k++) { rows[k] = (int) k; }
+
+    remappedWeights.setLength((unsigned) (rows.size() * numberOfDestinationInfluences));
+
+    remapWeightRows(
+        &sourceWeights[0], 
+        (int) numberOfSourceInfluences,
+        &remappedWeights[0],
+        (int) numberOfDestinationInfluences,
+        rows,
+        sourceVertices,
+        useOpposite,
+        sourceInfluenceColumns,
+        oppositeColumns
+    );
+}
+
+
+/* Returns the vertex each selected vertex takes its weights from, and whether its influences are flipped. */
+void PolySkinWeightsCommand::getRemapSources(vector<int> &sourceVertices, vector<char> &useOpposite)
+{
+    if (flipWeights || mirrorWeights)
+    {
+        ::getRemapSources(
+            selectedVertexIndices, 
+            this->symmetryTables->vertexSymmetry, 
+            this->symmetryTables->vertexSides, 
+            flipWeights, 
+            mirrorWeights, 
+            direction, 
+            sourceVertices, 
+            useOpposite
+        );
+    } else {
+        sourceVertices = selectedVertexIndices;
+        useOpposite.assign(selectedVertexIndices.size(), 0);
+    }
+}
+
+
+/* 
+    Does the copy, flip, or mirror on the nonzero weights of the selected vertices only. 
+    The weights are read from the weightList plugs of the skin clusters, and only the 
+    weights that change are written back.
+*/
+MStatus PolySkinWeightsCommand::copySparseSkinWeights(
+    MFnSkinCluster &fnSourceSkin, 
+    MDagPathArray &sourceInfluences,
+    MFnSkinCluster &fnDestinationSkin,
+    MDagPathArray &destinationInfluences
+) {
+    MStatus status;
+
+    size_t numberOfRows = selectedVertexIndices.size();
+
+    vector<int> sourceVertices;
+    vector<char> useOpposite;
+
+    this->getRemapSources(sourceVertices, useOpposite);
+
+    vector<int> oppositeColumns;
+    this->getOppositeInfluenceColumns(oppositeColumns);
+
+    AdjacencyTable targets;
+    AdjacencyTable oppositeTargets;
+
+    makeColumnTargets(sourceInfluenceColumns, (int) numberOfSourceInfluences, targets);
+    makeColumnTargets(oppositeColumns, (int) numberOfSourceInfluences, oppositeTargets);
+
+    SparseWeights sourceWeights;
+    SparseWeights oldWeights;
+    SparseWeights newWeights;
+
+    status = this->getSparseWeights(fnSourceSkin, sourceInfluences, sourceVertices, sourceWeights);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = this->getSparseWeights(fnDestinationSkin, destinationInfluences, selectedVertexIndices, oldWeights);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    vector<int> sourceRows(numberOfRows);
+
+    for (size_t r = 0; r < numberOfRows; r++) 
+    { 
+        sourceRows[r] = (int) r; 
+    }
+
+    {
+        ProfileScope remapScope("remapWeights");
+
+        remapSparseWeights(sourceWeights, sourceRows, useOpposite, targets, oppositeTargets, normalizeWeights, newWeights);
+        diffSparseWeights(oldWeights, newWeights, this->weightChanges);
     }
+
+    this->destinationLogicalIndices.resize(numberOfDestinationInfluences);
+
+    for (uint j = 0; j < numberOfDestinationInfluences; j++)
+    {
+        this->destinationLogicalIndices[j] = (int) fnDestinationSkin.indexForInfluenceObject(destinationInfluences[j], &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+
+    return this->setSparseWeights(false);
 }
 
 
-/* Copy the weights from the old weights table indices to the same and opposite indices in the new weights table. */
-void PolySkinWeightsCommand::mirrorWeightsTable(vector<string> &influenceKeys)
+/* Reads the nonzero weights of `vertices` into one row per vertex, with influences given by their position in `influences`. */
+MStatus PolySkinWeightsCommand::getSparseWeights(MFnSkinCluster &fnSkin, MDagPathArray &influences, vector<int> &vertices, SparseWeights &weights)
 {
-    vector<int> vertexSymmetry;
-    vector<int> vertexSides;
+    MStatus status;
 
-    MFnDependencyNode fnNode(this->polySymmetryData);
-    PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, vertexSymmetry);
-    PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, vertexSides);
+    ProfileScope profileScope("getWeights");
 
-    vector<int> leftVertexMasks(numberOfVertices);
-    vector<int> rightVertexMasks(numberOfVertices);
+    unordered_map<unsigned int, int> physicalIndices;
+    physicalIndices.reserve(influences.length());
 
-    for (int &i : selectedVertexIndices)
+    for (uint j = 0; j < influences.length(); j++)
     {
-        leftVertexMasks[i] = (vertexSides[i] == CENTER_SIDE) | (vertexSides[i] == direction);
-        rightVertexMasks[i] = 1 - leftVertexMasks[i];
+        unsigned int logicalIndex = fnSkin.indexForInfluenceObject(influences[j], &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        physicalIndices.emplace(logicalIndex, (int) j);
     }
-    
-    for (string &ii : influenceKeys)
+
+    MPlug weightListPlug = fnSkin.findPlug("weightList", false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MIntArray logicalIndices;
+    vector<pair<int, double>> row;
+
+    weights.clear();
+    weights.offsets.reserve(vertices.size() + 1);
+
+    for (int &v : vertices)
     {
-        string &oi = influenceSymmetry[ii];
+        MPlug weightsPlug = weightListPlug.elementByLogicalIndex(v, &status).child(0, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        weightsPlug.getExistingArrayAttributeIndices(logicalIndices, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        row.clear();
+
+        for (uint k = 0; k < logicalIndices.length(); k++)
+        {
+            auto got = physicalIndices.find((unsigned int) logicalIndices[k]);
+
+            if (got == physicalIndices.end()) { continue; }
+
+            double w = weightsPlug.elementByLogicalIndex(logicalIndices[k], &status).asDouble();
 
-        vector<double> &newInfluenceWeights = newWeights[ii];
-        vector<double> &oldInfluenceAWeights = oldWeights[ii];
-        vector<double> &oldInfluenceBWeights = oldWeights[oi];
+            if (w != 0.0) 
+            { 
+                row.push_back(make_pair(got->second, w)); 
+            }
+        }
 
-        for (int &i : selectedVertexIndices)
-        {                
-            int &o = vertexSymmetry[i];       
-            newInfluenceWeights[i] = (leftVertexMasks[i] * oldInfluenceAWeights[i]) + (rightVertexMasks[i] * oldInfluenceBWeights[o]);
+        sort(row.begin(), row.end());
+
+        for (auto &w : row)
+        {
+            weights.influences.push_back(w.first);
+            weights.weights.push_back(w.second);
         }
+
+        weights.offsets.push_back((int) weights.influences.size());
+    }
+
+    profileScope.countAllocation(weights.offsets.size() * sizeof(int) + weights.influences.size() * (sizeof(int) + sizeof(double)));
+
+    return MStatus::kSuccess;
+}
+
+
+/* Writes the new (or, when undoing, old) value of every weight in `weightChanges` to the destination skin cluster. */
+MStatus PolySkinWeightsCommand::setSparseWeights(bool useOldWeights)
+{
+    MStatus status;
+
+    ProfileScope profileScope("setWeights");
+
+    MFnDependencyNode fnSkin(this->destinationSkin);
+
+    MPlug weightListPlug = fnSkin.findPlug("weightList", false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    for (WeightChange &change : this->weightChanges)
+    {
+        int v = selectedVertexIndices[change.row];
+        int l = destinationLogicalIndices[change.influence];
+
+        MPlug weightPlug = weightListPlug.elementByLogicalIndex(v).child(0).elementByLogicalIndex(l, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        status = weightPlug.setValue(useOldWeights ? change.oldWeight : change.newWeight);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+
+    return MStatus::kSuccess;
 }
 
 
@@ -1137,14 +1321,10 @@ void PolySkinWeightsCommand::getJointLabels(MDagPathArray &influences, vector<st
 
     if (this->isInfluenceSymmetryFlagSet)
     {
-        string wildcard = string("*");
-        string regexAny = string("(.*)");
+        WildcardPattern leftPattern(leftInfluencePattern);
+        WildcardPattern rightPattern(rightInfluencePattern);
 
-        string leftRegexPattern = pystring::replace(leftInfluencePattern, wildcard, regexAny);
-        string rightRegexPattern = pystring::replace(rightInfluencePattern, wildcard, regexAny);
-
-        regex leftRegex(leftRegexPattern);
-        regex rightRegex(rightRegexPattern);
+        string captured;
 
         for (uint i = 0; i < numberOfInfluences; i++)
         {
@@ -1153,34 +1333,12 @@ void PolySkinWeightsCommand::getJointLabels(MDagPathArray &influences, vector<st
 
             JointLabel newJointLabel;
 
-            smatch leftMatches;
-            smatch rightMatches;
-
-            bool isLeft = regex_match(influenceName, leftMatches, leftRegex);
-            bool isRight = regex_match(influenceName, rightMatches, rightRegex);
-
-            if (isLeft) 
+            if (leftPattern.match(influenceName, captured)) 
             {                
-                stringstream ss;
-
-                for (int i = 1; i < leftMatches.size(); i++) 
-                { 
-                    ss << leftMatches[i].str(); 
-                }
-
-                influenceName = ss.str();
-
+                influenceName = captured;
                 newJointLabel.side = LEFT_SIDE;
-            } else if (isRight) {
-                stringstream ss;
-                
-                for (int i = 1; i < rightMatches.size(); i++) 
-                { 
-                    ss << rightMatches[i].str(); 
-                }
-
-                influenceName = ss.str();
-
+            } else if (rightPattern.match(influenceName, captured)) {
+                influenceName = captured;
                 newJointLabel.side = RIGHT_SIDE;            
             } else {
                 newJointLabel.side = CENTER_SIDE;
@@ -1280,20 +1438,37 @@ MStatus PolySkinWeightsCommand::undoCopyPolySkinWeights()
 {
     MStatus status;
 
-    MFnSkinCluster fnSkin(this->destinationSkin);
+    if (this->sparseWeights)
+    {
+        status = this->setSparseWeights(true);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        status = dgModifier.undoIt();
+        CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    MIntArray influenceIndices;    
-    this->getInfluenceIndices(fnSkin, influenceIndices);
+        return MStatus::kSuccess;
+    }
 
-    status = fnSkin.setWeights(
-        this->destinationMesh,
-        this->destinationComponents,
-        influenceIndices,
-        this->oldWeightValues,
-        true
-    );
+    if (!this->weightDelta.empty())
+    {
+        MFnSkinCluster fnSkin(this->destinationSkin);
 
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+        MIntArray influenceIndices;    
+        this->getInfluenceIndices(fnSkin, influenceIndices);
+
+        const vector<double> &oldValues = this->weightDelta.getOldValues();
+        MDoubleArray oldWeightValues(oldValues.data(), (unsigned) oldValues.size());
+
+        status = fnSkin.setWeights(
+            this->destinationMesh,
+            this->destinationComponents,
+            influenceIndices,
+            oldWeightValues,
+            true
+        );
+
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
     status = dgModifier.undoIt();
 
@@ -6,7 +6,12 @@
 #ifndef POLY_SKIN_WEIGHTS_H
 #define POLY_SKIN_WEIGHTS_H
 
+#include "symmetryTables.h"
+#include "undoDelta.h"
+#include "weightRemap.h"
+
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,6 +19,7 @@
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MDGModifier.h>
 #include <maya/MDoubleArray.h>
 #include <maya/MFloatArray.h>
@@ -68,16 +74,17 @@ public:
     virtual MStatus     undoCopyPolySkinWeights();
     virtual MStatus     undoEditPolySkinWeights();
 
-    virtual void        copyWeightsTable(vector<string> &influenceKeys);
-    virtual void        flipWeightsTable(vector<string> &influenceKeys);
-    virtual void        mirrorWeightsTable(vector<string> &influenceKeys);
+    virtual void        remapWeightsTable(MDoubleArray &sourceWeights, MDoubleArray &remappedWeights);
+    virtual void        getRemapSources(vector<int> &sourceVertices, vector<char> &useOpposite);
 
     virtual MStatus     makeInfluencesMatch(MFnSkinCluster &fnSourceSkin, MFnSkinCluster &fnDestinationSkin);
     virtual MStatus     makeInfluenceSymmetryTable(MDagPathArray &influences, vector<string> &influenceKeys, unordered_map<string, JointLabel> &jointLabels);
-    
-    virtual void        setupWeightTables(vector<string> &influenceKeys);
-    virtual void        setWeightsTable(unordered_map<string, vector<double>> &weightTable, MDoubleArray &weights, vector<string> &influenceKeys);
-    virtual void        getWeightsTable(unordered_map<string, vector<double>> &weightTable, MDoubleArray &weights, vector<string> &influenceKeys);
+    virtual void        makeSourceInfluenceColumns(vector<string> &sourceInfluenceKeys, vector<string> &destinationInfluenceKeys);
+    virtual void        getOppositeInfluenceColumns(vector<int> &oppositeColumns);
+
+    virtual MStatus     copySparseSkinWeights(MFnSkinCluster &fnSourceSkin, MDagPathArray &sourceInfluences, MFnSkinCluster &fnDestinationSkin, MDagPathArray &destinationInfluences);
+    virtual MStatus     getSparseWeights(MFnSkinCluster &fnSkin, MDagPathArray &influences, vector<int> &vertices, SparseWeights &weights);
+    virtual MStatus     setSparseWeights(bool useOldWeights);
 
     virtual MStatus     getInfluenceIndices(MFnSkinCluster &fnSkin, MIntArray &influenceIndices);
     virtual MStatus     getInfluenceKeys(MFnSkinCluster &fnSkin, vector<string> &influenceKeys);
@@ -98,6 +105,7 @@ private:
     bool                normalizeWeights = false;
     bool                mirrorWeights = false;
     bool                flipWeights   = false;
+    bool                sparseWeights = false;
 
     bool                isQuery = false;
     bool                isEdit = false;
@@ -110,21 +118,27 @@ private:
     string              leftInfluencePattern;
     string              rightInfluencePattern;
     
-    unordered_map<string, string>         influenceSymmetry;
+    uint                numberOfSourceInfluences = 0;
+    uint                numberOfDestinationInfluences = 0;
+
+    vector<int>         influenceSymmetry;
+    vector<int>         sourceInfluenceColumns;
+    vector<int>         destinationLogicalIndices;
+
+    vector<WeightChange> weightChanges;
+
     unordered_map<string, JointLabel>     oldJointLabels;
-    unordered_map<string, vector<double>> oldWeights;
-    unordered_map<string, vector<double>> newWeights;
 
     vector<int>         selectedVertexIndices;
     
     MDGModifier         dgModifier;
-    MDoubleArray        oldWeightValues;
+    RowDelta<double>    weightDelta;
 
     MObject             sourceComponents;
     MDagPath            sourceMesh;
     MObject             sourceSkin;
 
-    MObject             polySymmetryData;
+    shared_ptr<const SymmetryTables> symmetryTables;
 
     MObject             destinationComponents;
     MDagPath            destinationMesh;
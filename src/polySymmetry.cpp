@@ -35,26 +35,24 @@ components on the shell can have their symmetry computed thus:
 
 // TODO - unintuitive results returned if the mesh does not have a center edge loop whose vertices are symmetrical to themselves.
 
-#include "meshData.h"
+#include "componentSelection.h"
+#include "meshTopology.h"
+#include "parallel.h"
 #include "polySymmetry.h"
-#include "selection.h"
 #include "util.h"
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <utility> 
 #include <vector>
 
-#include <maya/MDagPath.h>
-#include <maya/MFnMesh.h>
-
 using namespace std;
 
 
 PolySymmetryData::PolySymmetryData() 
 {
-    MeshData meshData = MeshData();
-
     examinedEdges = vector<bool>();
     examinedFaces = vector<bool>();
     examinedVertices = vector<bool>();
@@ -77,16 +75,16 @@ PolySymmetryData::~PolySymmetryData()
 }
 
 
-void PolySymmetryData::initialize(MDagPath &mesh) 
+void PolySymmetryData::initialize(const MeshTopology &meshData) 
 {
-    meshData.unpackMesh(mesh);
+    this->meshData = &meshData;
     this->reset();
 }
 
 
 void PolySymmetryData::clear()
 {
-    meshData.clear();
+    meshData = nullptr;
     this->reset();
 }
 
@@ -107,6 +105,10 @@ void PolySymmetryData::reset()
 
     leftSideVertexIndices.clear();
 
+    if (this->meshData == nullptr) { return; }
+
+    const MeshTopology &meshData = *this->meshData;
+
     examinedEdges.resize(meshData.numberOfEdges, false);
     examinedFaces.resize(meshData.numberOfFaces, false);
     examinedVertices.resize(meshData.numberOfVertices, false);
@@ -121,18 +123,156 @@ void PolySymmetryData::reset()
 }
 
 
-void PolySymmetryData::findSymmetricalVertices(ComponentSelection &selection)
+void PolySymmetryData::findSymmetricalVertices(ComponentSelection &selection, ShellSymmetry *result)
 {
-    queue<pair<int, int>> symmetricalEdgesQueue = queue<pair<int, int>>();
-    symmetricalEdgesQueue.push(selection.edgeIndices);
-
     if (selection.leftVertexIndex != -1) 
     {
         leftSideVertexIndices.push_back(selection.leftVertexIndex);
     }
 
+    ShellSolver solver(*meshData, *this, result);
+    solver.findSymmetricalVertices(selection);
+}
+
+
+/*
+    Solves each selection on its own thread, then merges the results in 
+    selection order. A shell whose assignments conflict with a shell merged 
+    before it is skipped and its index is added to `collidingShells`. 
+*/
+void PolySymmetryData::findSymmetricalShells(vector<ComponentSelection> &selections, vector<int> &collidingShells)
+{
+    const MeshTopology &meshData = *this->meshData;
+
+    int numberOfShells = (int) selections.size();
+    int numberOfThreads = min(getNumberOfThreads(), numberOfShells);
+
+    vector<ShellSymmetry> shells(numberOfShells);
+    vector<SymmetryState> scratch(numberOfThreads);
+
+    for (SymmetryState &s : scratch)
+    {
+        s.vertexSymmetryIndices.resize(meshData.numberOfVertices, -1);
+        s.edgeSymmetryIndices.resize(meshData.numberOfEdges, -1);
+        s.faceSymmetryIndices.resize(meshData.numberOfFaces, -1);
+
+        s.examinedVertices.resize(meshData.numberOfVertices, false);
+        s.examinedEdges.resize(meshData.numberOfEdges, false);
+        s.examinedFaces.resize(meshData.numberOfFaces, false);
+    }
+
+    parallelFor(numberOfShells, [&](int shellIndex, int threadIndex)
+    {
+        SymmetryState &s = scratch[threadIndex];
+        ShellSymmetry &shell = shells[shellIndex];
+
+        ShellSolver solver(meshData, s, &shell);
+        solver.findSymmetricalVertices(selections[shellIndex]);
+
+        // Undo only what this shell touched so the scratch can be reused.
+        for (pair<int, int> &p : shell.vertexPairs)
+        {
+            s.vertexSymmetryIndices[p.first] = s.vertexSymmetryIndices[p.second] = -1;
+            s.examinedVertices[p.first] = s.examinedVertices[p.second] = false;
+        }
+
+        for (pair<int, int> &p : shell.edgePairs)
+        {
+            s.edgeSymmetryIndices[p.first] = s.edgeSymmetryIndices[p.second] = -1;
+            s.examinedEdges[p.first] = s.examinedEdges[p.second] = false;
+        }
+
+        for (pair<int, int> &p : shell.facePairs)
+        {
+            s.faceSymmetryIndices[p.first] = s.faceSymmetryIndices[p.second] = -1;
+            s.examinedFaces[p.first] = s.examinedFaces[p.second] = false;
+        }
+    }, numberOfThreads);
+
+    for (int i = 0; i < numberOfShells; i++)
+    {
+        if (!canMergeShell(shells[i]))
+        {
+            collidingShells.push_back(i);
+            continue;
+        }
+
+        mergeShell(shells[i]);
+
+        if (selections[i].leftVertexIndex != -1) 
+        {
+            leftSideVertexIndices.push_back(selections[i].leftVertexIndex);
+        }
+    }
+}
+
+
+static bool canMergePairs(vector<pair<int, int>> &pairs, vector<int> &symmetryIndices)
+{
+    for (pair<int, int> &p : pairs)
+    {
+        int s0 = symmetryIndices[p.first];
+        int s1 = symmetryIndices[p.second];
+
+        if ((s0 != -1 && s0 != p.second) || (s1 != -1 && s1 != p.first))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool PolySymmetryData::canMergeShell(ShellSymmetry &shell)
+{
+    return canMergePairs(shell.vertexPairs, vertexSymmetryIndices)
+        && canMergePairs(shell.edgePairs, edgeSymmetryIndices)
+        && canMergePairs(shell.facePairs, faceSymmetryIndices);
+}
+
+
+void PolySymmetryData::mergeShell(ShellSymmetry &shell)
+{
+    for (pair<int, int> &p : shell.vertexPairs)
+    {
+        vertexSymmetryIndices[p.first] = p.second;
+        vertexSymmetryIndices[p.second] = p.first;
+        examinedVertices[p.first] = examinedVertices[p.second] = true;
+    }
+
+    for (pair<int, int> &p : shell.edgePairs)
+    {
+        edgeSymmetryIndices[p.first] = p.second;
+        edgeSymmetryIndices[p.second] = p.first;
+        examinedEdges[p.first] = examinedEdges[p.second] = true;
+    }
+
+    for (pair<int, int> &p : shell.facePairs)
+    {
+        faceSymmetryIndices[p.first] = p.second;
+        faceSymmetryIndices[p.second] = p.first;
+        examinedFaces[p.first] = examinedFaces[p.second] = true;
+    }
+}
+
+
+ShellSolver::ShellSolver(const MeshTopology &meshData, SymmetryState &state, ShellSymmetry *result) 
+    : meshData(meshData), state(state), result(result) 
+{}
+
+
+void ShellSolver::findSymmetricalVertices(ComponentSelection &selection)
+{
+    queue<pair<int, int>> symmetricalEdgesQueue = queue<pair<int, int>>();
+    symmetricalEdgesQueue.push(selection.edgeIndices);
+
     this->findFirstSymmetricalVertices(selection);
 
+    // The other edges of the seed faces are only reached from their neighbours
+    // otherwise, which misses the ones on a border.
+    this->findSymmetricalEdgesOnFace(symmetricalEdgesQueue, selection.faceIndices.first);
+
     while (!symmetricalEdgesQueue.empty())
     {
         pair<int, int> edgePair = symmetricalEdgesQueue.front();
@@ -155,20 +295,20 @@ void PolySymmetryData::findSymmetricalVertices(ComponentSelection &selection)
 }
 
 
-void PolySymmetryData::findFirstSymmetricalVertices(ComponentSelection &selection)
+void ShellSolver::findFirstSymmetricalVertices(ComponentSelection &selection)
 {
     markSymmetricalVertices(selection.vertexIndices.first, selection.vertexIndices.second);
     markSymmetricalFaces(selection.faceIndices.first, selection.faceIndices.second);
     
-    int vertex0 = meshData.edgeData[selection.edgeIndices.first].connectedVertices[0];
-    int vertex1 = meshData.edgeData[selection.edgeIndices.first].connectedVertices[1];
+    int vertex0 = meshData.edgeVertices[selection.edgeIndices.first][0];
+    int vertex1 = meshData.edgeVertices[selection.edgeIndices.first][1];
 
-    int nextVertex0 = examinedVertices[vertex0] ? vertex1 : vertex0;
+    int nextVertex0 = state.examinedVertices[vertex0] ? vertex1 : vertex0;
 
-    vertex0 = meshData.edgeData[selection.edgeIndices.second].connectedVertices[0];
-    vertex1 = meshData.edgeData[selection.edgeIndices.second].connectedVertices[1];
+    vertex0 = meshData.edgeVertices[selection.edgeIndices.second][0];
+    vertex1 = meshData.edgeVertices[selection.edgeIndices.second][1];
 
-    int nextVertex1 = examinedVertices[vertex0] ? vertex1 : vertex0;
+    int nextVertex1 = state.examinedVertices[vertex0] ? vertex1 : vertex0;
 
     markSymmetricalVertices(nextVertex0, nextVertex1);
 
@@ -176,11 +316,14 @@ void PolySymmetryData::findFirstSymmetricalVertices(ComponentSelection &selectio
 }
 
 
-pair<int, int> PolySymmetryData::getUnexaminedFaces(pair<int, int> &edgePair)
+pair<int, int> ShellSolver::getUnexaminedFaces(pair<int, int> &edgePair)
 {
-    vector<int> sharedFaces = intersection(
-        meshData.edgeData[edgePair.first].connectedFaces,
-        meshData.edgeData[edgePair.second].connectedFaces
+    vector<int> &sharedFaces = this->sharedIndices;
+
+    intersection(
+        meshData.edgeFaces[edgePair.first],
+        meshData.edgeFaces[edgePair.second],
+        sharedFaces
     );
 
     int face0 = -1;
@@ -190,7 +333,7 @@ pair<int, int> PolySymmetryData::getUnexaminedFaces(pair<int, int> &edgePair)
     {
         for (int &faceIndex : sharedFaces)
         {
-            if (this->examinedFaces[faceIndex])
+            if (state.examinedFaces[faceIndex])
             {
                 continue;
             }
@@ -216,13 +359,13 @@ pair<int, int> PolySymmetryData::getUnexaminedFaces(pair<int, int> &edgePair)
 }
 
 
-int PolySymmetryData::getUnexaminedFace(int &edgeIndex)
+int ShellSolver::getUnexaminedFace(int &edgeIndex)
 {
     int result = -1;
 
-    for (int &faceIndex : meshData.edgeData[edgeIndex].connectedFaces)
+    for (const int &faceIndex : meshData.edgeFaces[edgeIndex])
     {
-        if (!examinedFaces[faceIndex])
+        if (!state.examinedFaces[faceIndex])
         {
             result = faceIndex;
             break;
@@ -233,13 +376,13 @@ int PolySymmetryData::getUnexaminedFace(int &edgeIndex)
 }
 
 
-void PolySymmetryData::findSymmetricalVerticesOnFace(pair<int, int> &facePair)
+void ShellSolver::findSymmetricalVerticesOnFace(pair<int, int> &facePair)
 {
     queue<int> faceVerticesQueue = queue<int>();
     
-    for (int &v : meshData.faceData[facePair.first].connectedVertices)
+    for (const int &v : meshData.faceVertices[facePair.first])
     {
-        if (examinedVertices[v])
+        if (state.examinedVertices[v])
         {
             faceVerticesQueue.push(v);
         }
@@ -250,7 +393,7 @@ void PolySymmetryData::findSymmetricalVerticesOnFace(pair<int, int> &facePair)
         int vertex0 = faceVerticesQueue.front();
         faceVerticesQueue.pop();
 
-        int vertex1 = vertexSymmetryIndices[vertex0];
+        int vertex1 = state.vertexSymmetryIndices[vertex0];
 
         int nextVertex0 = getUnexaminedVertexSibling(vertex0, facePair.first);
         int nextVertex1 = getUnexaminedVertexSibling(vertex1, facePair.second);
@@ -267,35 +410,34 @@ void PolySymmetryData::findSymmetricalVerticesOnFace(pair<int, int> &facePair)
 }
 
 
-void PolySymmetryData::findSymmetricalEdgesOnFace(queue<pair<int, int>> &symmetricalEdgesQueue, int &faceIndex)
+void ShellSolver::findSymmetricalEdgesOnFace(queue<pair<int, int>> &symmetricalEdgesQueue, int &faceIndex)
 {        
     int vertex0;
     int vertex1;
 
     int edgeIndex;
 
-    for (int &e : meshData.faceData[faceIndex].connectedEdges)
+    for (int e : meshData.faceEdges[faceIndex])
     {
-        if (examinedEdges[e]) { continue; }
+        if (state.examinedEdges[e]) { continue; }
 
-        vertex0 = vertexSymmetryIndices[meshData.edgeData[e].connectedVertices[0]];
-        vertex1 = vertexSymmetryIndices[meshData.edgeData[e].connectedVertices[1]];
+        vertex0 = state.vertexSymmetryIndices[meshData.edgeVertices[e][0]];
+        vertex1 = state.vertexSymmetryIndices[meshData.edgeVertices[e][1]];
 
         if (vertex0 == -1 || vertex1 == -1)
         {
             continue;
         }
         
-        vector<int> sharedEdges = intersection(
-            meshData.vertexData[vertex0].connectedEdges, 
-            meshData.vertexData[vertex1].connectedEdges
+        int numberOfSharedEdges = intersectionSize(
+            meshData.vertexEdges[vertex0], 
+            meshData.vertexEdges[vertex1],
+            edgeIndex
         );
 
-        if (sharedEdges.size() != 1) { continue; }
+        if (numberOfSharedEdges != 1) { continue; }
 
-        edgeIndex = sharedEdges[0];
-
-        if (!examinedEdges[edgeIndex]) 
+        if (!state.examinedEdges[edgeIndex]) 
         { 
             symmetricalEdgesQueue.push(pair<int, int>(e, edgeIndex));   
         }
@@ -306,13 +448,13 @@ void PolySymmetryData::findSymmetricalEdgesOnFace(queue<pair<int, int>> &symmetr
 }
 
 
-int PolySymmetryData::getUnexaminedVertexSibling(int &vertexIndex, int &faceIndex)
+int ShellSolver::getUnexaminedVertexSibling(int &vertexIndex, int &faceIndex)
 {
     int result = -1;
 
-    for (int &v : meshData.vertexData[vertexIndex].faceVertexSiblings[faceIndex])
+    for (const int &v : meshData.getFaceVertexSiblings(vertexIndex, faceIndex))
     {
-        if (examinedVertices[v]) 
+        if (state.examinedVertices[v]) 
         {
             continue;
         }
@@ -325,149 +467,232 @@ int PolySymmetryData::getUnexaminedVertexSibling(int &vertexIndex, int &faceInde
 }
 
 
+/*
+    Expands `frontier` one level at a time, over all threads, until no unvisited
+    vertices are reachable. Vertices are claimed with `visitedMark` so that each
+    one is expanded exactly once. Vertices that are symmetrical to themselves
+    are claimed but not expanded. With `stopAtMirror`, a vertex never steps
+    directly onto its own mirror.
+*/
+static void floodVertices(
+    const MeshTopology &meshData, 
+    const vector<int> &vertexSymmetryIndices, 
+    vector<int> &frontier, 
+    atomic<char> *visitedVertices, 
+    char visitedMark,
+    bool stopAtMirror
+) {
+    vector<vector<int>> nextFrontiers(getNumberOfThreads());
+
+    while (!frontier.empty())
+    {
+        parallelForRange((int) frontier.size(), 2048, [&](int first, int last, int threadIndex)
+        {
+            vector<int> &nextFrontier = nextFrontiers[threadIndex];
+
+            for (int f = first; f < last; f++)
+            {
+                int vertexIndex = frontier[f];
+
+                if (vertexSymmetryIndices[vertexIndex] == vertexIndex) { continue; }
+
+                for (const int &i : meshData.vertexVertices[vertexIndex])
+                {
+                    if (stopAtMirror && vertexSymmetryIndices[i] == vertexIndex) { continue; }
+
+                    char unvisited = 0;
+
+                    if (visitedVertices[i].load(memory_order_relaxed) == 0 && visitedVertices[i].compare_exchange_strong(unvisited, visitedMark))
+                    {
+                        nextFrontier.push_back(i);
+                    }
+                }
+            }
+        });
+
+        frontier.clear();
+
+        for (vector<int> &nextFrontier : nextFrontiers)
+        {
+            frontier.insert(frontier.end(), nextFrontier.begin(), nextFrontier.end());
+            nextFrontier.clear();
+        }
+    }
+}
+
+
 void PolySymmetryData::findVertexSides(vector<int> &leftSideVertexIndices)
 {
-    int LEFT = 1;
-    int RIGHT = -1;
-    int CENTER = 0;
+    this->findVertexSides(leftSideVertexIndices, nullptr);
+}
 
-    vector<int> visitedVertices(meshData.numberOfVertices, false);
-    queue<int> nextVertexQueue = queue<int>();
 
-    vertexSides.clear();
-    vertexSides.resize(meshData.numberOfVertices, 0);
+/*
+    Recomputes the sides of `vertices` only. The vertices must make up whole
+    shells, and `leftSideVertexIndices` must hold every seed on those shells,
+    since the side floods never leave the shell they start on.
+*/
+void PolySymmetryData::updateVertexSides(vector<int> &leftSideVertexIndices, const vector<int> &vertices)
+{
+    this->findVertexSides(leftSideVertexIndices, &vertices);
+}
 
-    for (int &i : leftSideVertexIndices)
-    {
-        nextVertexQueue.push(i);
-        vertexSides[i] = LEFT;
-    }
 
-    int vertexIndex = -1;
+void PolySymmetryData::findVertexSides(vector<int> &leftSideVertexIndices, const vector<int> *vertices)
+{
+    const char LEFT_PASS = 1;
+    const char RIGHT_PASS = 2;
+
+    const MeshTopology &meshData = *this->meshData;
 
-    while (!nextVertexQueue.empty())
+    int numberOfVertices = meshData.numberOfVertices;
+
+    unique_ptr<atomic<char>[]> visitedVertices(new atomic<char>[numberOfVertices]);
+    vector<char> rightSeeds(numberOfVertices, 0);
+
+    parallelForRange(numberOfVertices, 8192, [&](int first, int last, int /*threadIndex*/)
     {
-        vertexIndex = nextVertexQueue.front();
-        nextVertexQueue.pop();
+        for (int i = first; i < last; i++) { visitedVertices[i].store(0, memory_order_relaxed); }
+    });
 
-        if (visitedVertices[vertexIndex]) { continue; }
+    vector<int> frontier;
 
-        visitedVertices[vertexIndex] = true;
+    for (int &i : leftSideVertexIndices)
+    {
+        if (i < 0 || i >= numberOfVertices) { continue; }
 
-        if (vertexSymmetryIndices[vertexIndex] == vertexIndex)
-        {
-            vertexSides[vertexIndex] = CENTER;
-        } else {
-            vertexSides[vertexIndex] = LEFT;
+        char unvisited = 0;
 
-            for (int &i : meshData.vertexData[vertexIndex].connectedVertices)
-            {
-                if (!visitedVertices[i] && vertexSymmetryIndices[i] != vertexIndex) 
-                {
-                    nextVertexQueue.push(i);
-                }
-            }
+        if (visitedVertices[i].compare_exchange_strong(unvisited, LEFT_PASS))
+        {
+            frontier.push_back(i);
         }
     }
 
+    floodVertices(meshData, vertexSymmetryIndices, frontier, visitedVertices.get(), LEFT_PASS, true);
+
     for (int &i : leftSideVertexIndices)
     {
-        nextVertexQueue.push(vertexSymmetryIndices[i]);
-        vertexSides[vertexSymmetryIndices[i]] = RIGHT;
+        if (i < 0 || i >= numberOfVertices) { continue; }
+
+        int j = vertexSymmetryIndices[i];
+        
+        if (j == -1) { continue; }
+
+        rightSeeds[j] = 1;
+
+        char unvisited = 0;
+
+        if (visitedVertices[j].compare_exchange_strong(unvisited, RIGHT_PASS))
+        {
+            frontier.push_back(j);
+        }
     }
 
-    while (!nextVertexQueue.empty())
-    {
-        vertexIndex = nextVertexQueue.front();
-        nextVertexQueue.pop();
+    floodVertices(meshData, vertexSymmetryIndices, frontier, visitedVertices.get(), RIGHT_PASS, false);
 
-        if (visitedVertices[vertexIndex]) { continue; }
+    // A right side seed is always on the right, even if the left side flood 
+    // reached it first. Otherwise the pass that reached a vertex decides its
+    // side, unless it is symmetrical to itself.
+    vertexSides.resize(numberOfVertices);
 
-        visitedVertices[vertexIndex] = true;
+    int numberOfUpdates = vertices == nullptr ? numberOfVertices : (int) vertices->size();
 
-        if (vertexSymmetryIndices[vertexIndex] == vertexIndex)
+    parallelForRange(numberOfUpdates, 8192, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int k = first; k < last; k++)
         {
-            vertexSides[vertexIndex] = CENTER;
-        } else {
-            vertexSides[vertexIndex] = RIGHT;
+            int i = vertices == nullptr ? k : (*vertices)[k];
+            int visited = visitedVertices[i].load(memory_order_relaxed);
 
-            for (int &i : meshData.vertexData[vertexIndex].connectedVertices)
-            {
-                if (!visitedVertices[i]) 
-                {
-                    nextVertexQueue.push(i);
-                }
-            }
+            int leftPass = visited == LEFT_PASS;
+            int rightPass = visited == RIGHT_PASS;
+            int seed = rightSeeds[i];
+            int offCenter = vertexSymmetryIndices[i] != i;
+
+            int onTheLeft = leftPass & (seed ^ 1) & offCenter;
+            int onTheRight = (leftPass & seed) | (rightPass & offCenter);
+
+            vertexSides[i] = onTheLeft - onTheRight;
         }
-    }
+    });
 }
 
 
-void PolySymmetryData::markSymmetricalVertices(int &i0, int &i1)
+void ShellSolver::markSymmetricalVertices(int &i0, int &i1)
 {
-    vertexSymmetryIndices[i0] = i1;
-    vertexSymmetryIndices[i1] = i0;
+    state.vertexSymmetryIndices[i0] = i1;
+    state.vertexSymmetryIndices[i1] = i0;
+
+    state.examinedVertices[i0] = true;
+    state.examinedVertices[i1] = true;
 
-    examinedVertices[i0] = true;
-    examinedVertices[i1] = true;
+    if (result != nullptr) { result->vertexPairs.push_back(pair<int, int>(i0, i1)); }
 }
 
 
-void PolySymmetryData::markSymmetricalEdges(int &i0, int &i1)
+void ShellSolver::markSymmetricalEdges(int &i0, int &i1)
 {
-    edgeSymmetryIndices[i0] = i1;
-    edgeSymmetryIndices[i1] = i0;
+    state.edgeSymmetryIndices[i0] = i1;
+    state.edgeSymmetryIndices[i1] = i0;
 
-    examinedEdges[i0] = true;
-    examinedEdges[i1] = true;
+    state.examinedEdges[i0] = true;
+    state.examinedEdges[i1] = true;
+
+    if (result != nullptr) { result->edgePairs.push_back(pair<int, int>(i0, i1)); }
 }
 
 
-void PolySymmetryData::markSymmetricalFaces(int &i0, int &i1)
+void ShellSolver::markSymmetricalFaces(int &i0, int &i1)
 {
-    faceSymmetryIndices[i0] = i1;
-    faceSymmetryIndices[i1] = i0;
+    state.faceSymmetryIndices[i0] = i1;
+    state.faceSymmetryIndices[i1] = i0;
+
+    state.examinedFaces[i0] = true;
+    state.examinedFaces[i1] = true;
 
-    examinedFaces[i0] = true;
-    examinedFaces[i1] = true;
+    if (result != nullptr) { result->facePairs.push_back(pair<int, int>(i0, i1)); }
 }
 
 
 void PolySymmetryData::finalizeSymmetry() 
 {
+    const MeshTopology &meshData = *this->meshData;
+
     int LEFT = 1;
     int RIGHT = -1;
-    int CENTER = 0;
 
-    for (int i = 0; i < meshData.numberOfEdges; i++)
+    // An edge is on the right if either vertex is, else on the left if 
+    // either vertex is, else on the center.
+    parallelForRange(meshData.numberOfEdges, 8192, [&](int first, int last, int /*threadIndex*/)
     {
-        int sv0 = vertexSides[meshData.edgeData[i].connectedVertices[0]];
-        int sv1 = vertexSides[meshData.edgeData[i].connectedVertices[1]];
-
-        if (sv0 == CENTER && sv1 == CENTER)
+        for (int i = first; i < last; i++)
         {
-            edgeSides[i] = CENTER;
-        } else if (sv0 == RIGHT || sv1 == RIGHT) {
-            edgeSides[i] = RIGHT;
-        } else if (sv0 == LEFT || sv1 == LEFT) {
-            edgeSides[i] = LEFT;
-        }
-    }
+            int sv0 = vertexSides[meshData.edgeVertices.indices[i * 2]];
+            int sv1 = vertexSides[meshData.edgeVertices.indices[i * 2 + 1]];
 
-    vector<int> faceVertexSides;
+            int lo = min(sv0, sv1);
+            int hi = max(sv0, sv1);
 
-    for (int i = 0; i < meshData.numberOfFaces; i++)
-    {
-        faceVertexSides.resize(meshData.faceData[i].connectedVertices.size());
+            edgeSides[i] = lo == RIGHT ? RIGHT : hi;
+        }
+    });
 
-        for (int j = 0; j < meshData.faceData[i].connectedVertices.size(); j++)
+    // A face with vertices on both sides is on the center.
+    parallelForRange(meshData.numberOfFaces, 4096, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
         {
-            faceVertexSides[j] = vertexSides[meshData.faceData[i].connectedVertices[j]];
-        }
+            int lo = LEFT;
+            int hi = RIGHT;
 
-        bool onTheLeft = contains(faceVertexSides, LEFT);
-        bool onTheRight = contains(faceVertexSides, RIGHT);
+            for (const int &v : meshData.faceVertices[i])
+            {
+                lo = min(lo, vertexSides[v]);
+                hi = max(hi, vertexSides[v]);
+            }
 
-        faceSides[i] = (onTheLeft ? LEFT : CENTER) + (onTheRight ? RIGHT : CENTER);
-    }
+            faceSides[i] = (hi == LEFT) - (lo == RIGHT);
+        }
+    });
 }
\ No newline at end of file
@@ -6,31 +6,52 @@
 #ifndef POLY_SYMMETRY_H
 #define POLY_SYMMETRY_H
 
-#include "meshData.h"
-#include "selection.h"
+#include "componentSelection.h"
+#include "meshTopology.h"
 
 #include <queue>
 #include <utility> 
 #include <vector>
 
-#include <maya/MDagPath.h>
-
 using namespace std;
 
-class PolySymmetryData
+/*
+    Symmetry assignments and the examined flags that drive the flood fill.
+*/
+struct SymmetryState
 {
-public:
-    PolySymmetryData();
-    ~PolySymmetryData();
+    vector<int>             vertexSymmetryIndices;
+    vector<int>             edgeSymmetryIndices;
+    vector<int>             faceSymmetryIndices;
 
-    virtual void            clear();
-    virtual void            reset();
-    virtual void            initialize(MDagPath &mesh);
+    vector<bool>            examinedEdges;
+    vector<bool>            examinedFaces;
+    vector<bool>            examinedVertices;
+};
+
+/*
+    Component pairs assigned while solving a single shell.
+*/
+struct ShellSymmetry
+{
+    vector<pair<int, int>>  vertexPairs;
+    vector<pair<int, int>>  edgePairs;
+    vector<pair<int, int>>  facePairs;
+
+    void                    clear() { vertexPairs.clear(); edgePairs.clear(); facePairs.clear(); }
+};
+
+/*
+    Flood fills the symmetry of one shell into a SymmetryState, optionally
+    recording every assignment it makes into a ShellSymmetry.
+*/
+class ShellSolver
+{
+public:
+    ShellSolver(const MeshTopology &meshData, SymmetryState &state, ShellSymmetry *result = nullptr);
 
     virtual void            findSymmetricalVertices(ComponentSelection &selection);
     virtual void            findFirstSymmetricalVertices(ComponentSelection &selection);
-    virtual void            findVertexSides(vector<int> &leftSideVertexIndices);
-    virtual void            finalizeSymmetry();
 
 private:
     virtual pair<int, int>  getUnexaminedFaces(pair<int, int> &edgePair);
@@ -44,21 +65,48 @@ private:
     virtual void            markSymmetricalEdges(int &i0, int &i1);
     virtual void            markSymmetricalFaces(int &i0, int &i1);
 
+private:
+    const MeshTopology      &meshData;
+    SymmetryState           &state;
+    ShellSymmetry           *result;
+
+    // Scratch for the faces shared by a pair of edges, reused so the flood fill does not allocate.
+    vector<int>             sharedIndices;
+};
+
+/*
+    Symmetry of a whole mesh, solved shell by shell from the selections of
+    the user or the seeds found from its points. The topology is not copied;
+    it must outlive this, or until `clear` is called.
+*/
+class PolySymmetryData : public SymmetryState
+{
 public:
-    vector<int>             vertexSymmetryIndices;
-    vector<int>             edgeSymmetryIndices;
-    vector<int>             faceSymmetryIndices;
+    PolySymmetryData();
+    ~PolySymmetryData();
+
+    virtual void            clear();
+    virtual void            reset();
+    virtual void            initialize(const MeshTopology &meshData);
+
+    virtual void            findSymmetricalVertices(ComponentSelection &selection, ShellSymmetry *result = nullptr);
+    virtual void            findSymmetricalShells(vector<ComponentSelection> &selections, vector<int> &collidingShells);
+    virtual void            findVertexSides(vector<int> &leftSideVertexIndices);
+    virtual void            updateVertexSides(vector<int> &leftSideVertexIndices, const vector<int> &vertices);
+    virtual void            finalizeSymmetry();
+
+private:
+    virtual void            findVertexSides(vector<int> &leftSideVertexIndices, const vector<int> *vertices);
+    virtual bool            canMergeShell(ShellSymmetry &shell);
+    virtual void            mergeShell(ShellSymmetry &shell);
 
+public:
     vector<int>             vertexSides;
     vector<int>             edgeSides;
     vector<int>             faceSides;
     
 private:    
-    MeshData                meshData;
-
-    vector<bool>            examinedEdges;
-    vector<bool>            examinedFaces;
-    vector<bool>            examinedVertices;
+    const MeshTopology      *meshData = nullptr;
 
     vector<int>             leftSideVertexIndices;
 };
@@ -6,17 +6,28 @@
 #include "meshData.h"
 #include "polySymmetryCmd.h"
 #include "polySymmetryNode.h"
+#include "profiling.h"
 #include "sceneCache.h"
 #include "selection.h"
+#include "symmetryRegistry.h"
+#include "symmetrySeeds.h"
+#include "symmetryTableFile.h"
+#include "symmetryTables.h"
 
+#include <cmath>
+#include <memory>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MDGModifier.h>
 #include <maya/MFnDependencyNode.h>
+#include <maya/MFnMesh.h>
+#include <maya/MFnSingleIndexedComponent.h>
 #include <maya/MGlobal.h>
+#include <maya/MIntArray.h>
 #include <maya/MPlug.h>
 #include <maya/MSelectionList.h>
 #include <maya/MStatus.h>
@@ -27,6 +38,9 @@ using namespace std;
 
 #define RETURN_IF_ERROR(s) if (!s) { return s; }
 
+// Default seeding tolerance, as a fraction of the bounding box diagonal of the mesh.
+#define DEFAULT_RELATIVE_TOLERANCE 0.001
+
 PolySymmetryCommand::PolySymmetryCommand() 
 {
     meshSymmetryNode = MObject();
@@ -90,8 +104,44 @@ MSyntax PolySymmetryCommand::getSyntax()
         MSyntax::MArgType::kBoolean
     );
 
+    syntax.addFlag(AUTOMATIC_FLAG, AUTOMATIC_LONG_FLAG);
+
+    syntax.addFlag(
+        TOLERANCE_FLAG,
+        TOLERANCE_LONG_FLAG,
+        MSyntax::MArgType::kDouble
+    );
+
+    syntax.addFlag(
+        EXPORT_FILE_FLAG,
+        EXPORT_FILE_LONG_FLAG,
+        MSyntax::MArgType::kString
+    );
+
+    syntax.addFlag(CACHE_KEY_FLAG, CACHE_KEY_LONG_FLAG);
+    syntax.addFlag(SYMMETRY_INDICES_FLAG, SYMMETRY_INDICES_LONG_FLAG);
+    syntax.addFlag(SIDES_FLAG, SIDES_LONG_FLAG);
+
+    syntax.addFlag(
+        COMPONENT_TYPE_FLAG,
+        COMPONENT_TYPE_LONG_FLAG,
+        MSyntax::MArgType::kString
+    );
+
+    syntax.addFlag(
+        INDICES_FLAG,
+        INDICES_LONG_FLAG,
+        MSyntax::MArgType::kLong
+    );
+
     syntax.makeFlagMultiUse(SYMMETRY_COMPONENTS_FLAG);
     syntax.makeFlagMultiUse(LEFT_SIDE_VERTEX_FLAG);
+    syntax.makeFlagMultiUse(INDICES_FLAG);
+
+    // These take their arguments in query mode as well.
+    syntax.makeFlagQueryWithFullArgs(EXPORT_FILE_FLAG, false);
+    syntax.makeFlagQueryWithFullArgs(COMPONENT_TYPE_FLAG, false);
+    syntax.makeFlagQueryWithFullArgs(INDICES_FLAG, false);
 
     return syntax;
 }
@@ -101,6 +151,8 @@ MStatus PolySymmetryCommand::doIt(const MArgList& argList)
 {
     MStatus status;
 
+    ProfileScope profileScope("polySymmetry");
+
     MArgDatabase argsData(syntax(), argList, &status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
@@ -112,7 +164,7 @@ MStatus PolySymmetryCommand::doIt(const MArgList& argList)
         status = this->parseArguments(argsData);        
         RETURN_IF_ERROR(status);
 
-        meshSymmetryData.initialize(selectedMesh);
+        meshSymmetryData.initialize(meshData);
     }
 
     return this->redoIt();
@@ -141,6 +193,11 @@ MStatus PolySymmetryCommand::redoIt()
 
 MStatus PolySymmetryCommand::doQueryDataAction()
 {
+    if (this->isQuerySymmetryIndices || this->isQuerySides || this->exportFilePath.length() > 0)
+    {
+        return this->doQueryTablesAction();
+    }
+
     MStatus status = this->getSymmetricalComponentsFromNode();
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
@@ -152,6 +209,20 @@ MStatus PolySymmetryCommand::doQueryDataAction()
 
 MStatus PolySymmetryCommand::doQueryMeshAction()
 {
+    if (this->isQueryCacheKey)
+    {
+        string cacheKey;
+        PolySymmetryCache::getCacheKeyFromMesh(this->selectedMesh, cacheKey);
+
+        this->setResult(MString(cacheKey.c_str()));
+        return MStatus::kSuccess;
+    }
+
+    if (this->isQuerySymmetryIndices || this->isQuerySides || this->exportFilePath.length() > 0)
+    {
+        return this->doQueryTablesAction();
+    }
+
     bool cacheHit = PolySymmetryCache::getNodeFromCache(this->selectedMesh, this->meshSymmetryNode);
 
     if (this->isQueryExists)
@@ -174,6 +245,89 @@ MStatus PolySymmetryCommand::doQueryMeshAction()
 }
 
 
+/*
+    Returns the symmetry or side indices of one component type as an int
+    array, for the whole mesh or for the queried indices only, and writes
+    the tables to the file given with the -exportFile flag, if any. This 
+    skips the JSON document returned by a plain query.
+*/
+MStatus PolySymmetryCommand::doQueryTablesAction()
+{
+    MStatus status;
+
+    if (this->isQuerySymmetryIndices && this->isQuerySides)
+    {
+        MGlobal::displayError("Cannot query -symmetryIndices and -sides in the same command.");
+        return MStatus::kFailure;
+    }
+
+    shared_ptr<const SymmetryTables> tables;
+    string cacheKey;
+
+    status = this->getQueriedSymmetryTables(tables, cacheKey);
+    RETURN_IF_ERROR(status);
+
+    if (this->exportFilePath.length() > 0 && !writeSymmetryTableFile(this->exportFilePath.asChar(), cacheKey, *tables))
+    {
+        MString errorMsg("Cannot write symmetry tables to ^1s.");
+        errorMsg.format(errorMsg, this->exportFilePath);
+
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
+
+    if (!this->isQuerySymmetryIndices && !this->isQuerySides)
+    {
+        return MStatus::kSuccess;
+    }
+
+    const vector<int>* values;
+
+    switch (this->queryComponentType)
+    {
+        case MFn::kMeshEdgeComponent:
+            values = this->isQuerySides ? &tables->edgeSides : &tables->edgeSymmetry;
+            break;
+
+        case MFn::kMeshPolygonComponent:
+            values = this->isQuerySides ? &tables->faceSides : &tables->faceSymmetry;
+            break;
+
+        default:
+            values = this->isQuerySides ? &tables->vertexSides : &tables->vertexSymmetry;
+            break;
+    }
+
+    if (this->queryIndices.empty())
+    {
+        this->setResult(MIntArray(values->data(), (unsigned int) values->size()));
+        return MStatus::kSuccess;
+    }
+
+    MIntArray result((unsigned int) this->queryIndices.size());
+
+    for (size_t i = 0; i < this->queryIndices.size(); i++)
+    {
+        int index = this->queryIndices[i];
+
+        if (index < 0 || index >= (int) values->size())
+        {
+            MString errorMsg("^1s: component index ^2s is out of range.");
+            errorMsg.format(errorMsg, PolySymmetryCommand::COMMAND_NAME, MString() + index);
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        result[(unsigned int) i] = (*values)[index];
+    }
+
+    this->setResult(result);
+
+    return MStatus::kSuccess;
+}
+
+
 MStatus PolySymmetryCommand::doUndoableCommand()
 {
     MStatus status;
@@ -181,6 +335,9 @@ MStatus PolySymmetryCommand::doUndoableCommand()
     status = this->getSymmetricalComponentsFromScene();
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = this->registerSymmetryTables();
+    RETURN_IF_ERROR(status);
+
     if (constructionHistory)
     {
         status = this->createResultNode();
@@ -221,6 +378,15 @@ MStatus PolySymmetryCommand::parseQueryArguments(MArgDatabase &argsData)
         
     this->isQuery = true;
     this->isQueryExists = argsData.isFlagSet(EXISTS_FLAG);
+    this->isQueryCacheKey = argsData.isFlagSet(CACHE_KEY_FLAG);
+    this->isQuerySymmetryIndices = argsData.isFlagSet(SYMMETRY_INDICES_FLAG);
+    this->isQuerySides = argsData.isFlagSet(SIDES_FLAG);
+
+    if (argsData.isFlagSet(EXPORT_FILE_FLAG))
+    {
+        status = argsData.getFlagArgument(EXPORT_FILE_FLAG, 0, this->exportFilePath);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
     MSelectionList selection;    
     status = argsData.getObjects(selection);
@@ -235,16 +401,19 @@ MStatus PolySymmetryCommand::parseQueryArguments(MArgDatabase &argsData)
     if (objectType == PolySymmetryNode::NODE_NAME)
     {
         this->meshSymmetryNode = obj;
-        return MStatus::kSuccess;
+
+        MObject component;
+        return this->parseQueryComponents(argsData, component);
     }
     
     MDagPath dagPath;
-    status = selection.getDagPath(0, dagPath);    
+    MObject component;
+    status = selection.getDagPath(0, dagPath, component);    
 
     if (status && dagPath.hasFn(MFn::kMesh))
     {
         this->selectedMesh.set(dagPath);
-        return MStatus::kSuccess;
+        return this->parseQueryComponents(argsData, component);
     }
 
     MString errorMsg("polySymmetry command requires a mesh or ^1s in query node, not a(n) ^2s");
@@ -255,6 +424,83 @@ MStatus PolySymmetryCommand::parseQueryArguments(MArgDatabase &argsData)
 }
 
 
+/*
+    Reads the component type and indices of a -symmetryIndices or -sides 
+    query, from the components of the queried mesh if there are any, or from 
+    the -componentType and -indices flags otherwise.
+*/
+MStatus PolySymmetryCommand::parseQueryComponents(MArgDatabase &argsData, MObject &component)
+{
+    MStatus status;
+
+    if (!component.isNull())
+    {
+        this->queryComponentType = component.apiType();
+
+        if (
+            this->queryComponentType != MFn::kMeshVertComponent &&
+            this->queryComponentType != MFn::kMeshEdgeComponent &&
+            this->queryComponentType != MFn::kMeshPolygonComponent
+        ) {
+            MGlobal::displayError("polySymmetry command can only query vertex, edge, or face components.");
+            return MStatus::kFailure;
+        }
+
+        MIntArray elements;
+        MFnSingleIndexedComponent fnComponent(component);
+        fnComponent.getElements(elements);
+
+        this->queryIndices.resize(elements.length());
+
+        for (unsigned int i = 0; i < elements.length(); i++)
+        {
+            this->queryIndices[i] = elements[i];
+        }
+
+        return MStatus::kSuccess;
+    }
+
+    if (argsData.isFlagSet(COMPONENT_TYPE_FLAG))
+    {
+        MString componentType;
+        status = argsData.getFlagArgument(COMPONENT_TYPE_FLAG, 0, componentType);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (componentType == "vtx")
+        {
+            this->queryComponentType = MFn::kMeshVertComponent;
+        } else if (componentType == "e") {
+            this->queryComponentType = MFn::kMeshEdgeComponent;
+        } else if (componentType == "f") {
+            this->queryComponentType = MFn::kMeshPolygonComponent;
+        } else {
+            MString errorMsg("Invalid component type ^1s. Expected \"vtx\", \"e\", or \"f\".");
+            errorMsg.format(errorMsg, componentType);
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+    }
+
+    unsigned int numberOfIndices = argsData.numberOfFlagUses(INDICES_FLAG);
+
+    for (unsigned int i = 0; i < numberOfIndices; i++)
+    {
+        MArgList args;
+
+        status = argsData.getFlagArgumentList(INDICES_FLAG, i, args);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        int index = args.asInt(0, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        this->queryIndices.push_back(index);
+    }
+
+    return MStatus::kSuccess;
+}
+
+
 MStatus PolySymmetryCommand::parseArguments(MArgDatabase &argsData)
 {
     MStatus status;
@@ -273,6 +519,17 @@ MStatus PolySymmetryCommand::parseArguments(MArgDatabase &argsData)
     status = this->getSelectedMesh(argsData);
     RETURN_IF_ERROR(status);
 
+    if (argsData.isFlagSet(EXPORT_FILE_FLAG))
+    {
+        status = argsData.getFlagArgument(EXPORT_FILE_FLAG, 0, this->exportFilePath);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+
+    if (argsData.isFlagSet(AUTOMATIC_FLAG))
+    {
+        return this->getAutomaticSeeds(argsData);
+    }
+
     status = this->getSymmetryComponents(argsData);
     RETURN_IF_ERROR(status);
 
@@ -392,6 +649,91 @@ MStatus PolySymmetryCommand::getLeftSideVertexIndices(MArgDatabase &argsData)
 }
 
 
+/*
+    Finds the symmetrical components and left side vertices from the point 
+    positions of the mesh, mirrored across the YZ plane in object space. 
+    Shells that have no seed are reported, and the rest of the mesh is 
+    still solved.
+*/
+MStatus PolySymmetryCommand::getAutomaticSeeds(MArgDatabase &argsData)
+{
+    MStatus status;
+
+    MFnMesh fnMesh(this->selectedMesh);
+
+    const float* points = fnMesh.getRawPoints(&status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    double tolerance = 0.0;
+
+    if (argsData.isFlagSet(TOLERANCE_FLAG))
+    {
+        status = argsData.getFlagArgument(TOLERANCE_FLAG, 0, tolerance);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    } else {
+        float lo[3] = {  HUGE_VALF,  HUGE_VALF,  HUGE_VALF };
+        float hi[3] = { -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+
+        for (int i = 0; i < meshData.numberOfVertices; i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                lo[c] = min(lo[c], points[i * 3 + c]);
+                hi[c] = max(hi[c], points[i * 3 + c]);
+            }
+        }
+
+        double diagonal = 0.0;
+
+        for (int c = 0; c < 3 && meshData.numberOfVertices > 0; c++)
+        {
+            diagonal += (double) (hi[c] - lo[c]) * (hi[c] - lo[c]);
+        }
+
+        tolerance = sqrt(diagonal) * DEFAULT_RELATIVE_TOLERANCE;
+    }
+
+    vector<ComponentSelection> seeds;
+    vector<int> unmatchedVertices;
+
+    {
+        ProfileScope seedScope("findSymmetrySeeds");
+        findSymmetrySeeds(meshData, points, 0, (float) tolerance, seeds, unmatchedVertices);
+    }
+
+    for (int &i : unmatchedVertices)
+    {
+        MString warningMsg("^1s: no symmetrical seed was found for the shell of ^2s.vtx[^3s].");
+        warningMsg.format(
+            warningMsg, 
+            PolySymmetryCommand::COMMAND_NAME, 
+            this->selectedMesh.partialPathName(), 
+            MString() + i
+        );
+
+        MGlobal::displayWarning(warningMsg);
+    }
+
+    if (seeds.empty())
+    {
+        MGlobal::displayError("Could not find any symmetrical components on the mesh. Select them manually.");
+        return MStatus::kFailure;
+    }
+
+    for (ComponentSelection &seed : seeds)
+    {
+        this->symmetryComponents.push_back(seed);
+
+        if (seed.leftVertexIndex != -1)
+        {
+            this->leftSideVertexIndices.push_back(seed.leftVertexIndex);
+        }
+    }
+
+    return MStatus::kSuccess;
+}
+
+
 void PolySymmetryCommand::setLeftSideVertexIndices(vector<int> &indices)
 {
     for (int &i : indices)
@@ -432,25 +774,19 @@ MStatus PolySymmetryCommand::getFlagStringArguments(MArgList &args, MSelectionLi
 MStatus PolySymmetryCommand::getSymmetricalComponentsFromNode()
 {
     MStatus status;
-    MFnDependencyNode fnNode(this->meshSymmetryNode);
 
-    status = PolySymmetryNode::getValues(fnNode, EDGE_SYMMETRY, this->meshSymmetryData.edgeSymmetryIndices);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = PolySymmetryNode::getValues(fnNode, FACE_SYMMETRY, this->meshSymmetryData.faceSymmetryIndices);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    shared_ptr<const SymmetryTables> tables;
 
-    status = PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, this->meshSymmetryData.vertexSymmetryIndices);
+    status = PolySymmetryNode::getSymmetryTables(this->meshSymmetryNode, tables);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    status = PolySymmetryNode::getValues(fnNode, EDGE_SIDES, this->meshSymmetryData.edgeSides);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    this->meshSymmetryData.edgeSymmetryIndices = tables->edgeSymmetry;
+    this->meshSymmetryData.faceSymmetryIndices = tables->faceSymmetry;
+    this->meshSymmetryData.vertexSymmetryIndices = tables->vertexSymmetry;
 
-    status = PolySymmetryNode::getValues(fnNode, FACE_SIDES, this->meshSymmetryData.faceSides);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, this->meshSymmetryData.vertexSides);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    this->meshSymmetryData.edgeSides = tables->edgeSides;
+    this->meshSymmetryData.faceSides = tables->faceSides;
+    this->meshSymmetryData.vertexSides = tables->vertexSides;
 
     return MStatus::kSuccess;
 }
@@ -460,18 +796,113 @@ MStatus PolySymmetryCommand::getSymmetricalComponentsFromScene()
 {
     MStatus status;
 
-    for (ComponentSelection &s : symmetryComponents)
+    ProfileScope profileScope("solveSymmetry");
+
+    vector<int> collidingShells;
+    this->meshSymmetryData.findSymmetricalShells(symmetryComponents, collidingShells);
+
+    for (int &i : collidingShells)
+    {
+        MString warningMsg("^1s: the components selected on edges ^2s and ^3s collide with another shell and were ignored.");
+        warningMsg.format(
+            warningMsg, 
+            PolySymmetryCommand::COMMAND_NAME, 
+            MString() + symmetryComponents[i].edgeIndices.first, 
+            MString() + symmetryComponents[i].edgeIndices.second
+        );
+
+        MGlobal::displayWarning(warningMsg);
+    }
+
+    // A left side vertex that no merged shell reached is on a rejected or
+    // unseeded shell, and would give sides to components that were never solved.
+    vector<int> solvedLeftSideVertexIndices;
+    solvedLeftSideVertexIndices.reserve(leftSideVertexIndices.size());
+
+    for (int &i : leftSideVertexIndices)
     {
-        this->meshSymmetryData.findSymmetricalVertices(s);
+        if (i < 0 || i >= meshData.numberOfVertices) { continue; }
+        if (this->meshSymmetryData.vertexSymmetryIndices[i] == -1) { continue; }
+
+        solvedLeftSideVertexIndices.push_back(i);
     }
 
-    this->meshSymmetryData.findVertexSides(leftSideVertexIndices);
+    this->meshSymmetryData.findVertexSides(solvedLeftSideVertexIndices);
     this->meshSymmetryData.finalizeSymmetry();
 
     return MStatus::kSuccess;
 }
 
 
+void PolySymmetryCommand::getSymmetryTables(SymmetryTables &tables)
+{
+    tables.edgeSymmetry = this->meshSymmetryData.edgeSymmetryIndices;
+    tables.faceSymmetry = this->meshSymmetryData.faceSymmetryIndices;
+    tables.vertexSymmetry = this->meshSymmetryData.vertexSymmetryIndices;
+
+    tables.edgeSides = this->meshSymmetryData.edgeSides;
+    tables.faceSides = this->meshSymmetryData.faceSides;
+    tables.vertexSides = this->meshSymmetryData.vertexSides;
+}
+
+
+MStatus PolySymmetryCommand::getQueriedSymmetryTables(shared_ptr<const SymmetryTables> &tables, string &cacheKey)
+{
+    MStatus status;
+
+    if (this->selectedMesh.isValid())
+    {
+        PolySymmetryCache::getCacheKeyFromMesh(this->selectedMesh, cacheKey);
+
+        if (!PolySymmetryCache::getSymmetryTables(this->selectedMesh, tables))
+        {
+            MString errorMsg("No symmetry tables in memory match the mesh ^1s.");
+            errorMsg.format(errorMsg, this->selectedMesh.partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        return MStatus::kSuccess;
+    }
+
+    status = PolySymmetryNode::getCacheKey(this->meshSymmetryNode, cacheKey);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = PolySymmetryNode::getSymmetryTables(this->meshSymmetryNode, tables);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    return MStatus::kSuccess;
+}
+
+
+/*
+    Adds the solved tables to the symmetry registry and writes them to the 
+    file given with the -exportFile flag, if any.
+*/
+MStatus PolySymmetryCommand::registerSymmetryTables()
+{
+    shared_ptr<SymmetryTables> tables = make_shared<SymmetryTables>();
+    this->getSymmetryTables(*tables);
+
+    string cacheKey;
+    PolySymmetryCache::getCacheKeyFromMesh(this->selectedMesh, cacheKey);
+
+    SymmetryRegistry::addSymmetryTables(cacheKey, tables);
+
+    if (this->exportFilePath.length() > 0 && !writeSymmetryTableFile(this->exportFilePath.asChar(), cacheKey, *tables))
+    {
+        MString errorMsg("Cannot write symmetry tables to ^1s.");
+        errorMsg.format(errorMsg, this->exportFilePath);
+
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
+
+    return MStatus::kSuccess;
+}
+
+
 MStatus PolySymmetryCommand::createResultNode()
 {
     MDGModifier dgModifier;
@@ -492,22 +923,10 @@ MStatus PolySymmetryCommand::createResultNode()
 
     MFnDependencyNode fnNode(meshSymmetryNode);
 
-    status = PolySymmetryNode::setValues(fnNode, EDGE_SYMMETRY, this->meshSymmetryData.edgeSymmetryIndices);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = PolySymmetryNode::setValues(fnNode, FACE_SYMMETRY, this->meshSymmetryData.faceSymmetryIndices);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = PolySymmetryNode::setValues(fnNode, VERTEX_SYMMETRY, this->meshSymmetryData.vertexSymmetryIndices);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    SymmetryTables tables;
+    this->getSymmetryTables(tables);
 
-    status = PolySymmetryNode::setValues(fnNode, EDGE_SIDES, this->meshSymmetryData.edgeSides);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = PolySymmetryNode::setValues(fnNode, FACE_SIDES, this->meshSymmetryData.faceSides);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = PolySymmetryNode::setValues(fnNode, VERTEX_SIDES, this->meshSymmetryData.vertexSides);
+    status = PolySymmetryNode::setSymmetryTables(meshSymmetryNode, tables);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
     status = PolySymmetryNode::setValue(fnNode, NUMBER_OF_EDGES, this->meshData.numberOfEdges);
@@ -523,6 +942,12 @@ MStatus PolySymmetryCommand::createResultNode()
     status = PolySymmetryNode::setValue(fnNode, VERTEX_CHECKSUM, vertexChecksum);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    string cacheKey;
+    PolySymmetryCache::getCacheKeyFromMesh(this->selectedMesh, cacheKey);
+
+    status = PolySymmetryNode::setCacheKey(meshSymmetryNode, cacheKey);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     this->setResult(fnNode.name());
 
     PolySymmetryCache::addNodeToCache(meshSymmetryNode);
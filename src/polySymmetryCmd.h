@@ -8,11 +8,16 @@
 
 #include "meshData.h"
 #include "polySymmetry.h"
+#include "symmetryTables.h"
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
+#include <maya/MFn.h>
+#include <maya/MObject.h>
 #include <maya/MPxToolCommand.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
@@ -33,6 +38,30 @@ using namespace std;
 #define EXISTS_FLAG                     "-ex"
 #define EXISTS_LONG_FLAG                "-exists"
 
+#define AUTOMATIC_FLAG                  "-au"
+#define AUTOMATIC_LONG_FLAG             "-automatic"
+
+#define TOLERANCE_FLAG                  "-tol"
+#define TOLERANCE_LONG_FLAG             "-tolerance"
+
+#define EXPORT_FILE_FLAG                "-ef"
+#define EXPORT_FILE_LONG_FLAG           "-exportFile"
+
+#define CACHE_KEY_FLAG                  "-ck"
+#define CACHE_KEY_LONG_FLAG             "-cacheKey"
+
+#define SYMMETRY_INDICES_FLAG           "-si"
+#define SYMMETRY_INDICES_LONG_FLAG      "-symmetryIndices"
+
+#define SIDES_FLAG                      "-sd"
+#define SIDES_LONG_FLAG                 "-sides"
+
+#define COMPONENT_TYPE_FLAG             "-ct"
+#define COMPONENT_TYPE_LONG_FLAG        "-componentType"
+
+#define INDICES_FLAG                    "-ix"
+#define INDICES_LONG_FLAG               "-indices"
+
 
 class PolySymmetryCommand : public MPxToolCommand
 {
@@ -49,10 +78,12 @@ public:
 
     virtual MStatus     doQueryDataAction();
     virtual MStatus     doQueryMeshAction();
+    virtual MStatus     doQueryTablesAction();
     virtual MStatus     doUndoableCommand();
 
     virtual MStatus     parseQueryArguments(MArgDatabase &argsData);
     virtual MStatus     parseArguments(MArgDatabase &argsData);
+    virtual MStatus     parseQueryComponents(MArgDatabase &argsData, MObject &component);
 
     virtual MStatus     getSelectedMesh(MArgDatabase &argsData);
 
@@ -60,12 +91,17 @@ public:
     virtual void        setSymmetryComponents(vector<ComponentSelection> &components);
 
     virtual MStatus     getLeftSideVertexIndices(MArgDatabase &argsData);
+    virtual MStatus     getAutomaticSeeds(MArgDatabase &argsData);
     virtual void        setLeftSideVertexIndices(vector<int> &indices);
 
     virtual MStatus     getFlagStringArguments(MArgList &args, MSelectionList &selection);
 
     virtual MStatus     getSymmetricalComponentsFromNode();
     virtual MStatus     getSymmetricalComponentsFromScene();
+    virtual void        getSymmetryTables(SymmetryTables &tables);
+    virtual MStatus     getQueriedSymmetryTables(shared_ptr<const SymmetryTables> &tables, string &cacheKey);
+
+    virtual MStatus     registerSymmetryTables();
 
     virtual MStatus     createResultNode();
     virtual MStatus     createResultString();
@@ -84,6 +120,14 @@ private:
     bool                        constructionHistory = false;
     bool                        isQuery = false;
     bool                        isQueryExists = false;
+    bool                        isQueryCacheKey = false;
+    bool                        isQuerySymmetryIndices = false;
+    bool                        isQuerySides = false;
+
+    MFn::Type                   queryComponentType = MFn::kMeshVertComponent;
+    vector<int>                 queryIndices;
+
+    MString                     exportFilePath;
 
     MDagPath                    selectedMesh;
     MeshData                    meshData;
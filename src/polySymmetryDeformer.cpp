@@ -0,0 +1,352 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshPoints.h"
+#include "parallel.h"
+#include "pointKernels.h"
+#include "polySymmetryDeformer.h"
+#include "polySymmetryTableData.h"
+
+#include <memory>
+#include <vector>
+
+#include <maya/MArrayDataHandle.h>
+#include <maya/MDataBlock.h>
+#include <maya/MDataHandle.h>
+#include <maya/MFnData.h>
+#include <maya/MFnEnumAttribute.h>
+#include <maya/MFnMatrixAttribute.h>
+#include <maya/MFnMesh.h>
+#include <maya/MFnNumericAttribute.h>
+#include <maya/MFnNumericData.h>
+#include <maya/MFnTypedAttribute.h>
+#include <maya/MGlobal.h>
+#include <maya/MItGeometry.h>
+#include <maya/MMatrix.h>
+#include <maya/MObject.h>
+#include <maya/MPointArray.h>
+#include <maya/MPxData.h>
+#include <maya/MPxDeformerNode.h>
+#include <maya/MVector.h>
+
+using namespace std;
+
+// Points per task when blending the reflected points back into the geometry.
+#define DEFORM_GRAIN_SIZE 8192
+
+/* Problems that make deform() pass the geometry through, reported once each. */
+enum SymmetryDeformerProblem
+{
+    kNoProblem = 0,
+    kFlatPlane = 1,
+    kMismatchedMesh = 2
+};
+
+MObject PolySymmetryDeformer::symmetryTables;
+MObject PolySymmetryDeformer::referenceMesh;
+MObject PolySymmetryDeformer::mode;
+MObject PolySymmetryDeformer::direction;
+MObject PolySymmetryDeformer::axis;
+MObject PolySymmetryDeformer::planeType;
+MObject PolySymmetryDeformer::planeNormal;
+MObject PolySymmetryDeformer::planeOffset;
+MObject PolySymmetryDeformer::planeMatrix;
+
+PolySymmetryDeformer::PolySymmetryDeformer() {}
+PolySymmetryDeformer::~PolySymmetryDeformer() {}
+
+void* PolySymmetryDeformer::creator()
+{
+    return new PolySymmetryDeformer();
+}
+
+MStatus PolySymmetryDeformer::initialize()
+{
+    MStatus status;
+
+    MFnTypedAttribute t;
+    MFnEnumAttribute e;
+    MFnNumericAttribute n;
+    MFnMatrixAttribute m;
+
+    symmetryTables = t.create(DEFORMER_SYMMETRY_TABLES, "stb", PolySymmetryTableData::DATA_ID, MObject::kNullObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    t.setStorable(false);
+
+    referenceMesh = t.create(DEFORMER_REFERENCE_MESH, "rm", MFnData::kMesh, MObject::kNullObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    t.setStorable(false);
+
+    mode = e.create(DEFORMER_MODE, "mo", kMirrorMode, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    e.addField("flip", kFlipMode);
+    e.addField("mirror", kMirrorMode);
+    e.setKeyable(true);
+
+    direction = e.create(DEFORMER_DIRECTION, "d", 1, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    e.addField("leftToRight", 1);
+    e.addField("rightToLeft", -1);
+    e.setKeyable(true);
+
+    axis = e.create(DEFORMER_AXIS, "ax", 0, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    e.addField("x", 0);
+    e.addField("y", 1);
+    e.addField("z", 2);
+    e.setKeyable(true);
+
+    planeType = e.create(DEFORMER_PLANE_TYPE, "pt", kAxisPlane, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    e.addField("axis", kAxisPlane);
+    e.addField("normal", kNormalPlane);
+    e.addField("frame", kFramePlane);
+    e.setKeyable(true);
+
+    planeNormal = n.create(DEFORMER_PLANE_NORMAL, "pn", MFnNumericData::k3Double, 0.0, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    n.setDefault(1.0, 0.0, 0.0);
+    n.setKeyable(true);
+
+    planeOffset = n.create(DEFORMER_PLANE_OFFSET, "po", MFnNumericData::kDouble, 0.0, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    n.setKeyable(true);
+
+    planeMatrix = m.create(DEFORMER_PLANE_MATRIX, "pmt", MFnMatrixAttribute::kDouble, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    addAttribute(symmetryTables);
+    addAttribute(referenceMesh);
+    addAttribute(mode);
+    addAttribute(direction);
+    addAttribute(axis);
+    addAttribute(planeType);
+    addAttribute(planeNormal);
+    addAttribute(planeOffset);
+    addAttribute(planeMatrix);
+
+    attributeAffects(symmetryTables, outputGeom);
+    attributeAffects(referenceMesh, outputGeom);
+    attributeAffects(mode, outputGeom);
+    attributeAffects(direction, outputGeom);
+    attributeAffects(axis, outputGeom);
+    attributeAffects(planeType, outputGeom);
+    attributeAffects(planeNormal, outputGeom);
+    attributeAffects(planeOffset, outputGeom);
+    attributeAffects(planeMatrix, outputGeom);
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryDeformer::getSymmetryTables(MDataBlock &dataBlock, shared_ptr<const SymmetryTables> &tables)
+{
+    MStatus status;
+
+    MDataHandle symmetryTablesHandle = dataBlock.inputValue(symmetryTables, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MPxData* data = symmetryTablesHandle.asPluginData();
+
+    if (data == nullptr || data->typeId() != PolySymmetryTableData::DATA_ID)
+    {
+        return MStatus::kFailure;
+    }
+
+    return ((PolySymmetryTableData*) data)->getTables(tables);
+}
+
+MStatus PolySymmetryDeformer::getMirrorPlane(MDataBlock &dataBlock, const MMatrix &matrix, MirrorPlane &plane)
+{
+    int axisValue = dataBlock.inputValue(axis).asShort();
+    int planeTypeValue = dataBlock.inputValue(planeType).asShort();
+
+    if (planeTypeValue == kNormalPlane)
+    {
+        MVector normal = dataBlock.inputValue(planeNormal).asVector();
+        double offset = dataBlock.inputValue(planeOffset).asDouble();
+
+        if (normal.length() < 1e-10) { return MStatus::kFailure; }
+
+        float n[3] = {(float) normal.x, (float) normal.y, (float) normal.z};
+        plane = MirrorPlane(n, (float) offset);
+
+        return MStatus::kSuccess;
+    }
+
+    if (planeTypeValue == kFramePlane)
+    {
+        MMatrix frameMatrix = dataBlock.inputValue(planeMatrix).asMatrix();
+        return getFramePlane(frameMatrix * matrix.inverse(), axisValue, plane);
+    }
+
+    plane = MirrorPlane(axisValue);
+
+    return MStatus::kSuccess;
+}
+
+void PolySymmetryDeformer::getBlendWeights(
+    const SymmetryTables &tables,
+    int mode,
+    int direction,
+    float envelope,
+    const vector<float> &weights,
+    vector<float> &blend
+) {
+    const vector<int> &vertexSides = tables.vertexSides;
+    int numberOfVertices = (int) weights.size();
+
+    blend.resize(numberOfVertices);
+
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        bool keepVertex = mode == kMirrorMode && (vertexSides[i] == 0 || vertexSides[i] == direction);
+
+        blend[i] = keepVertex ? 0.0f : weights[i] * envelope;
+    }
+}
+
+/*
+    Warns about `problem` only when it differs from the last one reported, so
+    a node that cannot deform warns once instead of on every evaluation. The
+    latch is cleared by an evaluation without a problem.
+*/
+void PolySymmetryDeformer::reportProblem(int problem)
+{
+    if (problem == this->reportedProblem) { return; }
+
+    this->reportedProblem = problem;
+
+    MString warningMsg;
+
+    switch (problem)
+    {
+        case kFlatPlane:
+            warningMsg = "^1s: planeNormal or planeMatrix does not span a plane to mirror across.";
+            break;
+        case kMismatchedMesh:
+            warningMsg = "^1s: the input mesh does not match the symmetry data.";
+            break;
+        default:
+            return;
+    }
+
+    warningMsg.format(warningMsg, this->name());
+    MGlobal::displayWarning(warningMsg);
+}
+
+/*
+    Reflections are computed from the full input mesh, since the opposite of
+    a point in the deformer set does not have to be in the set itself. Only
+    the points in the set are moved.
+*/
+MStatus PolySymmetryDeformer::deform(MDataBlock &dataBlock, MItGeometry &itGeo, const MMatrix &matrix, unsigned int multiIndex)
+{
+    MStatus status;
+
+    float envelopeValue = dataBlock.inputValue(envelope).asFloat();
+
+    if (envelopeValue == 0.0f) { return MStatus::kSuccess; }
+
+    shared_ptr<const SymmetryTables> tables;
+
+    if (!getSymmetryTables(dataBlock, tables)) { return MStatus::kSuccess; }
+
+    int modeValue = dataBlock.inputValue(mode).asShort();
+    int directionValue = dataBlock.inputValue(direction).asShort();
+
+    MirrorPlane plane;
+
+    if (!getMirrorPlane(dataBlock, matrix, plane))
+    {
+        this->reportProblem(kFlatPlane);
+        return MStatus::kSuccess;
+    }
+
+    MArrayDataHandle inputHandle = dataBlock.outputArrayValue(input, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = inputHandle.jumpToElement(multiIndex);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MObject inputMesh = inputHandle.outputValue().child(inputGeom).asMesh();
+
+    if (inputMesh.isNull()) { return MStatus::kSuccess; }
+
+    MFnMesh fnInputMesh(inputMesh);
+    int numberOfVertices = fnInputMesh.numVertices();
+
+    if ((int) tables->vertexSymmetry.size() != numberOfVertices)
+    {
+        this->reportProblem(kMismatchedMesh);
+        return MStatus::kSuccess;
+    }
+
+    this->reportProblem(kNoProblem);
+
+    PointBuffer inputPoints(fnInputMesh.getRawPoints(&status), 3);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    vector<float> reflectedPoints((size_t) numberOfVertices * 4);
+
+    MObject referenceObject = dataBlock.inputValue(referenceMesh).asMesh();
+    MFnMesh fnReferenceMesh;
+
+    if (!referenceObject.isNull()) { fnReferenceMesh.setObject(referenceObject); }
+
+    if (!referenceObject.isNull() && fnReferenceMesh.numVertices() == numberOfVertices)
+    {
+        PointBuffer referencePoints(fnReferenceMesh.getRawPoints(&status), 3);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        flipPointsAgainst(inputPoints, referencePoints, tables->vertexSymmetry.data(), numberOfVertices, plane, reflectedPoints.data());
+    } else {
+        flipPoints(inputPoints, tables->vertexSymmetry.data(), numberOfVertices, plane, reflectedPoints.data());
+    }
+
+    vector<int> memberIndices;
+    vector<float> weights(numberOfVertices, 0.0f);
+
+    memberIndices.reserve(itGeo.count());
+
+    for (itGeo.reset(); !itGeo.isDone(); itGeo.next())
+    {
+        int i = itGeo.index();
+
+        if (i < 0 || i >= numberOfVertices) { continue; }
+
+        memberIndices.push_back(i);
+        weights[i] = weightValue(dataBlock, multiIndex, i);
+    }
+
+    vector<float> blend;
+    getBlendWeights(*tables, modeValue, directionValue, envelopeValue, weights, blend);
+
+    MPointArray points;
+    itGeo.allPositions(points);
+
+    if (points.length() != memberIndices.size()) { return MStatus::kSuccess; }
+
+    parallelForRange((int) memberIndices.size(), DEFORM_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int k = first; k < last; k++)
+        {
+            int i = memberIndices[k];
+            float w = blend[i];
+
+            if (w == 0.0f) { continue; }
+
+            MPoint &pnt = points[k];
+            const float* reflected = reflectedPoints.data() + (size_t) i * 4;
+
+            pnt.x += (reflected[0] - pnt.x) * w;
+            pnt.y += (reflected[1] - pnt.y) * w;
+            pnt.z += (reflected[2] - pnt.z) * w;
+        }
+    });
+
+    itGeo.setAllPositions(points);
+
+    return MStatus::kSuccess;
+}
@@ -0,0 +1,114 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_DEFORMER_H
+#define POLY_SYMMETRY_DEFORMER_H
+
+#include "pointKernels.h"
+#include "symmetryTables.h"
+
+#include <memory>
+#include <vector>
+
+#include <maya/MDataBlock.h>
+#include <maya/MItGeometry.h>
+#include <maya/MMatrix.h>
+#include <maya/MObject.h>
+#include <maya/MPxDeformerNode.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MTypeId.h>
+
+#define DEFORMER_SYMMETRY_TABLES "symmetryTables"
+#define DEFORMER_REFERENCE_MESH "referenceMesh"
+#define DEFORMER_MODE "mode"
+#define DEFORMER_DIRECTION "direction"
+#define DEFORMER_AXIS "axis"
+#define DEFORMER_PLANE_TYPE "planeType"
+#define DEFORMER_PLANE_NORMAL "planeNormal"
+#define DEFORMER_PLANE_OFFSET "planeOffset"
+#define DEFORMER_PLANE_MATRIX "planeMatrix"
+
+using namespace std;
+
+enum SymmetryDeformerMode
+{
+    kFlipMode = 0,
+    kMirrorMode = 1
+};
+
+/* Where the plane the points are reflected across comes from, as with the -axis, -plane, and -frame flags. */
+enum SymmetryDeformerPlaneType
+{
+    kAxisPlane = 0,
+    kNormalPlane = 1,
+    kFramePlane = 2
+};
+
+/*
+    Flips or mirrors the input mesh live in the DG, using the tables of a
+    polySymmetryData node connected to `symmetryTables`. In mirror mode the
+    side chosen by `direction` is kept and the other side is replaced by its
+    reflection. When a mesh is connected to `referenceMesh`, offsets from the
+    reference are reflected instead of positions, which symmetrizes a shape
+    without moving the reference's own asymmetry.
+
+    Points are reflected across the plane normal to `axis` through the 
+    origin of the mesh, the plane of `planeNormal` and `planeOffset` in its
+    object space, or the plane through the origin of the world space 
+    `planeMatrix` normal to its `axis`, as chosen by `planeType`.
+*/
+class PolySymmetryDeformer : public MPxDeformerNode
+{
+public:
+                        PolySymmetryDeformer();
+    virtual             ~PolySymmetryDeformer();
+
+    static  void*       creator();
+    static  MStatus     initialize();
+
+    virtual MStatus     deform(MDataBlock &dataBlock, MItGeometry &itGeo, const MMatrix &matrix, unsigned int multiIndex);
+
+    /*
+        Fills `blend` with how much each point moves towards its reflection:
+        the painted weight times the envelope on replaced points and 0 on the
+        points that are kept. Shared with the GPU override.
+    */
+    static void         getBlendWeights(
+                            const SymmetryTables &tables,
+                            int mode,
+                            int direction,
+                            float envelope,
+                            const vector<float> &weights,
+                            vector<float> &blend
+                        );
+
+    static MStatus      getSymmetryTables(MDataBlock &dataBlock, shared_ptr<const SymmetryTables> &tables);
+
+    /* Plane in the object space of the geometry, whose world matrix is `matrix`. Fails if the frame is scaled flat. */
+    static MStatus      getMirrorPlane(MDataBlock &dataBlock, const MMatrix &matrix, MirrorPlane &plane);
+
+public:
+    static MObject      symmetryTables;
+    static MObject      referenceMesh;
+    static MObject      mode;
+    static MObject      direction;
+    static MObject      axis;
+    static MObject      planeType;
+    static MObject      planeNormal;
+    static MObject      planeOffset;
+    static MObject      planeMatrix;
+
+    static MString      NODE_NAME;
+    static MTypeId      NODE_ID;
+
+private:
+    virtual void        reportProblem(int problem);
+
+private:
+    int                 reportedProblem = 0;
+};
+
+#endif
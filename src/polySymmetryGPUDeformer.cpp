@@ -0,0 +1,501 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "polySymmetryGPUDeformer.h"
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER
+
+#include "polySymmetryDeformer.h"
+
+#include <memory>
+#include <vector>
+
+#include <clew/clew_cl.h>
+
+#include <maya/MArrayDataHandle.h>
+#include <maya/MDataBlock.h>
+#include <maya/MDataHandle.h>
+#include <maya/MEvaluationNode.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnGeometryFilter.h>
+#include <maya/MFnMesh.h>
+#include <maya/MFnSet.h>
+#include <maya/MFnSingleIndexedComponent.h>
+#include <maya/MGPUDeformerRegistry.h>
+#include <maya/MIntArray.h>
+#include <maya/MOpenCLAutoPtr.h>
+#include <maya/MOpenCLInfo.h>
+#include <maya/MPlug.h>
+#include <maya/MPxDeformerNode.h>
+#include <maya/MPxGPUDeformer.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+
+using namespace std;
+
+#define KERNEL_NAME "polySymmetryDeform"
+
+/*
+    Same math as the CPU deformer: each point moves towards the reflection
+    of its opposite (or of its opposite's offset from the reference) by its
+    blend weight. Positions are packed float3.
+*/
+static const char* KERNEL_SOURCE = R"(
+__kernel void polySymmetryDeform(
+    __global float* finalPositions,
+    __global const float* initialPositions,
+    __global const int* symmetry,
+    __global const float* blend,
+    __global const float* referencePositions,
+    const int useReference,
+    const int axis,
+    const uint positionCount)
+{
+    unsigned int i = get_global_id(0);
+
+    if (i >= positionCount) { return; }
+
+    int o = symmetry[i];
+    float w = blend[i];
+
+    for (int c = 0; c < 3; c++)
+    {
+        float p = initialPositions[i * 3 + c];
+        float v = initialPositions[o * 3 + c];
+
+        if (useReference) { v -= referencePositions[o * 3 + c]; }
+        if (c == axis) { v = -v; }
+        if (useReference) { v += referencePositions[i * 3 + c]; }
+
+        finalPositions[i * 3 + c] = p + (v - p) * w;
+    }
+}
+)";
+
+class PolySymmetryGPUDeformerInfo : public MGPUDeformerRegistrationInfo
+{
+public:
+    PolySymmetryGPUDeformerInfo() {}
+    virtual ~PolySymmetryGPUDeformerInfo() {}
+
+    virtual MPxGPUDeformer* createGPUDeformer()
+    {
+        return new PolySymmetryGPUDeformer();
+    }
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER_DATA
+    virtual bool validateNodeInGraph(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages)
+    {
+        return PolySymmetryGPUDeformer::validateNodeInGraph(dataBlock, evaluationNode, plug, messages);
+    }
+
+    virtual bool validateNodeValues(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages)
+    {
+        return PolySymmetryGPUDeformer::validateNodeValues(dataBlock, evaluationNode, plug, messages);
+    }
+#else
+    virtual bool validateNode(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages)
+    {
+        return (
+            PolySymmetryGPUDeformer::validateNodeInGraph(dataBlock, evaluationNode, plug, messages)
+            && PolySymmetryGPUDeformer::validateNodeValues(dataBlock, evaluationNode, plug, messages)
+        );
+    }
+#endif
+};
+
+/* Replaces `buffer` with a read-only device copy of `size` bytes at `data`. */
+static MStatus uploadBuffer(MAutoCLMem &buffer, const void* data, size_t size)
+{
+    cl_int err = CL_SUCCESS;
+
+    buffer.attach(clCreateBuffer(
+        MOpenCLInfo::getOpenCLContext(),
+        CL_MEM_COPY_HOST_PTR | CL_MEM_READ_ONLY,
+        size,
+        (void*) data,
+        &err
+    ));
+
+    return err == CL_SUCCESS ? MStatus::kSuccess : MStatus::kFailure;
+}
+
+PolySymmetryGPUDeformer::PolySymmetryGPUDeformer() {}
+
+PolySymmetryGPUDeformer::~PolySymmetryGPUDeformer()
+{
+    this->terminate();
+}
+
+MGPUDeformerRegistrationInfo* PolySymmetryGPUDeformer::getGPUDeformerInfo()
+{
+    static PolySymmetryGPUDeformerInfo info;
+    return &info;
+}
+
+bool PolySymmetryGPUDeformer::validateNodeInGraph(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages)
+{
+    return true;
+}
+
+/* 
+    Nodes without usable symmetry data are left to the CPU, which passes the
+    geometry through. The kernel only reflects across the planes normal to
+    an axis, so nodes mirroring across any other plane are left to the CPU.
+*/
+bool PolySymmetryGPUDeformer::validateNodeValues(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages)
+{
+    shared_ptr<const SymmetryTables> tables;
+
+    if (!PolySymmetryDeformer::getSymmetryTables(dataBlock, tables))
+    {
+        if (messages != nullptr) { messages->append("polySymmetryDeformer has no symmetry data connected."); }
+        return false;
+    }
+
+    if (dataBlock.inputValue(PolySymmetryDeformer::planeType).asShort() != kAxisPlane)
+    {
+        if (messages != nullptr) { messages->append("polySymmetryDeformer only mirrors across an axis on the GPU."); }
+        return false;
+    }
+
+    return true;
+}
+
+void PolySymmetryGPUDeformer::terminate()
+{
+    this->kernel.reset();
+    this->symmetryBuffer.reset();
+    this->blendBuffer.reset();
+    this->referenceBuffer.reset();
+
+    this->uploadedTables.reset();
+    this->numberOfElements = 0;
+    this->useReference = false;
+}
+
+bool PolySymmetryGPUDeformer::buildKernel()
+{
+    cl_int err = CL_SUCCESS;
+
+    cl_context context = MOpenCLInfo::getOpenCLContext();
+    cl_device_id device = MOpenCLInfo::getOpenCLDeviceId();
+
+    cl_program program = clCreateProgramWithSource(context, 1, &KERNEL_SOURCE, nullptr, &err);
+
+    if (err != CL_SUCCESS) { return false; }
+
+    err = clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr);
+
+    if (err != CL_SUCCESS)
+    {
+        clReleaseProgram(program);
+        return false;
+    }
+
+    // The kernel keeps its own reference to the program.
+    cl_kernel newKernel = clCreateKernel(program, KERNEL_NAME, &err);
+    clReleaseProgram(program);
+
+    if (err != CL_SUCCESS) { return false; }
+
+    this->kernel.attach(newKernel);
+
+    return true;
+}
+
+MStatus PolySymmetryGPUDeformer::updateSymmetryBuffer(const shared_ptr<const SymmetryTables> &tables)
+{
+    const vector<int> &vertexSymmetry = tables->vertexSymmetry;
+
+    MStatus status = uploadBuffer(this->symmetryBuffer, vertexSymmetry.data(), vertexSymmetry.size() * sizeof(int));
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    this->uploadedTables = tables;
+
+    return MStatus::kSuccess;
+}
+
+/*
+    Flags the vertices of the geometry that `outputPlug` belongs to that are
+    in the deformer set, which are the vertices the CPU deformer iterates.
+    Every vertex is a member when the deformer has no set.
+*/
+static void getDeformerMembers(const MPlug &outputPlug, unsigned numberOfElements, vector<char> &isMember)
+{
+    MStatus status;
+
+    MFnGeometryFilter fnDeformer(outputPlug.node());
+    MObject deformerSet = fnDeformer.deformerSet(&status);
+
+    MDagPath shape;
+
+    if (!status || deformerSet.isNull() || !fnDeformer.getPathAtIndex(outputPlug.logicalIndex(), shape))
+    {
+        isMember.assign(numberOfElements, 1);
+        return;
+    }
+
+    shape.extendToShape();
+
+    isMember.assign(numberOfElements, 0);
+
+    MSelectionList members;
+    MFnSet(deformerSet).getMembers(members, true);
+
+    for (unsigned i = 0; i < members.length(); i++)
+    {
+        MDagPath path;
+        MObject components;
+
+        members.getDagPath(i, path, components);
+        path.extendToShape();
+
+        if (!(path.node() == shape.node())) { continue; }
+
+        if (components.isNull())
+        {
+            isMember.assign(numberOfElements, 1);
+            return;
+        }
+
+        MIntArray elements;
+        MFnSingleIndexedComponent(components).getElements(elements);
+
+        for (unsigned e = 0; e < elements.length(); e++)
+        {
+            if (elements[e] >= 0 && (unsigned) elements[e] < numberOfElements) { isMember[elements[e]] = 1; }
+        }
+    }
+}
+
+/*
+    Reads the weights of the geometry that `outputPlug` belongs to, the same
+    way the CPU deformer does. Vertices outside the deformer set have no
+    weight, and members without a painted weight have the default of 1.
+*/
+MStatus PolySymmetryGPUDeformer::updateBlendBuffer(MDataBlock &dataBlock, const MPlug &outputPlug, const SymmetryTables &tables)
+{
+    MStatus status;
+
+    vector<char> isMember;
+    getDeformerMembers(outputPlug, this->numberOfElements, isMember);
+
+    vector<float> weights(this->numberOfElements, 0.0f);
+
+    for (unsigned i = 0; i < this->numberOfElements; i++)
+    {
+        if (isMember[i]) { weights[i] = 1.0f; }
+    }
+
+    MArrayDataHandle weightListHandle = dataBlock.outputArrayValue(MPxDeformerNode::weightList, &status);
+
+    if (status && weightListHandle.jumpToElement(outputPlug.logicalIndex()))
+    {
+        MArrayDataHandle weightsHandle = weightListHandle.inputValue().child(MPxDeformerNode::weights);
+
+        unsigned numberOfWeights = weightsHandle.elementCount();
+
+        for (unsigned i = 0; i < numberOfWeights; i++, weightsHandle.next())
+        {
+            unsigned index = weightsHandle.elementIndex();
+
+            if (index < this->numberOfElements && isMember[index])
+            {
+                weights[index] = weightsHandle.inputValue().asFloat();
+            }
+        }
+    }
+
+    float envelopeValue = dataBlock.inputValue(MPxDeformerNode::envelope).asFloat();
+    int modeValue = dataBlock.inputValue(PolySymmetryDeformer::mode).asShort();
+    int directionValue = dataBlock.inputValue(PolySymmetryDeformer::direction).asShort();
+
+    vector<float> blend;
+    PolySymmetryDeformer::getBlendWeights(tables, modeValue, directionValue, envelopeValue, weights, blend);
+
+    return uploadBuffer(this->blendBuffer, blend.data(), blend.size() * sizeof(float));
+}
+
+MStatus PolySymmetryGPUDeformer::updateReferenceBuffer(MDataBlock &dataBlock)
+{
+    MStatus status;
+
+    this->useReference = false;
+
+    MObject referenceObject = dataBlock.inputValue(PolySymmetryDeformer::referenceMesh).asMesh();
+
+    if (referenceObject.isNull()) { return MStatus::kSuccess; }
+
+    MFnMesh fnReferenceMesh(referenceObject);
+
+    if ((unsigned) fnReferenceMesh.numVertices() != this->numberOfElements) { return MStatus::kSuccess; }
+
+    const float* referencePoints = fnReferenceMesh.getRawPoints(&status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = uploadBuffer(this->referenceBuffer, referencePoints, (size_t) this->numberOfElements * 3 * sizeof(float));
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    this->useReference = true;
+
+    return MStatus::kSuccess;
+}
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER_DATA
+MPxGPUDeformer::DeformerStatus PolySymmetryGPUDeformer::evaluate(
+    MDataBlock &dataBlock,
+    const MEvaluationNode &evaluationNode,
+    const MPlug &outputPlug,
+    const MGPUDeformerData &inputData,
+    MGPUDeformerData &outputData
+) {
+    MGPUDeformerBuffer inputDeformerBuffer = inputData.getBuffer(MPxGPUDeformer::sPositionsName());
+
+    const MAutoCLMem inputBuffer = inputDeformerBuffer.buffer();
+    const MAutoCLEvent inputEvent = inputDeformerBuffer.bufferReadyEvent();
+    unsigned int numElements = inputDeformerBuffer.elementCount();
+
+    MGPUDeformerBuffer outputDeformerBuffer = this->createOutputBuffer(inputDeformerBuffer);
+
+    MAutoCLMem outputBuffer = outputDeformerBuffer.buffer();
+    MAutoCLEvent outputEvent;
+
+    DeformerStatus result = this->enqueueKernel(dataBlock, evaluationNode, outputPlug, numElements, inputBuffer, inputEvent, outputBuffer, outputEvent);
+
+    if (result != MPxGPUDeformer::kDeformerSuccess) { return result; }
+
+    outputDeformerBuffer.setBufferReadyEvent(outputEvent);
+    outputData.setBuffer(outputDeformerBuffer);
+
+    return result;
+}
+#else
+MPxGPUDeformer::DeformerStatus PolySymmetryGPUDeformer::evaluate(
+    MDataBlock &dataBlock,
+    const MEvaluationNode &evaluationNode,
+    const MPlug &outputPlug,
+    unsigned int numElements,
+    const MAutoCLMem inputBuffer,
+    const MAutoCLEvent inputEvent,
+    MAutoCLMem outputBuffer,
+    MAutoCLEvent &outputEvent
+) {
+    return this->enqueueKernel(dataBlock, evaluationNode, outputPlug, numElements, inputBuffer, inputEvent, outputBuffer, outputEvent);
+}
+#endif
+
+/* Reflects `inputBuffer` into `outputBuffer`, uploading the tables and weights that changed first. */
+MPxGPUDeformer::DeformerStatus PolySymmetryGPUDeformer::enqueueKernel(
+    MDataBlock &dataBlock,
+    const MEvaluationNode &evaluationNode,
+    const MPlug &outputPlug,
+    unsigned int numElements,
+    const MAutoCLMem &inputBuffer,
+    const MAutoCLEvent &inputEvent,
+    MAutoCLMem &outputBuffer,
+    MAutoCLEvent &outputEvent
+) {
+    shared_ptr<const SymmetryTables> tables;
+
+    if (!PolySymmetryDeformer::getSymmetryTables(dataBlock, tables) || tables->vertexSymmetry.size() != numElements)
+    {
+        return MPxGPUDeformer::kDeformerFailure;
+    }
+
+    // The plane type can be changed after the node was validated.
+    if (dataBlock.inputValue(PolySymmetryDeformer::planeType).asShort() != kAxisPlane)
+    {
+        return MPxGPUDeformer::kDeformerFailure;
+    }
+
+    if (this->kernel.isNull() && !this->buildKernel())
+    {
+        return MPxGPUDeformer::kDeformerFailure;
+    }
+
+    bool elementsChanged = numElements != this->numberOfElements;
+    bool tablesChanged = tables != this->uploadedTables;
+
+    this->numberOfElements = numElements;
+
+    if (elementsChanged || tablesChanged)
+    {
+        if (!this->updateSymmetryBuffer(tables)) { return MPxGPUDeformer::kDeformerFailure; }
+    }
+
+    if (
+        elementsChanged || tablesChanged || this->blendBuffer.isNull()
+        || evaluationNode.dirtyPlugExists(MPxDeformerNode::weightList)
+        || evaluationNode.dirtyPlugExists(MPxDeformerNode::envelope)
+        || evaluationNode.dirtyPlugExists(PolySymmetryDeformer::mode)
+        || evaluationNode.dirtyPlugExists(PolySymmetryDeformer::direction)
+    ) {
+        if (!this->updateBlendBuffer(dataBlock, outputPlug, *tables)) { return MPxGPUDeformer::kDeformerFailure; }
+    }
+
+    if (elementsChanged || evaluationNode.dirtyPlugExists(PolySymmetryDeformer::referenceMesh))
+    {
+        if (!this->updateReferenceBuffer(dataBlock)) { return MPxGPUDeformer::kDeformerFailure; }
+    }
+
+    cl_int useReferenceValue = this->useReference ? 1 : 0;
+    cl_int axisValue = dataBlock.inputValue(PolySymmetryDeformer::axis).asShort();
+    cl_uint positionCount = numElements;
+
+    // Without a reference the input positions stand in for the unused argument.
+    const cl_mem* referenceArgument = this->useReference ? this->referenceBuffer.getReadOnlyRef() : inputBuffer.getReadOnlyRef();
+
+    cl_int err = CL_SUCCESS;
+    cl_uint argumentIndex = 0;
+
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_mem), (void*) outputBuffer.getReadOnlyRef());
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_mem), (void*) inputBuffer.getReadOnlyRef());
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_mem), (void*) this->symmetryBuffer.getReadOnlyRef());
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_mem), (void*) this->blendBuffer.getReadOnlyRef());
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_mem), (void*) referenceArgument);
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_int), (void*) &useReferenceValue);
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_int), (void*) &axisValue);
+    err |= clSetKernelArg(this->kernel.get(), argumentIndex++, sizeof(cl_uint), (void*) &positionCount);
+
+    if (err != CL_SUCCESS) { return MPxGPUDeformer::kDeformerFailure; }
+
+    size_t workGroupSize = 0;
+    size_t returnSize = 0;
+
+    err = clGetKernelWorkGroupInfo(
+        this->kernel.get(),
+        MOpenCLInfo::getOpenCLDeviceId(),
+        CL_KERNEL_WORK_GROUP_SIZE,
+        sizeof(size_t),
+        &workGroupSize,
+        &returnSize
+    );
+
+    size_t localWorkSize = (err == CL_SUCCESS && returnSize > 0 && workGroupSize > 0) ? workGroupSize : 256;
+    size_t globalWorkSize = ((numElements + localWorkSize - 1) / localWorkSize) * localWorkSize;
+
+    cl_event events[1] = { 0 };
+    cl_uint numberOfEvents = 0;
+
+    if (inputEvent.get()) { events[numberOfEvents++] = inputEvent.get(); }
+
+    err = clEnqueueNDRangeKernel(
+        MOpenCLInfo::getMayaDefaultOpenCLCommandQueue(),
+        this->kernel.get(),
+        1,
+        nullptr,
+        &globalWorkSize,
+        &localWorkSize,
+        numberOfEvents,
+        numberOfEvents ? events : nullptr,
+        outputEvent.getReferenceForAssignment()
+    );
+
+    return err == CL_SUCCESS ? MPxGPUDeformer::kDeformerSuccess : MPxGPUDeformer::kDeformerFailure;
+}
+
+#endif
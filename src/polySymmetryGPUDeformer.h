@@ -0,0 +1,116 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_GPU_DEFORMER_H
+#define POLY_SYMMETRY_GPU_DEFORMER_H
+
+#include <maya/MTypes.h>
+
+// GPU overrides first shipped with Maya 2016, with a single validateNode and
+// an evaluate that takes the OpenCL buffers. Maya 2020 split the validation
+// in two and passes the buffers to evaluate as MGPUDeformerData instead.
+#if MAYA_API_VERSION >= 201600
+#define POLY_SYMMETRY_GPU_DEFORMER
+#endif
+
+#if MAYA_API_VERSION >= 202000
+#define POLY_SYMMETRY_GPU_DEFORMER_DATA
+#endif
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER
+
+#include "symmetryTables.h"
+
+#include <memory>
+
+#include <clew/clew_cl.h>
+
+#include <maya/MDataBlock.h>
+#include <maya/MEvaluationNode.h>
+#include <maya/MGPUDeformerRegistry.h>
+#include <maya/MOpenCLAutoPtr.h>
+#include <maya/MPlug.h>
+#include <maya/MPxGPUDeformer.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+
+using namespace std;
+
+/*
+    OpenCL implementation of polySymmetryDeformer, used by the GPU override
+    of the evaluation manager. The symmetry table and the blend weights live
+    on the device and are only uploaded again when the attributes they come
+    from are dirty, so a playback frame is a single kernel launch.
+*/
+class PolySymmetryGPUDeformer : public MPxGPUDeformer
+{
+public:
+                            PolySymmetryGPUDeformer();
+    virtual                 ~PolySymmetryGPUDeformer();
+
+#ifdef POLY_SYMMETRY_GPU_DEFORMER_DATA
+    virtual DeformerStatus  evaluate(
+                                MDataBlock &dataBlock,
+                                const MEvaluationNode &evaluationNode,
+                                const MPlug &outputPlug,
+                                const MGPUDeformerData &inputData,
+                                MGPUDeformerData &outputData
+                            );
+#else
+    virtual DeformerStatus  evaluate(
+                                MDataBlock &dataBlock,
+                                const MEvaluationNode &evaluationNode,
+                                const MPlug &outputPlug,
+                                unsigned int numElements,
+                                const MAutoCLMem inputBuffer,
+                                const MAutoCLEvent inputEvent,
+                                MAutoCLMem outputBuffer,
+                                MAutoCLEvent &outputEvent
+                            );
+#endif
+
+    virtual void            terminate();
+
+    static MGPUDeformerRegistrationInfo* getGPUDeformerInfo();
+
+    static bool             validateNodeInGraph(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages);
+    static bool             validateNodeValues(MDataBlock &dataBlock, const MEvaluationNode &evaluationNode, const MPlug &plug, MStringArray* messages);
+
+public:
+    static MString          REGISTRANT_ID;
+
+private:
+    virtual DeformerStatus  enqueueKernel(
+                                MDataBlock &dataBlock,
+                                const MEvaluationNode &evaluationNode,
+                                const MPlug &outputPlug,
+                                unsigned int numElements,
+                                const MAutoCLMem &inputBuffer,
+                                const MAutoCLEvent &inputEvent,
+                                MAutoCLMem &outputBuffer,
+                                MAutoCLEvent &outputEvent
+                            );
+
+    virtual bool            buildKernel();
+
+    virtual MStatus         updateSymmetryBuffer(const shared_ptr<const SymmetryTables> &tables);
+    virtual MStatus         updateBlendBuffer(MDataBlock &dataBlock, const MPlug &outputPlug, const SymmetryTables &tables);
+    virtual MStatus         updateReferenceBuffer(MDataBlock &dataBlock);
+
+private:
+    unsigned int            numberOfElements = 0;
+    bool                    useReference = false;
+
+    shared_ptr<const SymmetryTables> uploadedTables;
+
+    MAutoCLKernel           kernel;
+    MAutoCLMem              symmetryBuffer;
+    MAutoCLMem              blendBuffer;
+    MAutoCLMem              referenceBuffer;
+};
+
+#endif
+
+#endif
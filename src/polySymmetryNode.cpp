@@ -5,7 +5,9 @@
 
 #include "meshData.h"
 #include "polySymmetryNode.h"
+#include "polySymmetryTableData.h"
 
+#include <memory>
 #include <string>
 
 #include <maya/MDataBlock.h>
@@ -14,6 +16,7 @@
 #include <maya/MFnMesh.h>
 #include <maya/MFnNumericAttribute.h>
 #include <maya/MFnNumericData.h>
+#include <maya/MFnPluginData.h>
 #include <maya/MFnTypedAttribute.h>
 #include <maya/MGlobal.h>
 #include <maya/MIntArray.h>
@@ -36,7 +39,10 @@ MObject PolySymmetryNode::edgeSides;
 MObject PolySymmetryNode::faceSides;
 MObject PolySymmetryNode::vertexSides;
 
+MObject PolySymmetryNode::symmetryTables;
+
 MObject PolySymmetryNode::vertexChecksum;
+MObject PolySymmetryNode::cacheKey;
 
 PolySymmetryNode::PolySymmetryNode() {}
 PolySymmetryNode::~PolySymmetryNode() {}
@@ -80,10 +86,16 @@ MStatus PolySymmetryNode::initialize()
 
     vertexSides = t.create(VERTEX_SIDES, "vs", MFnData::kIntArray, MObject::kNullObj, &status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    symmetryTables = t.create(SYMMETRY_TABLES, "stb", PolySymmetryTableData::DATA_ID, MObject::kNullObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
     
     vertexChecksum = n.create(VERTEX_CHECKSUM, "vc", MFnNumericData::kLong, -1, &status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    cacheKey = t.create(CACHE_KEY, "ck", MFnData::kString, MObject::kNullObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     addAttribute(numberOfEdges);
     addAttribute(numberOfFaces);
     addAttribute(numberOfVertices);
@@ -96,7 +108,10 @@ MStatus PolySymmetryNode::initialize()
     addAttribute(faceSides);
     addAttribute(vertexSides);
 
+    addAttribute(symmetryTables);
+
     addAttribute(vertexChecksum);
+    addAttribute(cacheKey);
 
     return MStatus::kSuccess;    
 }
@@ -189,6 +204,112 @@ MStatus PolySymmetryNode::getValues(MFnDependencyNode &fnNode, const char* attri
 }
 
 
+MStatus PolySymmetryNode::setSymmetryTables(MObject &node, const SymmetryTables &tables)
+{
+    MStatus status;
+    MFnDependencyNode fnNode(node);
+
+    MPlug plug = fnNode.findPlug(SYMMETRY_TABLES, false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MFnPluginData fnData;
+    MObject data = fnData.create(PolySymmetryTableData::DATA_ID, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    PolySymmetryTableData* tableData = (PolySymmetryTableData*) fnData.data(&status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = tableData->setTables(tables);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = plug.setMObject(data);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    return MStatus::kSuccess;
+}
+
+
+/*
+    Reads the packed tables if the node has them. Nodes saved by earlier 
+    versions of the plugin only have the six int array attributes instead.
+*/
+MStatus PolySymmetryNode::getSymmetryTables(MObject &node, shared_ptr<const SymmetryTables> &tables)
+{
+    MStatus status;
+    MFnDependencyNode fnNode(node);
+
+    MPlug plug = fnNode.findPlug(SYMMETRY_TABLES, true, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MObject data = plug.asMObject();
+    MFnPluginData fnData(data, &status);
+
+    if (status)
+    {
+        PolySymmetryTableData* tableData = (PolySymmetryTableData*) fnData.data(&status);
+
+        if (status && tableData != NULL && !tableData->isEmpty())
+        {
+            status = tableData->getTables(tables);
+
+            if (!status)
+            {
+                MString errorMsg("Cannot read the symmetry tables of ^1s. They may have been saved by a newer version of the plugin.");
+                errorMsg.format(errorMsg, fnNode.name());
+
+                MGlobal::displayError(errorMsg);
+            }
+
+            return status;
+        }
+    }
+
+    shared_ptr<SymmetryTables> legacyTables = make_shared<SymmetryTables>();
+
+    status = PolySymmetryNode::getValues(fnNode, EDGE_SYMMETRY, legacyTables->edgeSymmetry);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = PolySymmetryNode::getValues(fnNode, FACE_SYMMETRY, legacyTables->faceSymmetry);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = PolySymmetryNode::getValues(fnNode, VERTEX_SYMMETRY, legacyTables->vertexSymmetry);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = PolySymmetryNode::getValues(fnNode, EDGE_SIDES, legacyTables->edgeSides);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = PolySymmetryNode::getValues(fnNode, FACE_SIDES, legacyTables->faceSides);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = PolySymmetryNode::getValues(fnNode, VERTEX_SIDES, legacyTables->vertexSides);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    tables = legacyTables;
+
+    return MStatus::kSuccess;
+}
+
+
+MStatus PolySymmetryNode::setCacheKey(MObject &node, const string &key)
+{
+    MStatus status;
+    MFnDependencyNode fnNode(node);
+
+    MPlug plug = fnNode.findPlug(CACHE_KEY, false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = plug.setString(MString(key.c_str()));
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    return MStatus::kSuccess;
+}
+
+
+/*
+    Reads the key from the cacheKey attribute, which takes a single plug 
+    read. Nodes saved by earlier versions of the plugin do not have it, so 
+    the key is built from the mesh description attributes instead.
+*/
 MStatus PolySymmetryNode::getCacheKey(MObject &node, string &key)
 {
     MStatus status;
@@ -200,6 +321,19 @@ MStatus PolySymmetryNode::getCacheKey(MObject &node, string &key)
 
     MFnDependencyNode fnNode(node);
 
+    MPlug cacheKeyPlug = fnNode.findPlug(PolySymmetryNode::cacheKey, true, &status);
+
+    if (status)
+    {
+        MString cacheKeyValue = cacheKeyPlug.asString(&status);
+
+        if (status && cacheKeyValue.length() > 0)
+        {
+            key = cacheKeyValue.asChar();
+            return MStatus::kSuccess;
+        }
+    }
+
     PolySymmetryNode::getValue(fnNode, NUMBER_OF_EDGES, numberOfEdges);
     PolySymmetryNode::getValue(fnNode, NUMBER_OF_FACES, numberOfFaces);
     PolySymmetryNode::getValue(fnNode, NUMBER_OF_VERTICES, numberOfVertices);
@@ -6,6 +6,9 @@
 #ifndef POLY_SYMMETRY_NODE_H
 #define POLY_SYMMETRY_NODE_H
 
+#include "symmetryTables.h"
+
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -23,6 +26,7 @@
 #define NUMBER_OF_VERTICES "numberOfVertices"
 
 #define VERTEX_CHECKSUM "vertexChecksum"
+#define CACHE_KEY "cacheKey"
 #define EDGE_SYMMETRY "edgeSymmetry"
 #define FACE_SYMMETRY "faceSymmetry"
 #define VERTEX_SYMMETRY "vertexSymmetry"
@@ -31,6 +35,8 @@
 #define FACE_SIDES "faceSides"
 #define VERTEX_SIDES "vertexSides"
 
+#define SYMMETRY_TABLES "symmetryTables"
+
 using namespace std;
 
 class PolySymmetryNode : MPxNode
@@ -49,10 +55,14 @@ public:
 
     static MStatus      setValues(MFnDependencyNode &fnNode, const char* attributeName, vector<int> &values);
     static MStatus      getValues(MFnDependencyNode &fnNode, const char* attributeName, vector<int> &values);
+
+    static MStatus      setSymmetryTables(MObject &node, const SymmetryTables &tables);
+    static MStatus      getSymmetryTables(MObject &node, shared_ptr<const SymmetryTables> &tables);
     
     static MStatus      onInitializePlugin();
     static MStatus      onUninitializePlugin();
 
+    static MStatus      setCacheKey(MObject &node, const string &key);
     static MStatus      getCacheKey(MObject &node, string &key);
     static MStatus      getCacheKeyFromMesh(MDagPath &node, string &key);
 
@@ -69,7 +79,10 @@ public:
     static MObject      faceSides;
     static MObject      vertexSides;
 
+    static MObject      symmetryTables;
+
     static MObject      vertexChecksum;
+    static MObject      cacheKey;
     
     static MString      NODE_NAME;
     static MTypeId      NODE_ID;
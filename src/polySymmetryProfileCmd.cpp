@@ -0,0 +1,151 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "polySymmetryProfileCmd.h"
+#include "profiling.h"
+
+#include <vector>
+
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MDoubleArray.h>
+#include <maya/MGlobal.h>
+#include <maya/MIntArray.h>
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+using namespace std;
+
+PolySymmetryProfileCommand::PolySymmetryProfileCommand()  {}
+PolySymmetryProfileCommand::~PolySymmetryProfileCommand() {}
+
+void* PolySymmetryProfileCommand::creator()
+{
+    return new PolySymmetryProfileCommand();
+}
+
+MSyntax PolySymmetryProfileCommand::getSyntax()
+{
+    MSyntax syntax;
+
+    syntax.addFlag(ENABLE_FLAG, ENABLE_LONG_FLAG, MSyntax::kBoolean);
+    syntax.addFlag(RESET_FLAG, RESET_LONG_FLAG);
+
+    syntax.addFlag(STAGES_FLAG, STAGES_LONG_FLAG);
+    syntax.addFlag(CALLS_FLAG, CALLS_LONG_FLAG);
+    syntax.addFlag(TIME_FLAG, TIME_LONG_FLAG);
+    syntax.addFlag(ALLOCATIONS_FLAG, ALLOCATIONS_LONG_FLAG);
+    syntax.addFlag(ALLOCATED_BYTES_FLAG, ALLOCATED_BYTES_LONG_FLAG);
+
+    syntax.enableQuery(true);
+    syntax.enableEdit(false);
+
+    return syntax;
+}
+
+MStatus PolySymmetryProfileCommand::doIt(const MArgList& argList)
+{
+    MStatus status;
+
+    MArgDatabase argsData(syntax(), argList, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    if (argsData.isQuery())
+    {
+        return this->doQueryAction(argsData);
+    }
+
+    if (argsData.isFlagSet(RESET_FLAG))
+    {
+        PolySymmetryProfiler::reset();
+    }
+
+    if (argsData.isFlagSet(ENABLE_FLAG))
+    {
+        bool enable = false;
+
+        status = argsData.getFlagArgument(ENABLE_FLAG, 0, enable);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        PolySymmetryProfiler::setRecording(enable);
+    }
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryProfileCommand::doQueryAction(MArgDatabase &argsData)
+{
+    const char* queryFlags[] = {
+        ENABLE_FLAG,
+        STAGES_FLAG,
+        CALLS_FLAG,
+        TIME_FLAG,
+        ALLOCATIONS_FLAG,
+        ALLOCATED_BYTES_FLAG
+    };
+
+    int numberOfQueryFlags = 0;
+
+    for (const char* flag : queryFlags)
+    {
+        if (argsData.isFlagSet(flag)) { numberOfQueryFlags++; }
+    }
+
+    if (numberOfQueryFlags != 1)
+    {
+        MString errorMsg("^1s: query exactly one of -enable, -stages, -calls, -time, -allocations, or -allocatedBytes.");
+        errorMsg.format(errorMsg, PolySymmetryProfileCommand::COMMAND_NAME);
+
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
+
+    if (argsData.isFlagSet(ENABLE_FLAG))
+    {
+        this->setResult(PolySymmetryProfiler::isRecording());
+        return MStatus::kSuccess;
+    }
+
+    vector<ProfileStage> stages;
+    PolySymmetryProfiler::getStages(stages);
+
+    if (argsData.isFlagSet(STAGES_FLAG))
+    {
+        MStringArray result;
+
+        for (ProfileStage &stage : stages) { result.append(MString(stage.name.c_str())); }
+
+        this->setResult(result);
+    } else if (argsData.isFlagSet(CALLS_FLAG)) {
+        MIntArray result;
+
+        for (ProfileStage &stage : stages) { result.append(stage.calls); }
+
+        this->setResult(result);
+    } else if (argsData.isFlagSet(TIME_FLAG)) {
+        MDoubleArray result;
+
+        for (ProfileStage &stage : stages) { result.append(stage.seconds * 1000.0); }
+
+        this->setResult(result);
+    } else if (argsData.isFlagSet(ALLOCATIONS_FLAG)) {
+        MIntArray result;
+
+        for (ProfileStage &stage : stages) { result.append(stage.allocations); }
+
+        this->setResult(result);
+    } else {
+        MDoubleArray result;
+
+        for (ProfileStage &stage : stages) { result.append(stage.allocatedBytes); }
+
+        this->setResult(result);
+    }
+
+    return MStatus::kSuccess;
+}
@@ -0,0 +1,62 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_PROFILE_CMD_H
+#define POLY_SYMMETRY_PROFILE_CMD_H
+
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+#define ENABLE_FLAG                 "-e"
+#define ENABLE_LONG_FLAG            "-enable"
+
+#define RESET_FLAG                  "-r"
+#define RESET_LONG_FLAG             "-reset"
+
+#define STAGES_FLAG                 "-st"
+#define STAGES_LONG_FLAG            "-stages"
+
+#define CALLS_FLAG                  "-c"
+#define CALLS_LONG_FLAG             "-calls"
+
+#define TIME_FLAG                   "-t"
+#define TIME_LONG_FLAG              "-time"
+
+#define ALLOCATIONS_FLAG            "-a"
+#define ALLOCATIONS_LONG_FLAG       "-allocations"
+
+#define ALLOCATED_BYTES_FLAG        "-ab"
+#define ALLOCATED_BYTES_LONG_FLAG   "-allocatedBytes"
+
+/*
+    Turns the recording of stage timings on and off, and returns the totals
+    recorded so far. Each query returns one value per stage, in the order of
+    the stage names returned by -q -stages. Times are in milliseconds.
+*/
+class PolySymmetryProfileCommand : public MPxCommand
+{
+public:
+                        PolySymmetryProfileCommand();
+    virtual             ~PolySymmetryProfileCommand();
+
+    static void*        creator();
+    static MSyntax      getSyntax();
+
+    virtual MStatus     doIt(const MArgList& argList);
+
+    virtual MStatus     doQueryAction(MArgDatabase &argsData);
+
+    virtual bool        isUndoable() const { return false; }
+    virtual bool        hasSyntax()  const { return true; }
+
+public:
+    static MString      COMMAND_NAME;
+};
+
+#endif
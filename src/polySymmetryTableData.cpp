@@ -0,0 +1,164 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "polySymmetryTableData.h"
+#include "symmetryTables.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <maya/MArgList.h>
+#include <maya/MPxData.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MTypeId.h>
+
+using namespace std;
+
+PolySymmetryTableData::PolySymmetryTableData() {}
+PolySymmetryTableData::~PolySymmetryTableData() {}
+
+void* PolySymmetryTableData::creator()
+{
+    return new PolySymmetryTableData();
+}
+
+/*
+    ASCII files store the byte count followed by the bytes packed four to an 
+    int, so the data reads back as plain MEL integers.
+*/
+MStatus PolySymmetryTableData::readASCII(const MArgList &args, unsigned &lastElement)
+{
+    MStatus status;
+
+    int numberOfBytes = args.asInt(lastElement++, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    if (numberOfBytes < 0) { return MStatus::kFailure; }
+
+    unsigned numberOfWords = ((unsigned) numberOfBytes + 3) / 4;
+
+    if (lastElement + numberOfWords > args.length()) { return MStatus::kFailure; }
+
+    vector<unsigned char> bytes(numberOfWords * 4);
+
+    for (unsigned i = 0; i < numberOfWords; i++)
+    {
+        uint32_t word = (uint32_t) args.asInt(lastElement++, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        bytes[i * 4]     = (unsigned char) word;
+        bytes[i * 4 + 1] = (unsigned char) (word >> 8);
+        bytes[i * 4 + 2] = (unsigned char) (word >> 16);
+        bytes[i * 4 + 3] = (unsigned char) (word >> 24);
+    }
+
+    bytes.resize(numberOfBytes);
+
+    this->encodedTables.swap(bytes);
+    this->decodedTables.reset();
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryTableData::readBinary(istream &in, unsigned length)
+{
+    vector<unsigned char> bytes(length);
+
+    if (length > 0)
+    {
+        in.read((char*) bytes.data(), length);
+
+        if (in.fail()) { return MStatus::kFailure; }
+    }
+
+    this->encodedTables.swap(bytes);
+    this->decodedTables.reset();
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryTableData::writeASCII(ostream &out)
+{
+    size_t numberOfBytes = this->encodedTables.size();
+
+    out << numberOfBytes;
+
+    for (size_t i = 0; i < numberOfBytes; i += 4)
+    {
+        uint32_t word = 0;
+
+        for (size_t j = 0; j < 4 && i + j < numberOfBytes; j++)
+        {
+            word |= (uint32_t) this->encodedTables[i + j] << (j * 8);
+        }
+
+        out << " " << (int) word;
+    }
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+MStatus PolySymmetryTableData::writeBinary(ostream &out)
+{
+    if (!this->encodedTables.empty())
+    {
+        out.write((const char*) this->encodedTables.data(), this->encodedTables.size());
+    }
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+void PolySymmetryTableData::copy(const MPxData &other)
+{
+    if (other.typeId() == PolySymmetryTableData::DATA_ID)
+    {
+        const PolySymmetryTableData &otherData = (const PolySymmetryTableData&) other;
+
+        this->encodedTables = otherData.encodedTables;
+        this->decodedTables = otherData.decodedTables;
+    }
+}
+
+MTypeId PolySymmetryTableData::typeId() const
+{
+    return PolySymmetryTableData::DATA_ID;
+}
+
+MString PolySymmetryTableData::name() const
+{
+    return PolySymmetryTableData::DATA_NAME;
+}
+
+MStatus PolySymmetryTableData::setTables(const SymmetryTables &tables)
+{
+    vector<unsigned char> bytes;
+
+    if (!encodeSymmetryTables(tables, bytes)) { return MStatus::kInvalidParameter; }
+
+    this->encodedTables.swap(bytes);
+    this->decodedTables = make_shared<const SymmetryTables>(tables);
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryTableData::getTables(shared_ptr<const SymmetryTables> &tables)
+{
+    if (!this->decodedTables)
+    {
+        shared_ptr<SymmetryTables> newTables = make_shared<SymmetryTables>();
+
+        if (!decodeSymmetryTables(this->encodedTables, *newTables)) { return MStatus::kFailure; }
+
+        this->decodedTables = newTables;
+    }
+
+    tables = this->decodedTables;
+
+    return MStatus::kSuccess;
+}
@@ -0,0 +1,61 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_TABLE_DATA_H
+#define POLY_SYMMETRY_TABLE_DATA_H
+
+#include "symmetryTables.h"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <maya/MArgList.h>
+#include <maya/MPxData.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MTypeId.h>
+
+using namespace std;
+
+/*
+    Attribute data holding all symmetry tables of a polySymmetryData node in 
+    the packed form written by `encodeSymmetryTables`. Scenes store the packed 
+    bytes as they are, and the tables are only decoded the first time a 
+    command asks for them.
+*/
+class PolySymmetryTableData : public MPxData
+{
+public:
+                        PolySymmetryTableData();
+    virtual             ~PolySymmetryTableData();
+
+    static void*        creator();
+
+    virtual MStatus     readASCII(const MArgList &args, unsigned &lastElement);
+    virtual MStatus     readBinary(istream &in, unsigned length);
+    virtual MStatus     writeASCII(ostream &out);
+    virtual MStatus     writeBinary(ostream &out);
+
+    virtual void        copy(const MPxData &other);
+
+    virtual MTypeId     typeId() const;
+    virtual MString     name() const;
+
+    virtual MStatus     setTables(const SymmetryTables &tables);
+    virtual MStatus     getTables(shared_ptr<const SymmetryTables> &tables);
+
+    virtual bool        isEmpty() const { return encodedTables.empty(); }
+
+public:
+    static MString      DATA_NAME;
+    static MTypeId      DATA_ID;
+
+private:
+    vector<unsigned char>               encodedTables;
+    shared_ptr<const SymmetryTables>    decodedTables;
+};
+
+#endif
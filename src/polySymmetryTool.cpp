@@ -7,28 +7,80 @@
 #include "polySymmetryCmd.h"
 #include "selection.h"
 #include "sceneCache.h"
+#include "symmetrySeeds.h"
+#include "symmetryTables.h"
 #include "util.h"
 
 #include <algorithm>
+#include <memory>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#include <maya/M3dView.h>
+#include <maya/MColor.h>
+#include <maya/MFnDependencyNode.h>
 #include <maya/MFnMesh.h>
+#include <maya/MFrameContext.h>
 #include <maya/MGlobal.h>
 #include <maya/MItSelectionList.h>
+#include <maya/MMatrix.h>
+#include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MObject.h>
 #include <maya/MPlug.h>
+#include <maya/MPointArray.h>
 #include <maya/MPxContext.h>
 #include <maya/MPxToolCommand.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
 #include <maya/MStatus.h>
+#include <maya/MUIDrawManager.h>
 
 using namespace std;
 
-PolySymmetryTool::PolySymmetryTool() {}
+// Overlay classes of the vertices, in the order they are drawn.
+enum FeedbackClass
+{
+    UNMATCHED_VERTEX,
+    CENTER_VERTEX,
+    LEFT_VERTEX,
+    RIGHT_VERTEX,
+    NUMBER_OF_FEEDBACK_CLASSES
+};
+
+static const MColor FEEDBACK_COLORS[NUMBER_OF_FEEDBACK_CLASSES] = {
+    MColor(0.75f, 0.75f, 0.25f),
+    MColor(0.5f, 0.5f, 0.5f),
+    MColor(0.5f, 0.5f, 0.75f),
+    MColor(0.75f, 0.5f, 0.5f)
+};
+
+#define FEEDBACK_POINT_SIZE     4.0f
+#define FEEDBACK_DEPTH_PRIORITY 5
+
+static int getFeedbackClass(PolySymmetryData &symmetryData, int vertexIndex)
+{
+    if (symmetryData.vertexSymmetryIndices[vertexIndex] == -1) { return UNMATCHED_VERTEX; }
+
+    switch (symmetryData.vertexSides[vertexIndex])
+    {
+        case 1:     return LEFT_VERTEX;
+        case -1:    return RIGHT_VERTEX;
+        default:    return CENTER_VERTEX;
+    }
+}
+
+PolySymmetryTool::PolySymmetryTool() 
+{
+    feedbackPoints.resize(NUMBER_OF_FEEDBACK_CLASSES);
+    classVertices.resize(NUMBER_OF_FEEDBACK_CLASSES);
+}
 
 PolySymmetryTool::~PolySymmetryTool() 
 {
+    this->removeMeshDirtyCallback();
+
     selectedComponents.clear();
     leftSideVertexIndices.clear();
 }
@@ -41,9 +93,10 @@ void PolySymmetryTool::toolOnSetup(MEvent &event)
     this->updateHelpString();
 }
 
+/* The callback holds the context, which can be deleted while the tool is off. */
 void PolySymmetryTool::toolOffCleanup()
 {
-
+    this->removeMeshDirtyCallback();
 }
 
 MStatus PolySymmetryTool::helpStateHasChanged(MEvent &event)
@@ -66,13 +119,18 @@ void PolySymmetryTool::deleteAction()
     if (selectedMesh.isValid())
     {
         this->symmetryData.reset();
+
+        if (selectedComponents.empty()) { this->loadSymmetryTables(); }
     } else {
         this->symmetryData.clear();
     }
 
+    this->numberOfSolvedComponents = 0;
+    this->updateAllVertices = true;
+
     this->updateHelpString();
     this->recalculateSymmetry();
-    this->updateDisplayColors();
+    this->updateFeedbackPoints();
 }
 
 void PolySymmetryTool::abortAction()
@@ -111,6 +169,14 @@ void PolySymmetryTool::completeAction()
                 this->selectedComponents.push_back(s);
                 this->leftSideVertexIndices.push_back(s.leftVertexIndex);
                 MGlobal::clearSelectionList();  
+
+                // The first seed replaces the loaded tables with a new solve.
+                if (this->selectedComponents.size() == 1 && this->loadedTables != nullptr)
+                {
+                    this->symmetryData.reset();
+                    this->numberOfSolvedComponents = 0;
+                    this->updateAllVertices = true;
+                }
             } else {
                 MGlobal::displayError("Must select a symmetrical edge, face, and vertex on both sides of the mesh, and a lone vertex on the left side of the mesh.");
                 this->updateHelpString();
@@ -119,11 +185,19 @@ void PolySymmetryTool::completeAction()
         }
     }
 
+    if (!continueSelecting && selectedComponents.empty() && this->loadedTables != nullptr)
+    {
+        // Nothing was changed, and the mesh already has its tables.
+        clearSelectedMesh();
+        MGlobal::executeCommand("escapeCurrentTool");
+        return;
+    }
+
     if (continueSelecting)
     {
         this->updateHelpString();
         this->recalculateSymmetry();
-        this->updateDisplayColors();
+        this->updateFeedbackPoints();
     } else {
         bool selectionIsComplete = true;
 
@@ -206,31 +280,52 @@ MStatus PolySymmetryTool::getSelectedMesh()
 
     if (this->selectedMesh.isValid())
     {
-        MObject obj;
-        bool cacheHit = PolySymmetryCache::getNodeFromCache(this->selectedMesh, obj);
+        meshData.unpackMesh(selectedMesh);
+        symmetryData.initialize(meshData);
+
+        vector<int> shellVertices;
+        int numberOfShells = findShells(meshData, vertexShells, shellVertices);
 
-        if (cacheHit)
+        verticesByShell.clear();
+        verticesByShell.resize(numberOfShells);
+
+        for (int i = 0; i < meshData.numberOfVertices; i++)
+        {
+            verticesByShell[vertexShells[i]].push_back(i);
+        }
+
+        numberOfSolvedComponents = 0;
+        updateAllVertices = true;
+
+        // Meshes that already have tables, on a node or in the registry, show them until a seed is added.
+        if (PolySymmetryCache::getSymmetryTables(this->selectedMesh, this->loadedTables))
         {
-            MString warningMsg("Symmetry data already exists for ^1s - ^2s.");
-            warningMsg.format(warningMsg, selectedMesh.partialPathName(), MFnDependencyNode(obj).name());
+            MObject node;
+            MString source = PolySymmetryCache::getNodeFromCache(this->selectedMesh, node)
+                ? MFnDependencyNode(node).name()
+                : MString("the symmetry registry");
 
-            MGlobal::displayError(warningMsg);
+            MString warningMsg("Showing the symmetry of ^1s from ^2s. Select a seed to solve it again.");
+            warningMsg.format(warningMsg, selectedMesh.partialPathName(), source);
 
-            this->abortAction();
-            return MStatus::kFailure;
+            MGlobal::displayWarning(warningMsg);
+
+            this->loadSymmetryTables();
         }
 
-        symmetryData.initialize(selectedMesh);
-        meshData.unpackMesh(selectedMesh);
-        MFnMesh meshFn(selectedMesh);
+        selectedShape.set(selectedMesh);
+        selectedShape.extendToShape();
 
-        status = meshFn.getVertexColors(originalVertexColors);
-        meshFn.clearColors();
+        status = this->refreshFeedbackPositions();
+        CHECK_MSTATUS_AND_RETURN_IT(status);
 
-        MPlug displayColorsPlug = meshFn.findPlug("displayColors");
+        // Edits and deformation of the mesh dirty its output, which moves the overlay.
+        MObject meshNode = selectedShape.node();
+        outMeshAttribute = MFnDependencyNode(meshNode).attribute("outMesh");
 
-        originalDisplayColors = displayColorsPlug.asBool();
-        status = displayColorsPlug.setBool(true);
+        // The tool is set up again each time it is entered, and the mesh may not have changed.
+        this->removeMeshDirtyCallback();
+        meshDirtyCallbackId = MNodeMessage::addNodeDirtyPlugCallback(meshNode, PolySymmetryTool::meshDirtyCallback, this, &status);
         CHECK_MSTATUS_AND_RETURN_IT(status);
 
         if (selectedMesh.node().hasFn(MFn::kMesh))
@@ -248,22 +343,67 @@ MStatus PolySymmetryTool::clearSelectedMesh()
 
     if (selectedMesh.isValid())
     {
-        MFnMesh meshFn(selectedMesh);
-        
-        status = meshFn.findPlug("displayColors").setBool(originalDisplayColors);
-        CHECK_MSTATUS_AND_RETURN_IT(status);
-
         selectedMesh.set(MDagPath());
         meshData.clear();
-    }    
 
-    status = displayColorModifier.undoIt();
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+        vertexShells.clear();
+        verticesByShell.clear();
+        affectedVertices.clear();
+
+        this->removeMeshDirtyCallback();
+
+        selectedShape.set(MDagPath());
+        outMeshAttribute = MObject();
+
+        vertexPoints.clear();
+        vertexPointsAreStale = false;
+        loadedTables.reset();
+
+        for (MPointArray &points : feedbackPoints) { points.clear(); }
+        for (vector<int> &vertices : classVertices) { vertices.clear(); }
+
+        vertexClasses.clear();
+        vertexClassSlots.clear();
+
+        M3dView::active3dView().refresh(false, true);
+    }    
 
     return MStatus::kSuccess;
 
 }
 
+void PolySymmetryTool::removeMeshDirtyCallback()
+{
+    if (meshDirtyCallbackId == 0) { return; }
+
+    MMessage::removeCallback(meshDirtyCallbackId);
+    meshDirtyCallbackId = 0;
+}
+
+/* Copies the loaded tables into the symmetry data, which the overlay is drawn from. */
+void PolySymmetryTool::loadSymmetryTables()
+{
+    if (this->loadedTables == nullptr) { return; }
+
+    const SymmetryTables &tables = *this->loadedTables;
+
+    if (tables.vertexSymmetry.size() != (size_t) meshData.numberOfVertices)
+    {
+        this->loadedTables.reset();
+        return;
+    }
+
+    this->symmetryData.vertexSymmetryIndices = tables.vertexSymmetry;
+    this->symmetryData.edgeSymmetryIndices = tables.edgeSymmetry;
+    this->symmetryData.faceSymmetryIndices = tables.faceSymmetry;
+
+    this->symmetryData.vertexSides = tables.vertexSides;
+    this->symmetryData.edgeSides = tables.edgeSides;
+    this->symmetryData.faceSides = tables.faceSides;
+
+    this->updateAllVertices = true;
+}
+
 void PolySymmetryTool::updateHelpString()
 {
     if (selectedMesh.isValid())
@@ -277,44 +417,244 @@ void PolySymmetryTool::updateHelpString()
     }
 }
 
+/*
+    Solves the components selected since the last call. Only the sides of the
+    mesh shells those components reached are recomputed, and the vertices 
+    whose overlay class changed are kept in `affectedVertices`.
+    After the mesh is picked or a selection is deleted, everything is solved.
+*/
 void PolySymmetryTool::recalculateSymmetry()
 {
     if (!selectedMesh.isValid()) { return; }
 
-    for (ComponentSelection &s : selectedComponents)
+    // Loaded tables are shown as they are until a seed is added.
+    if (selectedComponents.empty() && this->loadedTables != nullptr) { return; }
+
+    if (this->updateAllVertices)
+    {
+        for (ComponentSelection &s : selectedComponents)
+        {
+            this->symmetryData.findSymmetricalVertices(s);
+        }
+
+        this->symmetryData.findVertexSides(this->leftSideVertexIndices);
+        this->numberOfSolvedComponents = selectedComponents.size();
+
+        return;
+    }
+
+    vector<char> affectedShells(verticesByShell.size(), 0);
+    vector<int> &vertexSymmetry = this->symmetryData.vertexSymmetryIndices;
+
+    for (size_t c = this->numberOfSolvedComponents; c < selectedComponents.size(); c++)
+    {
+        ShellSymmetry shell;
+        this->symmetryData.findSymmetricalVertices(selectedComponents[c], &shell);
+
+        for (pair<int, int> &p : shell.vertexPairs)
+        {
+            affectedShells[vertexShells[p.first]] = 1;
+            affectedShells[vertexShells[p.second]] = 1;
+        }
+
+        int leftVertex = selectedComponents[c].leftVertexIndex;
+
+        if (leftVertex != -1)
+        {
+            affectedShells[vertexShells[leftVertex]] = 1;
+
+            if (vertexSymmetry[leftVertex] != -1) 
+            { 
+                affectedShells[vertexShells[vertexSymmetry[leftVertex]]] = 1; 
+            }
+        }
+    }
+
+    this->numberOfSolvedComponents = selectedComponents.size();
+
+    // The side of a vertex depends on the seeds on its shell and the mirrors of
+    // those seeds, so every seed that touches an affected shell takes part.
+    vector<int> seeds;
+
+    for (int &i : leftSideVertexIndices)
     {
-        this->symmetryData.findSymmetricalVertices(s);
+        if (i < 0 || i >= meshData.numberOfVertices) { continue; }
+
+        int j = vertexSymmetry[i];
+
+        if (affectedShells[vertexShells[i]] || (j != -1 && affectedShells[vertexShells[j]]))
+        {
+            seeds.push_back(i);
+        }
     }
 
-    this->symmetryData.findVertexSides(this->leftSideVertexIndices);
+    vector<int> vertices;
+
+    for (size_t shellIndex = 0; shellIndex < verticesByShell.size(); shellIndex++)
+    {
+        if (affectedShells[shellIndex])
+        {
+            vertices.insert(vertices.end(), verticesByShell[shellIndex].begin(), verticesByShell[shellIndex].end());
+        }
+    }
+
+    vector<int> oldClasses(vertices.size());
+
+    for (size_t k = 0; k < vertices.size(); k++)
+    {
+        oldClasses[k] = getFeedbackClass(this->symmetryData, vertices[k]);
+    }
+
+    this->symmetryData.updateVertexSides(seeds, vertices);
+
+    this->affectedVertices.clear();
+
+    for (size_t k = 0; k < vertices.size(); k++)
+    {
+        if (getFeedbackClass(this->symmetryData, vertices[k]) != oldClasses[k])
+        {
+            this->affectedVertices.push_back(vertices[k]);
+        }
+    }
 }
 
-void PolySymmetryTool::updateDisplayColors()
+/*
+    Sorts the vertex positions by overlay class for drawFeedback. After a 
+    full solve every vertex is sorted again; otherwise only the vertices in
+    `affectedVertices` move to their new class. Nothing is written to the
+    mesh, so the tool never dirties it or adds to the undo queue.
+*/
+void PolySymmetryTool::updateFeedbackPoints()
 {
     if (!selectedMesh.isValid()) { return; }
 
-    MIntArray vertexList(meshData.numberOfVertices);
-    MColorArray colors(meshData.numberOfVertices);
+    bool hasChanged = this->updateAllVertices || !this->affectedVertices.empty();
+
+    if (this->updateAllVertices || this->vertexClasses.size() != (size_t) meshData.numberOfVertices)
+    {
+        this->rebuildFeedbackPoints();
+    } else {
+        for (int &i : this->affectedVertices)
+        {
+            this->moveFeedbackPoint(i, getFeedbackClass(this->symmetryData, i));
+        }
+    }
+
+    this->updateAllVertices = false;
+    this->affectedVertices.clear();
+
+    if (hasChanged) { M3dView::active3dView().refresh(false, true); }
+}
+
+void PolySymmetryTool::rebuildFeedbackPoints()
+{
+    for (MPointArray &points : this->feedbackPoints) { points.clear(); }
+    for (vector<int> &vertices : this->classVertices) { vertices.clear(); }
+
+    this->vertexClasses.resize(meshData.numberOfVertices);
+    this->vertexClassSlots.resize(meshData.numberOfVertices);
 
     for (int i = 0; i < meshData.numberOfVertices; i++)
     {
-        float r = 0.5f;
-        float g = 0.5f;
-        float b = 0.5f;
+        int c = getFeedbackClass(this->symmetryData, i);
+
+        this->vertexClasses[i] = c;
+        this->vertexClassSlots[i] = (int) this->classVertices[c].size();
+
+        this->classVertices[c].push_back(i);
+        this->feedbackPoints[c].append(this->vertexPoints[i]);
+    }
+}
+
+/* The last vertex of the old class fills the slot that `vertexIndex` leaves. */
+void PolySymmetryTool::moveFeedbackPoint(int vertexIndex, int feedbackClass)
+{
+    int oldClass = this->vertexClasses[vertexIndex];
+
+    if (oldClass == feedbackClass) { return; }
+
+    vector<int> &oldVertices = this->classVertices[oldClass];
+    MPointArray &oldPoints = this->feedbackPoints[oldClass];
+
+    int slot = this->vertexClassSlots[vertexIndex];
+    int lastSlot = (int) oldVertices.size() - 1;
+    int lastVertex = oldVertices[lastSlot];
+
+    oldVertices[slot] = lastVertex;
+    oldPoints[slot] = oldPoints[lastSlot];
+    this->vertexClassSlots[lastVertex] = slot;
+
+    oldVertices.pop_back();
+    oldPoints.setLength((unsigned) lastSlot);
+
+    this->vertexClasses[vertexIndex] = feedbackClass;
+    this->vertexClassSlots[vertexIndex] = (int) this->classVertices[feedbackClass].size();
+
+    this->classVertices[feedbackClass].push_back(vertexIndex);
+    this->feedbackPoints[feedbackClass].append(this->vertexPoints[vertexIndex]);
+}
+
+/* Reads the world positions of the vertices again, after the mesh or one of its parents moved. */
+MStatus PolySymmetryTool::refreshFeedbackPositions()
+{
+    MStatus status;
+
+    MFnMesh meshFn(this->selectedShape);
+
+    status = meshFn.getPoints(this->vertexPoints, MSpace::kWorld);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    this->vertexPointsMatrix = this->selectedShape.inclusiveMatrix();
+    this->vertexPointsAreStale = false;
+
+    if (this->vertexPoints.length() != (unsigned) meshData.numberOfVertices) { return MStatus::kSuccess; }
+
+    for (size_t c = 0; c < this->classVertices.size(); c++)
+    {
+        const vector<int> &vertices = this->classVertices[c];
+        MPointArray &points = this->feedbackPoints[c];
 
-        if (this->symmetryData.vertexSides[i] == 1)
+        for (size_t k = 0; k < vertices.size(); k++)
         {
-            b = 0.75f;
-        } else if (this->symmetryData.vertexSides[i] == -1) {
-            r = 0.75f;
+            points[(unsigned) k] = this->vertexPoints[vertices[k]];
         }
+    }
+
+    return MStatus::kSuccess;
+}
 
-        vertexList[i] = i;
-        colors[i] = MColor(r, g, b);
+void PolySymmetryTool::meshDirtyCallback(MObject & /*node*/, MPlug &plug, void* clientData)
+{
+    PolySymmetryTool* tool = (PolySymmetryTool*) clientData;
+
+    if (plug.attribute() == tool->outMeshAttribute) { tool->vertexPointsAreStale = true; }
+}
+
+MStatus PolySymmetryTool::drawFeedback(MHWRender::MUIDrawManager &drawManager, const MHWRender::MFrameContext &frameContext)
+{
+    if (!selectedMesh.isValid()) { return MStatus::kSuccess; }
+
+    // Moving a parent does not dirty the mesh, so its matrix is checked at each draw.
+    if (this->vertexPointsAreStale || !this->selectedShape.inclusiveMatrix().isEquivalent(this->vertexPointsMatrix))
+    {
+        this->refreshFeedbackPositions();
     }
 
-    MFnMesh meshFn(selectedMesh);
-    meshFn.setVertexColors(colors, vertexList, &displayColorModifier);
+    drawManager.beginDrawable();
+    drawManager.setDepthPriority(FEEDBACK_DEPTH_PRIORITY);
+    drawManager.setPointSize(FEEDBACK_POINT_SIZE);
+
+    for (int c = 0; c < NUMBER_OF_FEEDBACK_CLASSES; c++)
+    {
+        if (this->feedbackPoints[c].length() == 0) { continue; }
+
+        drawManager.setColor(FEEDBACK_COLORS[c]);
+        drawManager.points(this->feedbackPoints[c], false);
+    }
+
+    drawManager.endDrawable();
+
+    return MStatus::kSuccess;
 }
 
 PolySymmetryContextCmd::PolySymmetryContextCmd() {}
@@ -8,20 +8,26 @@
 
 #include "meshData.h"
 #include "polySymmetry.h"
+#include "symmetryTables.h"
 
+#include <memory>
 #include <vector>
 
-#include <maya/MColor.h>
-#include <maya/MColorArray.h>
+#include <maya/MCallbackIdArray.h>
 #include <maya/MDagPath.h>
-#include <maya/MDGModifier.h>
 #include <maya/MEvent.h>
+#include <maya/MFrameContext.h>
+#include <maya/MMatrix.h>
+#include <maya/MObject.h>
+#include <maya/MPlug.h>
+#include <maya/MPointArray.h>
 #include <maya/MPxContext.h>
 #include <maya/MPxContextCommand.h>
 #include <maya/MPxSelectionContext.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
 #include <maya/MStatus.h>
+#include <maya/MUIDrawManager.h>
 
 using namespace std;
 
@@ -47,21 +53,51 @@ public:
 
     virtual MStatus     getSelectedMesh();
     virtual MStatus     clearSelectedMesh();
+    virtual void        removeMeshDirtyCallback();
+    virtual void        loadSymmetryTables();
 
     virtual void        updateHelpString();
     virtual void        recalculateSymmetry();
-    virtual void        updateDisplayColors();
+    virtual void        updateFeedbackPoints();
+    virtual void        rebuildFeedbackPoints();
+    virtual void        moveFeedbackPoint(int vertexIndex, int feedbackClass);
+    virtual MStatus     refreshFeedbackPositions();
+
+    virtual MStatus     drawFeedback(MHWRender::MUIDrawManager &drawManager, const MHWRender::MFrameContext &frameContext);
+
+    static void         meshDirtyCallback(MObject &node, MPlug &plug, void* clientData);
 
 private:
     MDagPath                    selectedMesh;    
     MeshData                    meshData;
     PolySymmetryData            symmetryData;
 
-    MColorArray                 originalVertexColors;
-    bool                        originalDisplayColors = false;
+    shared_ptr<const SymmetryTables> loadedTables;
+
+    MDagPath                    selectedShape;
+    MCallbackId                 meshDirtyCallbackId = 0;
+    MObject                     outMeshAttribute;
+
+    MPointArray                 vertexPoints;
+    MMatrix                     vertexPointsMatrix;
+    bool                        vertexPointsAreStale = false;
+
+    /*
+        Vertices of each overlay class, and the position of each vertex in the
+        list of its class, so a vertex moves between classes in constant time.
+        `feedbackPoints` holds the world positions of `classVertices`.
+    */
+    vector<MPointArray>         feedbackPoints;
+    vector<vector<int>>         classVertices;
+    vector<int>                 vertexClasses;
+    vector<int>                 vertexClassSlots;
 
-    MDGModifier                 displayColorModifier;
     vector<int>                 affectedVertices;
+    bool                        updateAllVertices = true;
+
+    vector<int>                 vertexShells;
+    vector<vector<int>>         verticesByShell;
+    size_t                      numberOfSolvedComponents = 0;
 
     vector<ComponentSelection>  selectedComponents;
     vector<int>                 leftSideVertexIndices;
@@ -0,0 +1,292 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshData.h"
+#include "parallel.h"
+#include "polySymmetryValidateCmd.h"
+#include "profiling.h"
+#include "sceneCache.h"
+#include "symmetryTables.h"
+#include "symmetryValidation.h"
+
+#include <memory>
+#include <vector>
+
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnMesh.h>
+#include <maya/MGlobal.h>
+#include <maya/MIntArray.h>
+#include <maya/MPxCommand.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+using namespace std;
+
+PolySymmetryValidateCommand::PolySymmetryValidateCommand()  {}
+PolySymmetryValidateCommand::~PolySymmetryValidateCommand() {}
+
+void* PolySymmetryValidateCommand::creator()
+{
+    return new PolySymmetryValidateCommand();
+}
+
+MSyntax PolySymmetryValidateCommand::getSyntax()
+{
+    MSyntax syntax;
+
+    syntax.setObjectType(MSyntax::kSelectionList, 1);
+    syntax.useSelectionAsDefault(true);
+
+    syntax.addFlag(UNMATCHED_FLAG, UNMATCHED_LONG_FLAG);
+    syntax.addFlag(NON_INVOLUTIVE_FLAG, NON_INVOLUTIVE_LONG_FLAG);
+    syntax.addFlag(CONTRADICTORY_FLAG, CONTRADICTORY_LONG_FLAG);
+    syntax.addFlag(UNSEEDED_SHELLS_FLAG, UNSEEDED_SHELLS_LONG_FLAG);
+    syntax.addFlag(ASYMMETRIC_FLAG, ASYMMETRIC_LONG_FLAG);
+
+    syntax.addFlag(TOLERANCE_FLAG, TOLERANCE_LONG_FLAG, MSyntax::kDouble);
+    syntax.addFlag(COMPONENT_TYPE_FLAG, COMPONENT_TYPE_LONG_FLAG, MSyntax::kString);
+
+    syntax.enableQuery(false);
+    syntax.enableEdit(false);
+
+    return syntax;
+}
+
+MStatus PolySymmetryValidateCommand::doIt(const MArgList& argList)
+{
+    MStatus status;
+
+    ProfileScope profileScope("polySymmetryValidate");
+
+    MArgDatabase argsData(syntax(), argList, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = this->parseArguments(argsData);
+
+    if (!status) { return status; }
+
+    return this->redoIt();
+}
+
+MStatus PolySymmetryValidateCommand::redoIt()
+{
+    MStatus status;
+
+    vector<SymmetryReport> reports;
+
+    status = this->validateMeshes(reports);
+
+    if (!status) { return status; }
+
+    if (this->reportType == SUMMARY_REPORT)
+    {
+        this->setSummaryResult(reports);
+    } else {
+        this->setReportResult(reports[0]);
+    }
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryValidateCommand::parseArguments(MArgDatabase &argsData)
+{
+    MStatus status;
+
+    MSelectionList selection;
+    argsData.getObjects(selection);
+
+    for (unsigned int i = 0; i < selection.length(); i++)
+    {
+        MDagPath mesh;
+        status = selection.getDagPath(i, mesh);
+
+        if (!status || !mesh.hasFn(MFn::kMesh))
+        {
+            MGlobal::displayError("Must select a mesh.");
+            return MStatus::kFailure;
+        }
+
+        this->meshes.append(mesh);
+    }
+
+    const char* reportFlags[] = {
+        UNMATCHED_FLAG,
+        NON_INVOLUTIVE_FLAG,
+        CONTRADICTORY_FLAG,
+        UNSEEDED_SHELLS_FLAG,
+        ASYMMETRIC_FLAG
+    };
+
+    for (int r = 0; r < 5; r++)
+    {
+        if (!argsData.isFlagSet(reportFlags[r])) { continue; }
+
+        if (this->reportType != SUMMARY_REPORT)
+        {
+            MGlobal::displayError("Only one of -unmatched, -nonInvolutive, -contradictory, -unseededShells, or -asymmetric can be used at a time.");
+            return MStatus::kFailure;
+        }
+
+        this->reportType = (SymmetryReportType) (UNMATCHED_REPORT + r);
+    }
+
+    if (this->reportType != SUMMARY_REPORT && this->meshes.length() != 1)
+    {
+        MString errorMsg("^1s: a report flag requires exactly one mesh.");
+        errorMsg.format(errorMsg, PolySymmetryValidateCommand::COMMAND_NAME);
+
+        MGlobal::displayError(errorMsg);
+        return MStatus::kFailure;
+    }
+
+    if (argsData.isFlagSet(TOLERANCE_FLAG))
+    {
+        status = argsData.getFlagArgument(TOLERANCE_FLAG, 0, this->tolerance);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        this->checkPositions = true;
+    } else if (this->reportType == ASYMMETRIC_REPORT) {
+        MGlobal::displayError("-asymmetric requires a -tolerance.");
+        return MStatus::kFailure;
+    }
+
+    if (argsData.isFlagSet(COMPONENT_TYPE_FLAG))
+    {
+        MString componentTypeName;
+        status = argsData.getFlagArgument(COMPONENT_TYPE_FLAG, 0, componentTypeName);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (componentTypeName == "vtx")
+        {
+            this->componentType = MFn::kMeshVertComponent;
+        } else if (componentTypeName == "e") {
+            this->componentType = MFn::kMeshEdgeComponent;
+        } else if (componentTypeName == "f") {
+            this->componentType = MFn::kMeshPolygonComponent;
+        } else {
+            MString errorMsg("Invalid component type ^1s. Expected \"vtx\", \"e\", or \"f\".");
+            errorMsg.format(errorMsg, componentTypeName);
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+    }
+
+    return MStatus::kSuccess;
+}
+
+/*
+    Meshes and tables are read from the scene one at a time, since the API is
+    not thread safe, and then validated in parallel, one mesh per task.
+*/
+MStatus PolySymmetryValidateCommand::validateMeshes(vector<SymmetryReport> &reports)
+{
+    MStatus status;
+
+    int numberOfMeshes = (int) this->meshes.length();
+
+    vector<MeshData> meshData(numberOfMeshes);
+    vector<shared_ptr<const SymmetryTables>> tables(numberOfMeshes);
+    vector<vector<float>> points(numberOfMeshes);
+
+    for (int i = 0; i < numberOfMeshes; i++)
+    {
+        MDagPath &mesh = this->meshes[i];
+
+        if (!PolySymmetryCache::getSymmetryTables(mesh, tables[i]))
+        {
+            MString errorMsg("No symmetry tables in memory match the mesh ^1s.");
+            errorMsg.format(errorMsg, mesh.partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        meshData[i].unpackMesh(mesh);
+
+        if (
+            tables[i]->vertexSymmetry.size() != (size_t) meshData[i].numberOfVertices ||
+            tables[i]->edgeSymmetry.size() != (size_t) meshData[i].numberOfEdges ||
+            tables[i]->faceSymmetry.size() != (size_t) meshData[i].numberOfFaces
+        ) {
+            MString errorMsg("The symmetry tables of ^1s do not match its topology.");
+            errorMsg.format(errorMsg, mesh.partialPathName());
+
+            MGlobal::displayError(errorMsg);
+            return MStatus::kFailure;
+        }
+
+        if (this->checkPositions)
+        {
+            MFnMesh fnMesh(mesh);
+
+            const float* rawPoints = fnMesh.getRawPoints(&status);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+
+            points[i].assign(rawPoints, rawPoints + meshData[i].numberOfVertices * 3);
+        }
+    }
+
+    reports.resize(numberOfMeshes);
+
+    ProfileScope validateScope("validateSymmetry");
+
+    parallelFor(numberOfMeshes, [&](int i, int /*threadIndex*/)
+    {
+        validateSymmetry(
+            meshData[i],
+            *tables[i],
+            this->checkPositions ? points[i].data() : nullptr,
+            0,
+            (float) this->tolerance,
+            reports[i]
+        );
+    });
+
+    return MStatus::kSuccess;
+}
+
+void PolySymmetryValidateCommand::setSummaryResult(vector<SymmetryReport> &reports)
+{
+    MIntArray result;
+
+    for (SymmetryReport &report : reports)
+    {
+        result.append((int) (report.unmatchedVertices.size() + report.unmatchedEdges.size() + report.unmatchedFaces.size()));
+        result.append((int) (report.nonInvolutiveVertices.size() + report.nonInvolutiveEdges.size() + report.nonInvolutiveFaces.size()));
+        result.append((int) (report.contradictoryVertices.size() + report.contradictoryEdges.size() + report.contradictoryFaces.size()));
+        result.append((int) report.unseededShells.size());
+        result.append((int) report.asymmetricVertices.size());
+    }
+
+    this->setResult(result);
+}
+
+void PolySymmetryValidateCommand::setReportResult(SymmetryReport &report)
+{
+    vector<int>* indices;
+
+    bool isEdge = this->componentType == MFn::kMeshEdgeComponent;
+    bool isFace = this->componentType == MFn::kMeshPolygonComponent;
+
+    if (this->reportType == UNMATCHED_REPORT)
+    {
+        indices = isEdge ? &report.unmatchedEdges : isFace ? &report.unmatchedFaces : &report.unmatchedVertices;
+    } else if (this->reportType == NON_INVOLUTIVE_REPORT) {
+        indices = isEdge ? &report.nonInvolutiveEdges : isFace ? &report.nonInvolutiveFaces : &report.nonInvolutiveVertices;
+    } else if (this->reportType == CONTRADICTORY_REPORT) {
+        indices = isEdge ? &report.contradictoryEdges : isFace ? &report.contradictoryFaces : &report.contradictoryVertices;
+    } else if (this->reportType == UNSEEDED_SHELLS_REPORT) {
+        indices = &report.unseededShells;
+    } else {
+        indices = &report.asymmetricVertices;
+    }
+
+    this->setResult(MIntArray(indices->data(), (unsigned int) indices->size()));
+}
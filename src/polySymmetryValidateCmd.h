@@ -0,0 +1,96 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_VALIDATE_CMD_H
+#define POLY_SYMMETRY_VALIDATE_CMD_H
+
+#include "symmetryValidation.h"
+
+#include <vector>
+
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MFn.h>
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+using namespace std;
+
+#define UNMATCHED_FLAG              "-um"
+#define UNMATCHED_LONG_FLAG         "-unmatched"
+
+#define NON_INVOLUTIVE_FLAG         "-ni"
+#define NON_INVOLUTIVE_LONG_FLAG    "-nonInvolutive"
+
+#define CONTRADICTORY_FLAG          "-cd"
+#define CONTRADICTORY_LONG_FLAG     "-contradictory"
+
+#define UNSEEDED_SHELLS_FLAG        "-us"
+#define UNSEEDED_SHELLS_LONG_FLAG   "-unseededShells"
+
+#define ASYMMETRIC_FLAG             "-asy"
+#define ASYMMETRIC_LONG_FLAG        "-asymmetric"
+
+#define TOLERANCE_FLAG              "-tol"
+#define TOLERANCE_LONG_FLAG         "-tolerance"
+
+#define COMPONENT_TYPE_FLAG         "-ct"
+#define COMPONENT_TYPE_LONG_FLAG    "-componentType"
+
+enum SymmetryReportType
+{
+    SUMMARY_REPORT,
+    UNMATCHED_REPORT,
+    NON_INVOLUTIVE_REPORT,
+    CONTRADICTORY_REPORT,
+    UNSEEDED_SHELLS_REPORT,
+    ASYMMETRIC_REPORT
+};
+
+/*
+    Checks the symmetry tables of meshes for problems. By default, returns
+    five counts per mesh: unmatched, non-involutive, and contradictory
+    components, unseeded shells, and asymmetric vertices. With a report flag,
+    returns the indices of the one mesh given instead.
+*/
+class PolySymmetryValidateCommand : public MPxCommand
+{
+public:
+                        PolySymmetryValidateCommand();
+    virtual             ~PolySymmetryValidateCommand();
+
+    static void*        creator();
+    static MSyntax      getSyntax();
+
+    virtual MStatus     doIt(const MArgList& argList);
+    virtual MStatus     redoIt();
+
+    virtual MStatus     parseArguments(MArgDatabase &argsData);
+    virtual MStatus     validateMeshes(vector<SymmetryReport> &reports);
+
+    virtual void        setSummaryResult(vector<SymmetryReport> &reports);
+    virtual void        setReportResult(SymmetryReport &report);
+
+    virtual bool        isUndoable() const { return false; }
+    virtual bool        hasSyntax()  const { return true; }
+
+public:
+    static MString      COMMAND_NAME;
+
+private:
+    MDagPathArray       meshes;
+
+    SymmetryReportType  reportType = SUMMARY_REPORT;
+    MFn::Type           componentType = MFn::kMeshVertComponent;
+
+    bool                checkPositions = false;
+    double              tolerance = 0.0;
+};
+
+#endif
@@ -0,0 +1,150 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "profiling.h"
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <maya/MProfiler.h>
+#include <maya/MStatus.h>
+#include <maya/MTypes.h>
+
+using namespace std;
+
+#define PROFILER_CATEGORY "polySymmetry"
+
+// Categories with a description, and removing a category, first shipped with Maya 2019.
+#if MAYA_API_VERSION >= 201900
+#define PROFILER_CATEGORY_DESCRIPTION
+#endif
+
+int                     PolySymmetryProfiler::categoryId = -1;
+bool                    PolySymmetryProfiler::recording = false;
+vector<ProfileStage>    PolySymmetryProfiler::stages;
+mutex                   PolySymmetryProfiler::stagesMutex;
+
+// Innermost stage on each thread, which allocations are counted against.
+static thread_local ProfileScope* currentScope = nullptr;
+
+MStatus PolySymmetryProfiler::initialize()
+{
+#ifdef PROFILER_CATEGORY_DESCRIPTION
+    categoryId = MProfiler::addCategory(PROFILER_CATEGORY, "polySymmetry commands and nodes");
+#else
+    categoryId = MProfiler::addCategory(PROFILER_CATEGORY);
+#endif
+
+    return MStatus::kSuccess;
+}
+
+MStatus PolySymmetryProfiler::uninitialize()
+{
+    MStatus status = MStatus::kSuccess;
+
+#ifdef PROFILER_CATEGORY_DESCRIPTION
+    status = MProfiler::removeCategory(PROFILER_CATEGORY);
+#endif
+
+    categoryId = -1;
+
+    return status;
+}
+
+void PolySymmetryProfiler::setRecording(bool recording)
+{
+    PolySymmetryProfiler::recording = recording;
+}
+
+bool PolySymmetryProfiler::isRecording()
+{
+    return recording;
+}
+
+void PolySymmetryProfiler::reset()
+{
+    lock_guard<mutex> lock(stagesMutex);
+    stages.clear();
+}
+
+void PolySymmetryProfiler::getStages(vector<ProfileStage> &stages)
+{
+    lock_guard<mutex> lock(stagesMutex);
+    stages = PolySymmetryProfiler::stages;
+}
+
+void PolySymmetryProfiler::countAllocation(size_t bytes)
+{
+    if (currentScope != nullptr) { currentScope->countAllocation(bytes); }
+}
+
+/* There are only a few dozen stages, so they are kept in order of first use and found by name. */
+void PolySymmetryProfiler::addStage(const char* name, double seconds, int allocations, double allocatedBytes)
+{
+    lock_guard<mutex> lock(stagesMutex);
+
+    ProfileStage* stage = nullptr;
+
+    for (ProfileStage &s : stages)
+    {
+        if (strcmp(s.name.c_str(), name) == 0) { stage = &s; break; }
+    }
+
+    if (stage == nullptr)
+    {
+        stages.emplace_back();
+        stage = &stages.back();
+        stage->name = name;
+    }
+
+    stage->calls += 1;
+    stage->seconds += seconds;
+    stage->allocations += allocations;
+    stage->allocatedBytes += allocatedBytes;
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : name(name), eventId(-1), recording(PolySymmetryProfiler::recording), parent(currentScope)
+{
+    if (PolySymmetryProfiler::categoryId != -1)
+    {
+        this->eventId = MProfiler::eventBegin(PolySymmetryProfiler::categoryId, MProfiler::kColorE_L2, name);
+    }
+
+    if (this->recording) { this->start = chrono::steady_clock::now(); }
+
+    currentScope = this;
+}
+
+ProfileScope::~ProfileScope()
+{
+    this->end();
+}
+
+/* Stages have to end in the reverse order they began, as scopes do. */
+void ProfileScope::end()
+{
+    if (this->ended) { return; }
+
+    this->ended = true;
+    currentScope = this->parent;
+
+    if (this->recording)
+    {
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - this->start;
+        PolySymmetryProfiler::addStage(this->name, elapsed.count(), this->allocations, this->allocatedBytes);
+    }
+
+    if (this->eventId != -1) { MProfiler::eventEnd(this->eventId); }
+}
+
+void ProfileScope::countAllocation(size_t bytes)
+{
+    this->allocations += 1;
+    this->allocatedBytes += (double) bytes;
+}
@@ -0,0 +1,93 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_PROFILING_H
+#define POLY_SYMMETRY_PROFILING_H
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <maya/MStatus.h>
+
+using namespace std;
+
+/* Totals for one stage since recording was last reset. */
+struct ProfileStage
+{
+    string          name;
+    int             calls = 0;
+    double          seconds = 0.0;
+    int             allocations = 0;
+    double          allocatedBytes = 0.0;
+};
+
+/*
+    Timings for the stages of the commands, such as unpacking a mesh,
+    decoding its tables, or running a kernel. Every stage is always sent to
+    Maya's Profiler as an event in the polySymmetry category. While recording
+    is on, the time of each stage and the buffers it reports allocating are
+    also added to a table of totals, which the polySymmetryProfile command
+    returns.
+*/
+class PolySymmetryProfiler
+{
+public:
+    static MStatus      initialize();
+    static MStatus      uninitialize();
+
+    static void         setRecording(bool recording);
+    static bool         isRecording();
+
+    static void         reset();
+    static void         getStages(vector<ProfileStage> &stages);
+
+    /*
+        Adds a buffer of `bytes` to the innermost stage running on this thread.
+        Only the large, per-mesh buffers of each stage are reported.
+    */
+    static void         countAllocation(size_t bytes);
+
+    static void         addStage(const char* name, double seconds, int allocations, double allocatedBytes);
+
+public:
+    static int          categoryId;
+    static bool         recording;
+
+    static vector<ProfileStage> stages;
+    static mutex        stagesMutex;
+};
+
+/*
+    Times the scope it is declared in as the stage `name`, which must be a
+    string literal, or until `end` is called. Stages may be nested; a stage's
+    time includes the stages inside it.
+*/
+class ProfileScope
+{
+public:
+                        ProfileScope(const char* name);
+                        ~ProfileScope();
+
+    void                countAllocation(size_t bytes);
+    void                end();
+
+private:
+    const char*         name;
+    bool                ended = false;
+    int                 eventId;
+
+    bool                recording;
+    chrono::steady_clock::time_point start;
+
+    int                 allocations = 0;
+    double              allocatedBytes = 0.0;
+
+    ProfileScope*       parent;
+};
+
+#endif
@@ -3,25 +3,42 @@
     You may use, distribute, or modify this code under the terms of the MIT license.
 */
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
 #include "polySymmetryNode.h"
+#include "profiling.h"
 #include "sceneCache.h"
+#include "symmetryRegistry.h"
 
 #include <maya/MCallbackIdArray.h>
+#include <maya/MDagPath.h>
 #include <maya/MDGMessage.h>
 #include <maya/MFnDependencyNode.h>
 #include <maya/MItDependencyNodes.h>
 #include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
 #include <maya/MObject.h>
 #include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
+#include <maya/MPolyMessage.h>
 #include <maya/MSceneMessage.h>
 #include <maya/MStatus.h>
+#include <maya/MTypes.h>
 
+// MPolyMessage::addPolyTopologyChangedCallback first shipped with Maya 2016.
+// Without it a stored key could not be dropped, so keys are not stored.
+#if MAYA_API_VERSION >= 201600
+#define CACHE_MESH_KEYS
+#endif
 
 unordered_map<string, MObjectHandle>    PolySymmetryCache::symmetryNodeCache;
+unordered_map<unsigned int, pair<MObjectHandle, shared_ptr<const SymmetryTables>>>  PolySymmetryCache::symmetryTablesCache;
+unordered_map<unsigned int, MCallbackId>                       PolySymmetryCache::nodeCallbackIDs;
+unordered_map<unsigned int, pair<MObjectHandle, string>>       PolySymmetryCache::meshKeyCache;
+unordered_map<unsigned int, MCallbackIdArray>                  PolySymmetryCache::meshCallbackIDs;
 MCallbackIdArray                        PolySymmetryCache::callbackIDs;
 bool                                    PolySymmetryCache::cacheNodes;
 
@@ -68,6 +85,11 @@ MStatus PolySymmetryCache::uninitialize()
     status = MMessage::removeCallbacks(callbackIDs);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    PolySymmetryCache::clearSymmetryTables();
+    PolySymmetryCache::clearMeshKeys();
+
+    SymmetryRegistry::clear();
+
     return MStatus::kSuccess;
 }
     
@@ -89,6 +111,8 @@ void PolySymmetryCache::nodeAddedCallback(MObject &node, void* clientData)
 
 void PolySymmetryCache::nodeRemovedCallback(MObject &node, void* clientData)
 {
+    PolySymmetryCache::removeSymmetryTables(node);
+
     if (!PolySymmetryCache::cacheNodes) { return; }
 
     string key;
@@ -103,11 +127,24 @@ void PolySymmetryCache::nodeRemovedCallback(MObject &node, void* clientData)
 void PolySymmetryCache::newFileCallback(void* clientData)
 {
     PolySymmetryCache::symmetryNodeCache.clear();
+    PolySymmetryCache::clearSymmetryTables();
+    PolySymmetryCache::clearMeshKeys();
 }
 
 void PolySymmetryCache::beforeOpenFileCallback(void* clientData)
 {
     PolySymmetryCache::cacheNodes = false;
+    PolySymmetryCache::clearSymmetryTables();
+    PolySymmetryCache::clearMeshKeys();
+}
+
+void PolySymmetryCache::nodeAttributeChangedCallback(MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void* clientData)
+{
+    if (msg & (MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken))
+    {
+        unsigned int hashCode = MObjectHandle(plug.node()).hashCode();
+        PolySymmetryCache::symmetryTablesCache.erase(hashCode);
+    }
 }
 
 void PolySymmetryCache::afterOpenFileCallback(void* clientData)
@@ -116,7 +153,8 @@ void PolySymmetryCache::afterOpenFileCallback(void* clientData)
 
     PolySymmetryCache::symmetryNodeCache.clear();
 
-    MItDependencyNodes itNodes;
+    // Only plugin nodes are visited, and they are matched on type id rather than type name.
+    MItDependencyNodes itNodes(MFn::kPluginDependNode);
     MFnDependencyNode fnNode;
     MObject node;
 
@@ -126,7 +164,7 @@ void PolySymmetryCache::afterOpenFileCallback(void* clientData)
 
         fnNode.setObject(node);
 
-        if (fnNode.typeName() == PolySymmetryNode::NODE_NAME)
+        if (fnNode.typeId() == PolySymmetryNode::NODE_ID)
         {
             PolySymmetryCache::addNodeToCache(node);
         }
@@ -142,8 +180,7 @@ void PolySymmetryCache::addNodeToCache(MObject &node)
 
     if (!key.empty())
     {
-        MObjectHandle handle(node);
-        PolySymmetryCache::symmetryNodeCache.emplace(key, handle);
+        PolySymmetryCache::symmetryNodeCache.emplace(key, MObjectHandle(node));
     }
 }
 
@@ -152,7 +189,7 @@ bool PolySymmetryCache::getNodeFromCache(MDagPath &mesh, MObject &node)
     bool result = false;
 
     string key;
-    PolySymmetryNode::getCacheKeyFromMesh(mesh, key);
+    PolySymmetryCache::getCacheKeyFromMesh(mesh, key);
 
     if (!key.empty())
     {
@@ -166,4 +203,257 @@ bool PolySymmetryCache::getNodeFromCache(MDagPath &mesh, MObject &node)
     }
 
     return result;
+}
+
+/*
+    Returns the decoded tables of a polySymmetryData node, reading them from 
+    the node only the first time they are requested after a change.
+*/
+bool PolySymmetryCache::getSymmetryTables(MObject &node, shared_ptr<const SymmetryTables> &tables)
+{
+    MObjectHandle handle(node);
+    unsigned int hashCode = handle.hashCode();
+
+    auto got = PolySymmetryCache::symmetryTablesCache.find(hashCode);
+
+    if (got != PolySymmetryCache::symmetryTablesCache.end())
+    {
+        if (PolySymmetryCache::isCachedNode(got->second.first, node))
+        {
+            tables = got->second.second;
+            return true;
+        }
+
+        // The entry belongs to another node with the same hash code, or to a deleted one.
+        PolySymmetryCache::removeSymmetryTables(hashCode);
+    }
+
+    MStatus status;
+
+    {
+        ProfileScope profileScope("decodeTables");
+
+        status = PolySymmetryNode::getSymmetryTables(node, tables);
+
+        if (!status) { return false; }
+
+        profileScope.countAllocation((tables->vertexSymmetry.size() + tables->edgeSymmetry.size() + tables->faceSymmetry.size()) * 2 * sizeof(int));
+    }
+
+    // Nodes are only watched once their tables have been requested, which keeps scene open cheap.
+    if (PolySymmetryCache::nodeCallbackIDs.count(hashCode) == 0)
+    {
+        MCallbackId callbackId = MNodeMessage::addAttributeChangedCallback(node, PolySymmetryCache::nodeAttributeChangedCallback, NULL, &status);
+
+        if (!status) { return true; }
+
+        PolySymmetryCache::nodeCallbackIDs.emplace(hashCode, callbackId);
+    }
+
+    PolySymmetryCache::symmetryTablesCache.emplace(hashCode, make_pair(handle, tables));
+
+    string key;
+    PolySymmetryNode::getCacheKey(node, key);
+
+    SymmetryRegistry::addSymmetryTables(key, tables);
+
+    return true;
+}
+
+/*
+    Returns the tables of a mesh from the polySymmetryData node that matches 
+    it, or from the registry shared by every mesh with the same topology when
+    the scene has no such node.
+*/
+bool PolySymmetryCache::getSymmetryTables(MDagPath &mesh, shared_ptr<const SymmetryTables> &tables)
+{
+    ProfileScope profileScope("getSymmetryTables");
+
+    MObject node;
+
+    if (PolySymmetryCache::getNodeFromCache(mesh, node) && !node.isNull())
+    {
+        return PolySymmetryCache::getSymmetryTables(node, tables);
+    }
+
+    string key;
+    PolySymmetryCache::getCacheKeyFromMesh(mesh, key);
+
+    return SymmetryRegistry::getSymmetryTables(key, tables);
+}
+
+/*
+    Drops the decoded tables of a node, and stops watching it. An entry of
+    another live node that shares the hash code is kept.
+*/
+void PolySymmetryCache::removeSymmetryTables(MObject &node)
+{
+    unsigned int hashCode = MObjectHandle(node).hashCode();
+
+    auto got = PolySymmetryCache::symmetryTablesCache.find(hashCode);
+
+    if (got != PolySymmetryCache::symmetryTablesCache.end())
+    {
+        const MObjectHandle &cachedHandle = got->second.first;
+
+        if (cachedHandle.isValid() && cachedHandle.objectRef() != node) { return; }
+    }
+
+    PolySymmetryCache::removeSymmetryTables(hashCode);
+}
+
+void PolySymmetryCache::removeSymmetryTables(unsigned int hashCode)
+{
+    PolySymmetryCache::symmetryTablesCache.erase(hashCode);
+
+    auto callback = PolySymmetryCache::nodeCallbackIDs.find(hashCode);
+
+    if (callback != PolySymmetryCache::nodeCallbackIDs.end())
+    {
+        MMessage::removeCallback(callback->second);
+        PolySymmetryCache::nodeCallbackIDs.erase(callback);
+    }
+}
+
+void PolySymmetryCache::clearSymmetryTables()
+{
+    for (auto &callback : PolySymmetryCache::nodeCallbackIDs)
+    {
+        MMessage::removeCallback(callback.second);
+    }
+
+    PolySymmetryCache::nodeCallbackIDs.clear();
+    PolySymmetryCache::symmetryTablesCache.clear();
+}
+
+/*
+    Returns true if a cache entry made for `handle` still belongs to `node`. 
+    Different nodes can share a hash code, and a deleted node's hash code can 
+    be reused.
+*/
+bool PolySymmetryCache::isCachedNode(const MObjectHandle &handle, const MObject &node)
+{
+    return handle.isValid() && handle.objectRef() == node;
+}
+
+void PolySymmetryCache::meshTopologyChangedCallback(MObject &node, void* clientData)
+{
+    auto got = PolySymmetryCache::meshKeyCache.find(MObjectHandle(node).hashCode());
+
+    // The entry and its callbacks stay, so the shape is not watched twice.
+    if (got != PolySymmetryCache::meshKeyCache.end() && PolySymmetryCache::isCachedNode(got->second.first, node))
+    {
+        got->second.second.clear();
+    }
+}
+
+void PolySymmetryCache::meshRemovedCallback(MObject &node, void* clientData)
+{
+    PolySymmetryCache::removeMeshFromCache(node);
+}
+
+/*
+    Returns the cache key of a mesh. Computing the key walks the whole mesh, 
+    so it is stored per shape until the shape's topology changes. 
+*/
+void PolySymmetryCache::getCacheKeyFromMesh(MDagPath &mesh, string &key)
+{
+    ProfileScope profileScope("cacheKey");
+
+    MDagPath shape(mesh);
+
+    if (!shape.node().hasFn(MFn::kMesh) && !shape.extendToShape())
+    {
+        PolySymmetryNode::getCacheKeyFromMesh(mesh, key);
+        return;
+    }
+
+#ifndef CACHE_MESH_KEYS
+    PolySymmetryNode::getCacheKeyFromMesh(shape, key);
+#else
+    MObject node = shape.node();
+    MObjectHandle handle(node);
+    unsigned int hashCode = handle.hashCode();
+
+    auto got = PolySymmetryCache::meshKeyCache.find(hashCode);
+
+    if (got != PolySymmetryCache::meshKeyCache.end())
+    {
+        if (PolySymmetryCache::isCachedNode(got->second.first, node))
+        {
+            if (got->second.second.empty())
+            {
+                PolySymmetryNode::getCacheKeyFromMesh(shape, got->second.second);
+            }
+
+            key = got->second.second;
+            return;
+        }
+
+        // The entry belongs to another shape with the same hash code, or to a deleted one.
+        PolySymmetryCache::removeMeshFromCache(hashCode);
+    }
+
+    PolySymmetryNode::getCacheKeyFromMesh(shape, key);
+
+    MStatus topologyStatus;
+    MStatus removalStatus;
+
+    MCallbackIdArray callbacks;
+    callbacks.append(MPolyMessage::addPolyTopologyChangedCallback(node, PolySymmetryCache::meshTopologyChangedCallback, NULL, &topologyStatus));
+    callbacks.append(MNodeMessage::addNodePreRemovalCallback(node, PolySymmetryCache::meshRemovedCallback, NULL, &removalStatus));
+
+    if (!topologyStatus || !removalStatus)
+    {
+        MMessage::removeCallbacks(callbacks);
+        return;
+    }
+
+    PolySymmetryCache::meshCallbackIDs.emplace(hashCode, callbacks);
+    PolySymmetryCache::meshKeyCache.emplace(hashCode, make_pair(handle, key));
+#endif
+}
+
+/*
+    Drops the cache key of a shape, and stops watching it. An entry of another
+    live shape that shares the hash code is kept.
+*/
+void PolySymmetryCache::removeMeshFromCache(MObject &node)
+{
+    unsigned int hashCode = MObjectHandle(node).hashCode();
+
+    auto got = PolySymmetryCache::meshKeyCache.find(hashCode);
+
+    if (got != PolySymmetryCache::meshKeyCache.end())
+    {
+        const MObjectHandle &cachedHandle = got->second.first;
+
+        if (cachedHandle.isValid() && cachedHandle.objectRef() != node) { return; }
+    }
+
+    PolySymmetryCache::removeMeshFromCache(hashCode);
+}
+
+void PolySymmetryCache::removeMeshFromCache(unsigned int hashCode)
+{
+    auto callbacks = PolySymmetryCache::meshCallbackIDs.find(hashCode);
+
+    if (callbacks != PolySymmetryCache::meshCallbackIDs.end())
+    {
+        MMessage::removeCallbacks(callbacks->second);
+        PolySymmetryCache::meshCallbackIDs.erase(callbacks);
+    }
+
+    PolySymmetryCache::meshKeyCache.erase(hashCode);
+}
+
+void PolySymmetryCache::clearMeshKeys()
+{
+    for (auto &callbacks : PolySymmetryCache::meshCallbackIDs)
+    {
+        MMessage::removeCallbacks(callbacks.second);
+    }
+
+    PolySymmetryCache::meshCallbackIDs.clear();
+    PolySymmetryCache::meshKeyCache.clear();
 }
\ No newline at end of file
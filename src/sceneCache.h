@@ -6,10 +6,15 @@
 #ifndef POLY_SYMMETRY_SCENE_CACHE_H
 #define POLY_SYMMETRY_SCENE_CACHE_H
 
+#include "symmetryTables.h"
+
+#include <memory>
 #include <string>
 #include <unordered_map>
 
 #include <maya/MCallbackIdArray.h>
+#include <maya/MDagPath.h>
+#include <maya/MNodeMessage.h>
 #include <maya/MObject.h>
 #include <maya/MObjectHandle.h>
 #include <maya/MStatus.h>
@@ -32,12 +37,44 @@ public:
     static void         beforeOpenFileCallback(void* clientData);
     static void         afterOpenFileCallback(void* clientData);
 
+    static void         nodeAttributeChangedCallback(MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void* clientData);
+
+    static void         meshTopologyChangedCallback(MObject &node, void* clientData);
+    static void         meshRemovedCallback(MObject &node, void* clientData);
+
     static void         addNodeToCache(MObject &node);
     static bool         getNodeFromCache(MDagPath &mesh, MObject &node);
 
+    static void         getCacheKeyFromMesh(MDagPath &mesh, string &key);
+    static void         removeMeshFromCache(MObject &node);
+    static void         removeMeshFromCache(unsigned int hashCode);
+    static void         clearMeshKeys();
+
+    static bool         getSymmetryTables(MObject &node, shared_ptr<const SymmetryTables> &tables);
+    static bool         getSymmetryTables(MDagPath &mesh, shared_ptr<const SymmetryTables> &tables);
+    static void         removeSymmetryTables(MObject &node);
+    static void         removeSymmetryTables(unsigned int hashCode);
+    static void         clearSymmetryTables();
+
+    static bool         isCachedNode(const MObjectHandle &handle, const MObject &node);
+
 public:
     static unordered_map<string, MObjectHandle>     symmetryNodeCache;
 
+    /* 
+        Decoded tables of the cached nodes, keyed by node hash code and filled on first use.
+        Hash codes are not unique, so each entry keeps a handle to the node it belongs to.
+    */
+    static unordered_map<unsigned int, pair<MObjectHandle, shared_ptr<const SymmetryTables>>>  symmetryTablesCache;
+    static unordered_map<unsigned int, MCallbackId>                       nodeCallbackIDs;
+
+    /* 
+        Cache keys of mesh shapes, keyed by shape hash code and emptied when the topology changes.
+        Like the tables, each entry keeps a handle to the shape it belongs to.
+    */
+    static unordered_map<unsigned int, pair<MObjectHandle, string>>       meshKeyCache;
+    static unordered_map<unsigned int, MCallbackIdArray>                  meshCallbackIDs;
+
     static MCallbackIdArray     callbackIDs;
     static bool                 cacheNodes;
 };
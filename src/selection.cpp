@@ -7,10 +7,12 @@
 #include "meshData.h"
 #include "util.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <maya/MDagPath.h>
 #include <maya/MGlobal.h>
+#include <maya/MIntArray.h>
 #include <maya/MFnMesh.h>
 #include <maya/MFnSingleIndexedComponent.h>
 #include <maya/MItGeometry.h>
@@ -132,17 +134,17 @@ bool getSymmetricalComponentSelection(MeshData &meshData, MSelectionList &select
         faceIndices.size() == 2 &&
         (leftSideVertexSelected ? numberOfVerticesSelected == 3 : numberOfVerticesSelected == 2)
     ) {
-        bool edge0NotOnBorder = meshData.edgeData[edgeIndices[0]].connectedFaces.size() > 1;
-        bool edge1NotOnBorder = meshData.edgeData[edgeIndices[1]].connectedFaces.size() > 1;
+        bool edge0NotOnBorder = meshData.edgeFaces.count(edgeIndices[0]) > 1;
+        bool edge1NotOnBorder = meshData.edgeFaces.count(edgeIndices[1]) > 1;
 
-        vector<int> edgesOnFace0 = intersection(meshData.faceData[faceIndices[0]].connectedEdges, edgeIndices);
-        vector<int> edgesOnFace1 = intersection(meshData.faceData[faceIndices[1]].connectedEdges, edgeIndices);
+        vector<int> edgesOnFace0 = intersection(meshData.faceEdges[faceIndices[0]], edgeIndices);
+        vector<int> edgesOnFace1 = intersection(meshData.faceEdges[faceIndices[1]], edgeIndices);
 
-        vector<int> verticesOnEdge0 = intersection(meshData.edgeData[edgeIndices[0]].connectedVertices, vertexIndices);
-        vector<int> verticesOnEdge1 = intersection(meshData.edgeData[edgeIndices[1]].connectedVertices, vertexIndices);
+        vector<int> verticesOnEdge0 = intersection(meshData.edgeVertices[edgeIndices[0]], vertexIndices);
+        vector<int> verticesOnEdge1 = intersection(meshData.edgeVertices[edgeIndices[1]], vertexIndices);
 
-        vector<int> verticesOnFace0 = intersection(meshData.faceData[faceIndices[0]].connectedVertices, vertexIndices);
-        vector<int> verticesOnFace1 = intersection(meshData.faceData[faceIndices[1]].connectedVertices, vertexIndices);
+        vector<int> verticesOnFace0 = intersection(meshData.faceVertices[faceIndices[0]], vertexIndices);
+        vector<int> verticesOnFace1 = intersection(meshData.faceVertices[faceIndices[1]], vertexIndices);
 
         int leftSideVertex = -1;
 
@@ -198,4 +200,107 @@ void getAllVertices(int &numberOfVertices, MObject &components)
     MFnSingleIndexedComponent vertices;
     components = vertices.create(MFn::kMeshVertComponent);
     vertices.setCompleteData(numberOfVertices);
-}
\ No newline at end of file
+}
+
+
+void getVertexComponents(const vector<int> &vertexIndices, MObject &components)
+{
+    MFnSingleIndexedComponent vertices;
+    components = vertices.create(MFn::kMeshVertComponent);
+
+    MIntArray elements((unsigned) vertexIndices.size());
+
+    for (unsigned i = 0; i < elements.length(); i++)
+    {
+        elements[i] = vertexIndices[i];
+    }
+
+    vertices.addElements(elements);
+}
+
+
+/*
+    Collects the vertices of every component in `selection` that is on
+    `selectedMesh`. Edges and faces select their vertices. Vertices carry the
+    weights of a soft selection when they have them, and a weight of 1 
+    otherwise.
+
+    Returns false if no components of the mesh are selected.
+*/
+bool getSelectedVertexWeights(
+    const MDagPath &selectedMesh, 
+    MSelectionList &selection, 
+    vector<int> &vertexIndices, 
+    vector<float> &vertexWeights
+) {
+    MDagPath meshShape(selectedMesh);
+    meshShape.extendToShape();
+
+    MFnMesh fnMesh(meshShape);
+    vector<float> weights(fnMesh.numVertices(), -1.0f);
+
+    bool hasComponents = false;
+
+    MDagPath mesh;
+    MObject component;
+
+    for (MItSelectionList iterSelection(selection); !iterSelection.isDone(); iterSelection.next())
+    {
+        iterSelection.getDagPath(mesh, component);
+
+        if (component.isNull()) { continue; }
+
+        mesh.extendToShape();
+
+        if (!(mesh == meshShape)) { continue; }
+
+        if (component.hasFn(MFn::kMeshVertComponent))
+        {
+            MFnSingleIndexedComponent fnComponent(component);
+            bool hasWeights = fnComponent.hasWeights();
+
+            for (int k = 0; k < fnComponent.elementCount(); k++)
+            {
+                int i = fnComponent.element(k);
+                float w = hasWeights ? fnComponent.weight(k).influence() : 1.0f;
+
+                weights[i] = max(weights[i], w);
+            }
+        } else if (component.hasFn(MFn::kMeshEdgeComponent)) {
+            for (MItMeshEdge iterGeo(mesh, component); !iterGeo.isDone(); iterGeo.next())
+            {
+                weights[iterGeo.index(0)] = 1.0f;
+                weights[iterGeo.index(1)] = 1.0f;
+            }
+        } else if (component.hasFn(MFn::kMeshPolygonComponent)) {
+            MIntArray polygonVertices;
+
+            for (MItMeshPolygon iterGeo(mesh, component); !iterGeo.isDone(); iterGeo.next())
+            {
+                iterGeo.getVertices(polygonVertices);
+
+                for (unsigned k = 0; k < polygonVertices.length(); k++)
+                {
+                    weights[polygonVertices[k]] = 1.0f;
+                }
+            }
+        } else {
+            continue;
+        }
+
+        hasComponents = true;
+    }
+
+    vertexIndices.clear();
+    vertexWeights.clear();
+
+    for (int i = 0; i < (int) weights.size(); i++)
+    {
+        if (weights[i] < 0.0f) { continue; }
+
+        vertexIndices.push_back(i);
+        vertexWeights.push_back(weights[i]);
+    }
+
+    return hasComponents;
+}
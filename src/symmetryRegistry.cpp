@@ -0,0 +1,148 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "symmetryRegistry.h"
+#include "symmetryTableFile.h"
+#include "symmetryTables.h"
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define REGISTRY_FILE_EXTENSION ".psym"
+
+unordered_map<string, shared_ptr<const SymmetryTables>>  SymmetryRegistry::registeredTables;
+mutex                                                   SymmetryRegistry::registryMutex;
+
+static bool tablesAreEqual(const SymmetryTables &a, const SymmetryTables &b)
+{
+    return (
+        a.edgeSymmetry == b.edgeSymmetry 
+        && a.faceSymmetry == b.faceSymmetry 
+        && a.vertexSymmetry == b.vertexSymmetry
+        && a.edgeSides == b.edgeSides 
+        && a.faceSides == b.faceSides 
+        && a.vertexSides == b.vertexSides
+    );
+}
+
+bool SymmetryRegistry::getSymmetryTables(const string &key, shared_ptr<const SymmetryTables> &tables)
+{
+    if (key.empty()) { return false; }
+
+    {
+        lock_guard<mutex> lock(SymmetryRegistry::registryMutex);
+
+        auto got = SymmetryRegistry::registeredTables.find(key);
+
+        if (got != SymmetryRegistry::registeredTables.end())
+        {
+            tables = got->second;
+            return true;
+        }
+    }
+
+    string directory;
+
+    if (!SymmetryRegistry::getDirectory(directory)) { return false; }
+
+    string filePath;
+    SymmetryRegistry::getFilePath(directory, key, filePath);
+
+    if (!SymmetryRegistry::readFile(filePath, key, tables)) { return false; }
+
+    lock_guard<mutex> lock(SymmetryRegistry::registryMutex);
+
+    // Another thread may have added the key while the file was read.
+    tables = SymmetryRegistry::registeredTables.emplace(key, tables).first->second;
+
+    return true;
+}
+
+/*
+    Tables read from a scene, or solved again, replace the ones in memory, 
+    since they may have been corrected. The file on disk is replaced when it 
+    is missing or holds other tables, so other sessions load the correction.
+*/
+void SymmetryRegistry::addSymmetryTables(const string &key, const shared_ptr<const SymmetryTables> &tables)
+{
+    if (key.empty() || tables == nullptr) { return; }
+
+    {
+        lock_guard<mutex> lock(SymmetryRegistry::registryMutex);
+
+        shared_ptr<const SymmetryTables> &registered = SymmetryRegistry::registeredTables[key];
+
+        // Tables already in memory were read from the file, or written to it.
+        bool isRegistered = registered != nullptr && (registered == tables || tablesAreEqual(*registered, *tables));
+
+        registered = tables;
+
+        if (isRegistered) { return; }
+    }
+
+    string directory;
+
+    if (!SymmetryRegistry::getDirectory(directory)) { return; }
+
+    string filePath;
+    SymmetryRegistry::getFilePath(directory, key, filePath);
+
+    shared_ptr<const SymmetryTables> fileTables;
+
+    if (SymmetryRegistry::readFile(filePath, key, fileTables) && tablesAreEqual(*fileTables, *tables)) { return; }
+
+    SymmetryRegistry::writeFile(filePath, key, *tables);
+}
+
+void SymmetryRegistry::clear()
+{
+    lock_guard<mutex> lock(SymmetryRegistry::registryMutex);
+
+    SymmetryRegistry::registeredTables.clear();
+}
+
+bool SymmetryRegistry::getDirectory(string &directory)
+{
+    const char* value = getenv(SYMMETRY_REGISTRY_VARIABLE);
+
+    if (value == nullptr || value[0] == '\0') { return false; }
+
+    directory = value;
+
+    return true;
+}
+
+/* Keys are "edges:faces:vertices:checksum"; the colons are not valid in Windows file names. */
+void SymmetryRegistry::getFilePath(const string &directory, const string &key, string &filePath)
+{
+    string fileName(key);
+
+    for (char &c : fileName)
+    {
+        if (c == ':') { c = '_'; }
+    }
+
+    filePath = directory;
+
+    if (filePath.back() != '/' && filePath.back() != '\\') { filePath += '/'; }
+
+    filePath += fileName + REGISTRY_FILE_EXTENSION;
+}
+
+bool SymmetryRegistry::readFile(const string &filePath, const string &key, shared_ptr<const SymmetryTables> &tables)
+{
+    return readSymmetryTableFile(filePath, key, tables);
+}
+
+bool SymmetryRegistry::writeFile(const string &filePath, const string &key, const SymmetryTables &tables)
+{
+    return writeSymmetryTableFile(filePath, key, tables);
+}
@@ -0,0 +1,53 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_REGISTRY_H
+#define POLY_SYMMETRY_REGISTRY_H
+
+#include "symmetryTables.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// Environment variable naming the directory of the on-disk registry.
+#define SYMMETRY_REGISTRY_VARIABLE "POLY_SYMMETRY_REGISTRY"
+
+/*
+    Symmetry tables keyed by the topology cache key of the mesh they were
+    solved on, shared by every mesh with the same key. Unlike the scene
+    cache, the registry outlives the scene, so duplicated, referenced and
+    instanced meshes reuse one solve without a polySymmetryData node of 
+    their own.
+
+    When POLY_SYMMETRY_REGISTRY names a directory, each entry is also 
+    stored there as a symmetry table file, which shares solves between
+    sessions and machines.
+
+    The registry is reached from commands and from deformer evaluation, so
+    every access to the tables in memory holds `registryMutex`.
+*/
+class SymmetryRegistry
+{
+public:
+    static bool         getSymmetryTables(const string &key, shared_ptr<const SymmetryTables> &tables);
+    static void         addSymmetryTables(const string &key, const shared_ptr<const SymmetryTables> &tables);
+    static void         clear();
+
+    static bool         getDirectory(string &directory);
+    static void         getFilePath(const string &directory, const string &key, string &filePath);
+
+    static bool         readFile(const string &filePath, const string &key, shared_ptr<const SymmetryTables> &tables);
+    static bool         writeFile(const string &filePath, const string &key, const SymmetryTables &tables);
+
+private:
+    static unordered_map<string, shared_ptr<const SymmetryTables>>  registeredTables;
+    static mutex        registryMutex;
+};
+
+#endif
@@ -0,0 +1,442 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "componentSelection.h"
+#include "meshTopology.h"
+#include "parallel.h"
+#include "polySymmetry.h"
+#include "symmetrySeeds.h"
+#include "util.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Candidate seeds verified per shell before the shell is given up on.
+#define SEED_CANDIDATES_PER_SHELL 8
+
+// Fraction of the pairs found by the flood fill that may disagree with the geometry.
+#define SEED_MISMATCH_FRACTION 0.01
+
+// Fraction of the geometrically matched vertices of a shell that the flood fill must reach.
+#define SEED_COVERAGE_FRACTION 0.9
+
+typedef pair<uint64_t, int> GridCell;
+
+static uint64_t getCellKey(long long x, long long y, long long z)
+{
+    return ((uint64_t) x * 73856093ULL) ^ ((uint64_t) y * 19349663ULL) ^ ((uint64_t) z * 83492791ULL);
+}
+
+static long long getCellCoordinate(float value, float cellSize)
+{
+    return (long long) floor(value / cellSize);
+}
+
+void findMirroredVertices(
+    const MeshTopology &meshData, 
+    const float* points, 
+    int axis, 
+    float tolerance, 
+    vector<int> &mirroredVertices
+) {
+    int numberOfVertices = meshData.numberOfVertices;
+
+    float cellSize = max(tolerance, 1e-6f);
+    float maxDistanceSquared = tolerance * tolerance;
+
+    vector<GridCell> cells(numberOfVertices);
+
+    parallelForRange(numberOfVertices, 8192, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            const float* p = points + (size_t) i * 3;
+
+            cells[i] = GridCell(
+                getCellKey(
+                    getCellCoordinate(p[0], cellSize), 
+                    getCellCoordinate(p[1], cellSize), 
+                    getCellCoordinate(p[2], cellSize)
+                ),
+                i
+            );
+        }
+    });
+
+    sort(cells.begin(), cells.end());
+
+    vector<int> nearestVertices(numberOfVertices, -1);
+
+    parallelForRange(numberOfVertices, 2048, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            float q[3] = { points[(size_t) i * 3], points[(size_t) i * 3 + 1], points[(size_t) i * 3 + 2] };
+            q[axis] = -q[axis];
+
+            long long c[3];
+            for (int k = 0; k < 3; k++) { c[k] = getCellCoordinate(q[k], cellSize); }
+
+            float bestDistance = maxDistanceSquared;
+            int bestIndex = -1;
+
+            for (long long dx = -1; dx <= 1; dx++)
+            {
+                for (long long dy = -1; dy <= 1; dy++)
+                {
+                    for (long long dz = -1; dz <= 1; dz++)
+                    {
+                        uint64_t key = getCellKey(c[0] + dx, c[1] + dy, c[2] + dz);
+
+                        auto it = lower_bound(cells.begin(), cells.end(), GridCell(key, INT_MIN));
+
+                        for (; it != cells.end() && it->first == key; it++)
+                        {
+                            const float* p = points + (size_t) it->second * 3;
+
+                            float d0 = p[0] - q[0];
+                            float d1 = p[1] - q[1];
+                            float d2 = p[2] - q[2];
+
+                            float distance = d0 * d0 + d1 * d1 + d2 * d2;
+
+                            if (distance <= bestDistance)
+                            {
+                                bestDistance = distance;
+                                bestIndex = it->second;
+                            }
+                        }
+                    }
+                }
+            }
+
+            nearestVertices[i] = bestIndex;
+        }
+    });
+
+    mirroredVertices.resize(numberOfVertices);
+
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        int j = nearestVertices[i];
+        mirroredVertices[i] = (j != -1 && nearestVertices[j] == i) ? j : -1;
+    }
+}
+
+int findShells(const MeshTopology &meshData, vector<int> &vertexShells, vector<int> &shellVertices)
+{
+    int numberOfVertices = meshData.numberOfVertices;
+
+    vertexShells.assign(numberOfVertices, -1);
+    shellVertices.clear();
+
+    queue<int> vertexQueue;
+
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        if (vertexShells[i] != -1) { continue; }
+
+        int shellIndex = (int) shellVertices.size();
+        shellVertices.push_back(i);
+
+        vertexShells[i] = shellIndex;
+        vertexQueue.push(i);
+
+        while (!vertexQueue.empty())
+        {
+            int v = vertexQueue.front();
+            vertexQueue.pop();
+
+            for (const int &n : meshData.vertexVertices[v])
+            {
+                if (vertexShells[n] != -1) { continue; }
+
+                vertexShells[n] = shellIndex;
+                vertexQueue.push(n);
+            }
+        }
+    }
+
+    return (int) shellVertices.size();
+}
+
+static int findEdge(const MeshTopology &meshData, int vertex0, int vertex1)
+{
+    for (const int &e : meshData.vertexEdges[vertex0])
+    {
+        if (contains(meshData.edgeVertices[e], vertex1)) { return e; }
+    }
+
+    return -1;
+}
+
+/* Returns the face on `edgeIndex` whose vertices are the mirrors of the vertices of `faceIndex`. */
+static int findMirroredFace(const MeshTopology &meshData, const vector<int> &mirroredVertices, int faceIndex, int edgeIndex)
+{
+    IndexRange faceVertices = meshData.faceVertices[faceIndex];
+
+    for (const int &f : meshData.edgeFaces[edgeIndex])
+    {
+        IndexRange otherVertices = meshData.faceVertices[f];
+
+        if (otherVertices.size() != faceVertices.size()) { continue; }
+
+        bool isMirrored = true;
+
+        for (const int &v : faceVertices)
+        {
+            if (mirroredVertices[v] == -1 || !contains(otherVertices, mirroredVertices[v]))
+            {
+                isMirrored = false;
+                break;
+            }
+        }
+
+        if (isMirrored) { return f; }
+    }
+
+    return -1;
+}
+
+/*
+    Collects candidate seeds per shell. A seed is a pair of distinct mirrored
+    edges, each on one of a pair of distinct mirrored faces, the same as a 
+    selection made by hand; a center edge is its own mirror and would stop 
+    the flood fill at the seed. The first pass only takes edges with two 
+    faces, and the second pass fills up with border edges.
+*/
+static void findSeedCandidates(
+    const MeshTopology &meshData,
+    const vector<int> &mirroredVertices,
+    const vector<int> &vertexShells,
+    const vector<int> &leftVertices,
+    vector<vector<ComponentSelection>> &candidates
+) {
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int e = 0; e < meshData.numberOfEdges; e++)
+        {
+            int vertex0 = meshData.edgeVertices[e][0];
+            int vertex1 = meshData.edgeVertices[e][1];
+
+            vector<ComponentSelection> &shellCandidates = candidates[vertexShells[vertex0]];
+
+            if (shellCandidates.size() >= SEED_CANDIDATES_PER_SHELL) { continue; }
+
+            int mirroredVertex0 = mirroredVertices[vertex0];
+            int mirroredVertex1 = mirroredVertices[vertex1];
+
+            if (mirroredVertex0 == -1 || mirroredVertex1 == -1) { continue; }
+
+            int mirroredEdge = findEdge(meshData, mirroredVertex0, mirroredVertex1);
+
+            if (mirroredEdge == -1 || mirroredEdge == e) { continue; }
+            if ((meshData.edgeFaces.count(e) == 2) != (pass == 0)) { continue; }
+
+            for (const int &f : meshData.edgeFaces[e])
+            {
+                int mirroredFace = findMirroredFace(meshData, mirroredVertices, f, mirroredEdge);
+
+                if (mirroredFace == -1 || mirroredFace == f) { continue; }
+
+                ComponentSelection seed;
+                seed.edgeIndices = pair<int, int>(e, mirroredEdge);
+                seed.faceIndices = pair<int, int>(f, mirroredFace);
+                seed.vertexIndices = pair<int, int>(vertex0, mirroredVertex0);
+                seed.leftVertexIndex = leftVertices[vertexShells[vertex0]];
+
+                shellCandidates.push_back(seed);
+                break;
+            }
+        }
+    }
+}
+
+static bool isVerifiedShell(
+    const ShellSymmetry &shell, 
+    const vector<int> &mirroredVertices, 
+    const vector<int> &vertexShells, 
+    int shellIndex, 
+    int numberOfMatchedVertices
+) {
+    if (shell.vertexPairs.empty()) { return false; }
+
+    size_t mismatches = 0;
+    vector<int> reachedVertices;
+
+    for (const pair<int, int> &p : shell.vertexPairs)
+    {
+        int m = mirroredVertices[p.first];
+
+        if (m != -1 && m != p.second) { mismatches++; }
+
+        if (vertexShells[p.first] == shellIndex) { reachedVertices.push_back(p.first); }
+        if (vertexShells[p.second] == shellIndex) { reachedVertices.push_back(p.second); }
+    }
+
+    if (mismatches > (size_t) (shell.vertexPairs.size() * SEED_MISMATCH_FRACTION)) { return false; }
+
+    sort(reachedVertices.begin(), reachedVertices.end());
+    size_t numberOfReachedVertices = unique(reachedVertices.begin(), reachedVertices.end()) - reachedVertices.begin();
+
+    return numberOfReachedVertices >= (size_t) (numberOfMatchedVertices * SEED_COVERAGE_FRACTION);
+}
+
+static void resetState(SymmetryState &s, const ShellSymmetry &shell)
+{
+    for (const pair<int, int> &p : shell.vertexPairs)
+    {
+        s.vertexSymmetryIndices[p.first] = s.vertexSymmetryIndices[p.second] = -1;
+        s.examinedVertices[p.first] = s.examinedVertices[p.second] = false;
+    }
+
+    for (const pair<int, int> &p : shell.edgePairs)
+    {
+        s.edgeSymmetryIndices[p.first] = s.edgeSymmetryIndices[p.second] = -1;
+        s.examinedEdges[p.first] = s.examinedEdges[p.second] = false;
+    }
+
+    for (const pair<int, int> &p : shell.facePairs)
+    {
+        s.faceSymmetryIndices[p.first] = s.faceSymmetryIndices[p.second] = -1;
+        s.examinedFaces[p.first] = s.examinedFaces[p.second] = false;
+    }
+}
+
+/*
+    Candidates are verified one shell per task, each by a full flood fill
+    from the seed. A seed passes if nearly every vertex pair it produces 
+    agrees with the geometric match of the vertex. Shells are then accepted
+    in order, and a shell already reached by an accepted seed - the mirror
+    of a shell that does not cross the center - needs no seed of its own.
+*/
+void findSymmetrySeeds(
+    const MeshTopology &meshData, 
+    const float* points, 
+    int axis, 
+    float tolerance, 
+    vector<ComponentSelection> &seeds, 
+    vector<int> &unmatchedVertices
+) {
+    vector<int> mirroredVertices;
+    findMirroredVertices(meshData, points, axis, tolerance, mirroredVertices);
+
+    vector<int> vertexShells;
+    vector<int> shellVertices;
+
+    int numberOfShells = findShells(meshData, vertexShells, shellVertices);
+
+    // A shell on the right side is seeded with the mirror of one of its vertices.
+    vector<int> leftVertices(numberOfShells, -1);
+    vector<int> matchedVertexCounts(numberOfShells, 0);
+
+    for (int i = 0; i < meshData.numberOfVertices; i++)
+    {
+        if (mirroredVertices[i] != -1) { matchedVertexCounts[vertexShells[i]]++; }
+
+        int &leftVertex = leftVertices[vertexShells[i]];
+
+        if (leftVertex != -1 || mirroredVertices[i] == -1) { continue; }
+
+        float value = points[(size_t) i * 3 + axis];
+
+        if (value > tolerance) 
+        { 
+            leftVertex = i; 
+        } else if (value < -tolerance) {
+            leftVertex = mirroredVertices[i];
+        }
+    }
+
+    vector<vector<ComponentSelection>> candidates(numberOfShells);
+    findSeedCandidates(meshData, mirroredVertices, vertexShells, leftVertices, candidates);
+
+    int numberOfThreads = max(1, min(getNumberOfThreads(), numberOfShells));
+
+    vector<SymmetryState> scratch(numberOfThreads);
+
+    for (SymmetryState &s : scratch)
+    {
+        s.vertexSymmetryIndices.resize(meshData.numberOfVertices, -1);
+        s.edgeSymmetryIndices.resize(meshData.numberOfEdges, -1);
+        s.faceSymmetryIndices.resize(meshData.numberOfFaces, -1);
+
+        s.examinedVertices.resize(meshData.numberOfVertices, false);
+        s.examinedEdges.resize(meshData.numberOfEdges, false);
+        s.examinedFaces.resize(meshData.numberOfFaces, false);
+    }
+
+    vector<int> verifiedCandidates(numberOfShells, -1);
+    vector<vector<int>> reachedShells(numberOfShells);
+
+    parallelFor(numberOfShells, [&](int shellIndex, int threadIndex)
+    {
+        SymmetryState &s = scratch[threadIndex];
+        ShellSymmetry shell;
+
+        for (size_t c = 0; c < candidates[shellIndex].size(); c++)
+        {
+            ComponentSelection seed = candidates[shellIndex][c];
+
+            ShellSolver solver(meshData, s, &shell);
+            solver.findSymmetricalVertices(seed);
+
+            bool isVerified = isVerifiedShell(shell, mirroredVertices, vertexShells, shellIndex, matchedVertexCounts[shellIndex]);
+
+            if (isVerified)
+            {
+                vector<int> &reached = reachedShells[shellIndex];
+
+                for (const pair<int, int> &p : shell.vertexPairs)
+                {
+                    reached.push_back(vertexShells[p.first]);
+                    reached.push_back(vertexShells[p.second]);
+                }
+
+                sort(reached.begin(), reached.end());
+                reached.erase(unique(reached.begin(), reached.end()), reached.end());
+            }
+
+            resetState(s, shell);
+            shell.clear();
+
+            if (isVerified)
+            {
+                verifiedCandidates[shellIndex] = (int) c;
+                break;
+            }
+        }
+    }, numberOfThreads);
+
+    vector<char> isSeeded(numberOfShells, 0);
+
+    for (int shellIndex = 0; shellIndex < numberOfShells; shellIndex++)
+    {
+        if (isSeeded[shellIndex] || verifiedCandidates[shellIndex] == -1) { continue; }
+
+        seeds.push_back(candidates[shellIndex][verifiedCandidates[shellIndex]]);
+
+        isSeeded[shellIndex] = 1;
+
+        for (const int &reached : reachedShells[shellIndex]) { isSeeded[reached] = 1; }
+    }
+
+    for (int shellIndex = 0; shellIndex < numberOfShells; shellIndex++)
+    {
+        int v = shellVertices[shellIndex];
+
+        if (!isSeeded[shellIndex] && meshData.vertexVertices.count(v) > 0) 
+        { 
+            unmatchedVertices.push_back(v); 
+        }
+    }
+}
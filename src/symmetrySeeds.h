@@ -0,0 +1,62 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_SEEDS_H
+#define POLY_SYMMETRY_SEEDS_H
+
+#include "meshTopology.h"
+#include "componentSelection.h"
+
+#include <vector>
+
+using namespace std;
+
+/*
+    Automatic seeding for the symmetry solver. Instead of picking an edge, 
+    face, and vertex on both sides of every shell, seeds are found from the
+    point positions of the mesh and then checked by running the topological
+    flood fill from them. The geometry only has to be symmetrical enough to
+    find one good seed per shell; the symmetry tables still come from the
+    topology.
+
+    Points are packed 3 floats per vertex, as returned by 
+    `MFnMesh::getRawPoints`, and are mirrored across the plane through the 
+    origin normal to `axis`. The positive side of the axis is the left side.
+*/
+
+/*
+    Matches each vertex to the vertex nearest its mirrored position, using a
+    hash grid with cells `tolerance` wide. Only vertices that match each 
+    other are kept; the rest are set to -1.
+*/
+void        findMirroredVertices(
+                const MeshTopology &meshData, 
+                const float* points, 
+                int axis, 
+                float tolerance, 
+                vector<int> &mirroredVertices
+            );
+
+/*
+    Labels every vertex with the index of the shell it is on and returns the
+    number of shells. `shellVertices` holds the lowest vertex index of each.
+*/
+int         findShells(const MeshTopology &meshData, vector<int> &vertexShells, vector<int> &shellVertices);
+
+/*
+    Finds one verified seed per shell, or per pair of mirrored shells, in 
+    the form the solver takes from the user. `unmatchedVertices` gets the 
+    first vertex of each shell that no seed covers.
+*/
+void        findSymmetrySeeds(
+                const MeshTopology &meshData, 
+                const float* points, 
+                int axis, 
+                float tolerance, 
+                vector<ComponentSelection> &seeds, 
+                vector<int> &unmatchedVertices
+            );
+
+#endif
@@ -0,0 +1,270 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "symmetryTableFile.h"
+#include "symmetryTables.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/* Read-only view of a whole file, unmapped when it goes out of scope. */
+class MappedFile
+{
+public:
+    MappedFile(const string &filePath)
+    {
+#ifdef _WIN32
+        fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        if (fileHandle == INVALID_HANDLE_VALUE) { return; }
+
+        LARGE_INTEGER fileSize;
+
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) { return; }
+
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+        if (mappingHandle == NULL) { return; }
+
+        data = (const unsigned char*) MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        size = data == nullptr ? 0 : (size_t) fileSize.QuadPart;
+#else
+        fileDescriptor = open(filePath.c_str(), O_RDONLY);
+
+        if (fileDescriptor == -1) { return; }
+
+        struct stat fileStat;
+
+        if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) { return; }
+
+        void* mapping = mmap(NULL, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+        if (mapping == MAP_FAILED) { return; }
+
+        data = (const unsigned char*) mapping;
+        size = (size_t) fileStat.st_size;
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (data != nullptr) { UnmapViewOfFile(data); }
+        if (mappingHandle != NULL) { CloseHandle(mappingHandle); }
+        if (fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(fileHandle); }
+#else
+        if (data != nullptr) { munmap((void*) data, size); }
+        if (fileDescriptor != -1) { close(fileDescriptor); }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    const unsigned char*    data = nullptr;
+    size_t                  size = 0;
+
+private:
+#ifdef _WIN32
+    HANDLE                  fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE                  mappingHandle = NULL;
+#else
+    int                     fileDescriptor = -1;
+#endif
+};
+
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + SYMMETRY_TABLE_FILE_ALIGNMENT - 1) / SYMMETRY_TABLE_FILE_ALIGNMENT * SYMMETRY_TABLE_FILE_ALIGNMENT;
+}
+
+static bool isInFile(uint64_t offset, uint64_t length, size_t fileSize)
+{
+    return offset <= fileSize && length <= fileSize - offset;
+}
+
+/*
+    Writers in other processes, such as batch workers sharing a registry, may
+    write the same file at once, so each write goes through its own file in
+    the same directory before it replaces the table.
+*/
+static string getTemporaryPath(const string &filePath)
+{
+    static atomic<unsigned> numberOfWrites(0);
+
+#ifdef _WIN32
+    unsigned long processId = GetCurrentProcessId();
+#else
+    unsigned long processId = (unsigned long) getpid();
+#endif
+
+    return filePath + "." + to_string(processId) + "." + to_string(numberOfWrites++) + ".tmp";
+}
+
+bool writeSymmetryTableFile(const string &filePath, const string &key, const SymmetryTables &tables)
+{
+    const vector<int>* symmetry[3] = { &tables.edgeSymmetry, &tables.faceSymmetry, &tables.vertexSymmetry };
+    const vector<int>* sides[3] = { &tables.edgeSides, &tables.faceSides, &tables.vertexSides };
+
+    SymmetryTableFileHeader header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, SYMMETRY_TABLE_FILE_MAGIC, 4);
+    header.version = SYMMETRY_TABLE_FILE_VERSION;
+    header.headerSize = (uint32_t) sizeof(header);
+    header.keyLength = (uint32_t) key.size();
+
+    header.numberOfEdges = (int32_t) tables.edgeSymmetry.size();
+    header.numberOfFaces = (int32_t) tables.faceSymmetry.size();
+    header.numberOfVertices = (int32_t) tables.vertexSymmetry.size();
+
+    uint64_t offset = sizeof(header);
+
+    header.keyOffset = offset;
+    offset += key.size();
+
+    for (int t = 0; t < 3; t++)
+    {
+        if (sides[t]->size() != symmetry[t]->size()) { return false; }
+
+        offset = alignOffset(offset);
+        header.symmetryOffsets[t] = offset;
+        offset += symmetry[t]->size() * sizeof(int32_t);
+    }
+
+    for (int t = 0; t < 3; t++)
+    {
+        offset = alignOffset(offset);
+        header.sideOffsets[t] = offset;
+        offset += sides[t]->size();
+    }
+
+    vector<unsigned char> bytes((size_t) offset, 0);
+
+    memcpy(bytes.data(), &header, sizeof(header));
+    memcpy(bytes.data() + header.keyOffset, key.data(), key.size());
+
+    for (int t = 0; t < 3; t++)
+    {
+        int32_t* symmetryData = (int32_t*) (bytes.data() + header.symmetryOffsets[t]);
+        int8_t* sideData = (int8_t*) (bytes.data() + header.sideOffsets[t]);
+
+        for (size_t i = 0; i < symmetry[t]->size(); i++)
+        {
+            symmetryData[i] = (int32_t) (*symmetry[t])[i];
+            sideData[i] = (int8_t) (*sides[t])[i];
+        }
+    }
+
+    string temporaryPath = getTemporaryPath(filePath);
+
+    {
+        ofstream out(temporaryPath, ios::binary | ios::trunc);
+
+        if (!out.good()) { return false; }
+
+        out.write((const char*) bytes.data(), bytes.size());
+
+        if (out.fail())
+        {
+            out.close();
+            remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows.
+    bool replaced = MoveFileExA(temporaryPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool replaced = rename(temporaryPath.c_str(), filePath.c_str()) == 0;
+#endif
+
+    if (!replaced)
+    {
+        remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/*
+    SymmetryTables owns its arrays, so the symmetry arrays are copied out of
+    the mapping in one pass each; there is nothing to decode.
+*/
+bool readSymmetryTableFile(const string &filePath, const string &key, shared_ptr<const SymmetryTables> &tables)
+{
+    MappedFile file(filePath);
+
+    if (file.data == nullptr || file.size < sizeof(SymmetryTableFileHeader)) { return false; }
+
+    SymmetryTableFileHeader header;
+    memcpy(&header, file.data, sizeof(header));
+
+    if (memcmp(header.magic, SYMMETRY_TABLE_FILE_MAGIC, 4) != 0) { return false; }
+    if (header.version > SYMMETRY_TABLE_FILE_VERSION || header.headerSize < sizeof(header)) { return false; }
+    if (header.numberOfEdges < 0 || header.numberOfFaces < 0 || header.numberOfVertices < 0) { return false; }
+
+    if (!isInFile(header.keyOffset, header.keyLength, file.size)) { return false; }
+
+    if (!key.empty())
+    {
+        string fileKey((const char*) file.data + header.keyOffset, header.keyLength);
+
+        if (fileKey != key) { return false; }
+    }
+
+    uint64_t counts[3] = { (uint64_t) header.numberOfEdges, (uint64_t) header.numberOfFaces, (uint64_t) header.numberOfVertices };
+
+    for (int t = 0; t < 3; t++)
+    {
+        if (header.symmetryOffsets[t] % SYMMETRY_TABLE_FILE_ALIGNMENT != 0) { return false; }
+        if (!isInFile(header.symmetryOffsets[t], counts[t] * sizeof(int32_t), file.size)) { return false; }
+        if (!isInFile(header.sideOffsets[t], counts[t], file.size)) { return false; }
+    }
+
+    shared_ptr<SymmetryTables> fileTables = make_shared<SymmetryTables>();
+
+    vector<int>* symmetry[3] = { &fileTables->edgeSymmetry, &fileTables->faceSymmetry, &fileTables->vertexSymmetry };
+    vector<int>* sides[3] = { &fileTables->edgeSides, &fileTables->faceSides, &fileTables->vertexSides };
+
+    for (int t = 0; t < 3; t++)
+    {
+        const int32_t* symmetryData = (const int32_t*) (file.data + header.symmetryOffsets[t]);
+        const int8_t* sideData = (const int8_t*) (file.data + header.sideOffsets[t]);
+
+        symmetry[t]->assign(symmetryData, symmetryData + counts[t]);
+        sides[t]->assign(sideData, sideData + counts[t]);
+
+        for (const int &s : *symmetry[t])
+        {
+            if (s < -1 || (uint64_t) s >= counts[t]) { return false; }
+        }
+    }
+
+    tables = fileTables;
+
+    return true;
+}
@@ -0,0 +1,64 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_TABLE_FILE_H
+#define POLY_SYMMETRY_TABLE_FILE_H
+
+#include "symmetryTables.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+#define SYMMETRY_TABLE_FILE_MAGIC       "PSYT"
+#define SYMMETRY_TABLE_FILE_VERSION     1
+
+// Alignment of every array in a table file, in bytes.
+#define SYMMETRY_TABLE_FILE_ALIGNMENT   16
+
+/*
+    Leading bytes of a symmetry table file. Files are little-endian and
+    hold the cache key of the mesh the tables were solved on, then the edge,
+    face, and vertex symmetry tables as int32 arrays and the edge, face, and
+    vertex sides as int8 arrays. Every array starts on an aligned offset, so
+    a reader can map the file and use the arrays in place.
+
+    Readers accept any version up to their own, and newer versions may only
+    append fields to the header.
+*/
+struct SymmetryTableFileHeader
+{
+    char            magic[4];
+    uint32_t        version;
+    uint32_t        headerSize;
+    uint32_t        keyLength;
+
+    int32_t         numberOfEdges;
+    int32_t         numberOfFaces;
+    int32_t         numberOfVertices;
+    uint32_t        reserved;
+
+    uint64_t        keyOffset;
+    uint64_t        symmetryOffsets[3];
+    uint64_t        sideOffsets[3];
+};
+
+/* 
+    Writes `tables` to `filePath` through a temporary file that is renamed 
+    into place, so readers never see a partial file. 
+*/
+bool        writeSymmetryTableFile(const string &filePath, const string &key, const SymmetryTables &tables);
+
+/*
+    Reads a file written by `writeSymmetryTableFile` through a read-only 
+    memory map. Returns false if the file is missing, truncated, from a newer
+    version, or was solved on a mesh with a key other than `key`; an empty
+    `key` accepts any mesh.
+*/
+bool        readSymmetryTableFile(const string &filePath, const string &key, shared_ptr<const SymmetryTables> &tables);
+
+#endif
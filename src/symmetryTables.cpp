@@ -0,0 +1,150 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "symmetryTables.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+#define SYMMETRY_TABLES_VERSION 1
+
+static void writeVarint(uint64_t value, vector<unsigned char> &bytes)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((unsigned char) (value | 0x80));
+        value >>= 7;
+    }
+
+    bytes.push_back((unsigned char) value);
+}
+
+static bool readVarint(const vector<unsigned char> &bytes, size_t &offset, uint64_t &value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (offset >= bytes.size()) { return false; }
+
+        unsigned char byte = bytes[offset++];
+        value |= (uint64_t) (byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) { return true; }
+    }
+
+    return false;
+}
+
+static void writeIndices(const vector<int> &values, vector<unsigned char> &bytes)
+{
+    writeVarint(values.size(), bytes);
+
+    int64_t previous = 0;
+
+    for (const int &v : values)
+    {
+        int64_t delta = (int64_t) v - previous;
+        writeVarint(((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63), bytes);
+
+        previous = v;
+    }
+}
+
+static bool readIndices(const vector<unsigned char> &bytes, size_t &offset, vector<int> &values)
+{
+    uint64_t count;
+
+    // Every index takes at least one byte, which bounds the allocation for bad data.
+    if (!readVarint(bytes, offset, count) || count > bytes.size() - offset) { return false; }
+
+    values.resize((size_t) count);
+
+    int64_t previous = 0;
+
+    for (int &v : values)
+    {
+        uint64_t zigzag;
+
+        if (!readVarint(bytes, offset, zigzag)) { return false; }
+
+        int64_t delta = (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+
+        previous += delta;
+        v = (int) previous;
+    }
+
+    return true;
+}
+
+static bool writeSides(const vector<int> &values, vector<unsigned char> &bytes)
+{
+    writeVarint(values.size(), bytes);
+
+    size_t offset = bytes.size();
+    bytes.resize(offset + (values.size() + 3) / 4, 0);
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (values[i] < -1 || values[i] > 1) { return false; }
+
+        bytes[offset + i / 4] |= (unsigned char) ((values[i] + 1) << ((i % 4) * 2));
+    }
+
+    return true;
+}
+
+static bool readSides(const vector<unsigned char> &bytes, size_t &offset, vector<int> &values)
+{
+    uint64_t count;
+
+    if (!readVarint(bytes, offset, count) || (count + 3) / 4 > bytes.size() - offset) { return false; }
+
+    values.resize((size_t) count);
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        int code = (bytes[offset + i / 4] >> ((i % 4) * 2)) & 3;
+
+        if (code == 3) { return false; }
+
+        values[i] = code - 1;
+    }
+
+    offset += (values.size() + 3) / 4;
+
+    return true;
+}
+
+bool encodeSymmetryTables(const SymmetryTables &tables, vector<unsigned char> &bytes)
+{
+    bytes.clear();
+    bytes.push_back(SYMMETRY_TABLES_VERSION);
+
+    writeIndices(tables.edgeSymmetry, bytes);
+    writeIndices(tables.faceSymmetry, bytes);
+    writeIndices(tables.vertexSymmetry, bytes);
+
+    return writeSides(tables.edgeSides, bytes)
+        && writeSides(tables.faceSides, bytes)
+        && writeSides(tables.vertexSides, bytes);
+}
+
+bool decodeSymmetryTables(const vector<unsigned char> &bytes, SymmetryTables &tables)
+{
+    if (bytes.empty() || bytes[0] != SYMMETRY_TABLES_VERSION) { return false; }
+
+    size_t offset = 1;
+
+    return readIndices(bytes, offset, tables.edgeSymmetry)
+        && readIndices(bytes, offset, tables.faceSymmetry)
+        && readIndices(bytes, offset, tables.vertexSymmetry)
+        && readSides(bytes, offset, tables.edgeSides)
+        && readSides(bytes, offset, tables.faceSides)
+        && readSides(bytes, offset, tables.vertexSides);
+}
@@ -0,0 +1,43 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_TABLES_H
+#define POLY_SYMMETRY_TABLES_H
+
+#include <vector>
+
+using namespace std;
+
+/*
+    Decoded contents of a polySymmetryData node. Instances are shared by 
+    PolySymmetryCache between commands and are never modified after they 
+    have been read from the node. 
+*/
+struct SymmetryTables
+{
+    vector<int>     edgeSymmetry;
+    vector<int>     faceSymmetry;
+    vector<int>     vertexSymmetry;
+
+    vector<int>     edgeSides;
+    vector<int>     faceSides;
+    vector<int>     vertexSides;
+};
+
+/*
+    Packs the tables into the byte stream stored by PolySymmetryTableData. 
+    Symmetry indices are stored as zigzag varint deltas from the previous 
+    index, which takes a single byte for runs of neighbouring components. 
+    Sides take two bits each. Returns false if a side is not -1, 0 or 1.
+*/
+bool        encodeSymmetryTables(const SymmetryTables &tables, vector<unsigned char> &bytes);
+
+/*
+    Unpacks a byte stream written by `encodeSymmetryTables`. Returns false 
+    if the stream is truncated or was written by a newer version.
+*/
+bool        decodeSymmetryTables(const vector<unsigned char> &bytes, SymmetryTables &tables);
+
+#endif
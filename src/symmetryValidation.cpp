@@ -0,0 +1,230 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshTopology.h"
+#include "parallel.h"
+#include "symmetrySeeds.h"
+#include "symmetryTables.h"
+#include "symmetryValidation.h"
+
+#include <vector>
+
+using namespace std;
+
+// Problems found for one component, packed into a byte per component.
+#define UNMATCHED       0x01
+#define NON_INVOLUTIVE  0x02
+#define CONTRADICTORY   0x04
+#define ASYMMETRIC      0x08
+
+void SymmetryReport::clear()
+{
+    unmatchedVertices.clear();
+    unmatchedEdges.clear();
+    unmatchedFaces.clear();
+
+    nonInvolutiveVertices.clear();
+    nonInvolutiveEdges.clear();
+    nonInvolutiveFaces.clear();
+
+    contradictoryVertices.clear();
+    contradictoryEdges.clear();
+    contradictoryFaces.clear();
+
+    unseededShells.clear();
+    asymmetricVertices.clear();
+}
+
+bool SymmetryReport::isValid() const
+{
+    return unmatchedVertices.empty() && unmatchedEdges.empty() && unmatchedFaces.empty()
+        && nonInvolutiveVertices.empty() && nonInvolutiveEdges.empty() && nonInvolutiveFaces.empty()
+        && contradictoryVertices.empty() && contradictoryEdges.empty() && contradictoryFaces.empty()
+        && unseededShells.empty() && asymmetricVertices.empty();
+}
+
+/*
+    Flags components that are unmatched or non-involutive. Returns the
+    symmetrical component of `i` if it can be checked any further, else -1.
+*/
+static int checkInvolution(const vector<int> &symmetry, int i, char &flags)
+{
+    int s = symmetry[i];
+
+    if (s == -1)
+    {
+        flags |= UNMATCHED;
+        return -1;
+    }
+
+    if (s < 0 || s >= (int) symmetry.size() || symmetry[s] != i)
+    {
+        flags |= NON_INVOLUTIVE;
+        return -1;
+    }
+
+    return s;
+}
+
+/*
+    Returns true if every vertex of `component` in `table` mirrors onto a
+    vertex of `mirroredComponent`, and both have as many vertices.
+*/
+static bool verticesAreMirrored(const AdjacencyTable &table, const vector<int> &vertexSymmetry, int component, int mirroredComponent)
+{
+    if (table.count(component) != table.count(mirroredComponent)) { return false; }
+
+    IndexRange mirroredVertices = table[mirroredComponent];
+
+    for (const int &v : table[component])
+    {
+        int m = vertexSymmetry[v];
+
+        if (m == -1) { return false; }
+
+        bool found = false;
+
+        for (const int &w : mirroredVertices)
+        {
+            if (w == m) { found = true; break; }
+        }
+
+        if (!found) { return false; }
+    }
+
+    return true;
+}
+
+static void collectFlags(const vector<char> &flags, char flag, vector<int> &indices)
+{
+    indices.clear();
+
+    for (int i = 0; i < (int) flags.size(); i++)
+    {
+        if (flags[i] & flag) { indices.push_back(i); }
+    }
+}
+
+static void checkVertices(
+    const MeshTopology &meshData,
+    const SymmetryTables &tables,
+    const float* points,
+    int axis,
+    float tolerance,
+    vector<char> &flags
+) {
+    const vector<int> &symmetry = tables.vertexSymmetry;
+    const vector<int> &sides = tables.vertexSides;
+
+    float toleranceSquared = tolerance * tolerance;
+
+    parallelForRange(meshData.numberOfVertices, 8192, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            int s = checkInvolution(symmetry, i, flags[i]);
+
+            if (s == -1) { continue; }
+
+            // A vertex on the center has no side, any other is opposite its mirror.
+            if (s == i ? sides[i] != 0 : sides[i] == sides[s])
+            {
+                flags[i] |= CONTRADICTORY;
+            }
+
+            if (points == nullptr) { continue; }
+
+            float distanceSquared = 0.0f;
+
+            for (int c = 0; c < 3; c++)
+            {
+                float mirrored = c == axis ? -points[i * 3 + c] : points[i * 3 + c];
+                float delta = mirrored - points[s * 3 + c];
+
+                distanceSquared += delta * delta;
+            }
+
+            if (distanceSquared > toleranceSquared)
+            {
+                flags[i] |= ASYMMETRIC;
+            }
+        }
+    });
+}
+
+static void checkComponents(
+    const AdjacencyTable &componentVertices,
+    const vector<int> &symmetry,
+    const vector<int> &vertexSymmetry,
+    int numberOfComponents,
+    vector<char> &flags
+) {
+    parallelForRange(numberOfComponents, 4096, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int i = first; i < last; i++)
+        {
+            int s = checkInvolution(symmetry, i, flags[i]);
+
+            if (s != -1 && !verticesAreMirrored(componentVertices, vertexSymmetry, i, s))
+            {
+                flags[i] |= CONTRADICTORY;
+            }
+        }
+    });
+}
+
+/*
+    Each component type is checked in one parallel pass that only writes the
+    flags of its own components, and the flags are then packed into index
+    lists in a single serial pass, so the report comes out in index order.
+*/
+void validateSymmetry(
+    const MeshTopology &meshData,
+    const SymmetryTables &tables,
+    const float* points,
+    int axis,
+    float tolerance,
+    SymmetryReport &report
+) {
+    report.clear();
+
+    vector<char> vertexFlags(meshData.numberOfVertices, 0);
+    vector<char> edgeFlags(meshData.numberOfEdges, 0);
+    vector<char> faceFlags(meshData.numberOfFaces, 0);
+
+    checkVertices(meshData, tables, points, axis, tolerance, vertexFlags);
+    checkComponents(meshData.edgeVertices, tables.edgeSymmetry, tables.vertexSymmetry, meshData.numberOfEdges, edgeFlags);
+    checkComponents(meshData.faceVertices, tables.faceSymmetry, tables.vertexSymmetry, meshData.numberOfFaces, faceFlags);
+
+    collectFlags(vertexFlags, UNMATCHED, report.unmatchedVertices);
+    collectFlags(vertexFlags, NON_INVOLUTIVE, report.nonInvolutiveVertices);
+    collectFlags(vertexFlags, CONTRADICTORY, report.contradictoryVertices);
+    collectFlags(vertexFlags, ASYMMETRIC, report.asymmetricVertices);
+
+    collectFlags(edgeFlags, UNMATCHED, report.unmatchedEdges);
+    collectFlags(edgeFlags, NON_INVOLUTIVE, report.nonInvolutiveEdges);
+    collectFlags(edgeFlags, CONTRADICTORY, report.contradictoryEdges);
+
+    collectFlags(faceFlags, UNMATCHED, report.unmatchedFaces);
+    collectFlags(faceFlags, NON_INVOLUTIVE, report.nonInvolutiveFaces);
+    collectFlags(faceFlags, CONTRADICTORY, report.contradictoryFaces);
+
+    vector<int> vertexShells;
+    vector<int> shellVertices;
+
+    int numberOfShells = findShells(meshData, vertexShells, shellVertices);
+
+    vector<char> seededShells(numberOfShells, 0);
+
+    for (int i = 0; i < meshData.numberOfVertices; i++)
+    {
+        if (tables.vertexSymmetry[i] != -1) { seededShells[vertexShells[i]] = 1; }
+    }
+
+    for (int shellIndex = 0; shellIndex < numberOfShells; shellIndex++)
+    {
+        if (!seededShells[shellIndex]) { report.unseededShells.push_back(shellVertices[shellIndex]); }
+    }
+}
@@ -0,0 +1,68 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_VALIDATION_H
+#define POLY_SYMMETRY_VALIDATION_H
+
+#include "meshTopology.h"
+#include "symmetryTables.h"
+
+#include <vector>
+
+using namespace std;
+
+/*
+    Problems found in the symmetry tables of a mesh, as ascending component
+    indices.
+
+    Unmatched components were never reached by the solver. Non-involutive
+    components map to a component that does not map back to them, or to an
+    index that is out of range. Contradictory components have a mirror that
+    disagrees with the topology: an edge or face whose vertices do not mirror
+    onto the vertices of its symmetrical component, or a vertex on the same
+    side as its mirror, or a vertex that mirrors onto itself off the center.
+
+    Unseeded shells are the lowest vertex index of each shell that has no
+    symmetry at all. Asymmetric vertices are matched vertices whose mirrored
+    position is further than the tolerance from the position of their mirror.
+*/
+struct SymmetryReport
+{
+    vector<int>     unmatchedVertices;
+    vector<int>     unmatchedEdges;
+    vector<int>     unmatchedFaces;
+
+    vector<int>     nonInvolutiveVertices;
+    vector<int>     nonInvolutiveEdges;
+    vector<int>     nonInvolutiveFaces;
+
+    vector<int>     contradictoryVertices;
+    vector<int>     contradictoryEdges;
+    vector<int>     contradictoryFaces;
+
+    vector<int>     unseededShells;
+    vector<int>     asymmetricVertices;
+
+    void            clear();
+    bool            isValid() const;
+};
+
+/*
+    Checks `tables` against the topology they were solved on, in time linear
+    in the size of the mesh. The tables must have one entry per component of
+    `meshData`. If `points` is not null, it holds 3 floats per vertex,
+    mirrored across the plane through the origin normal to `axis`, and the
+    positional check is run with `tolerance`.
+*/
+void        validateSymmetry(
+                const MeshTopology &meshData,
+                const SymmetryTables &tables,
+                const float* points,
+                int axis,
+                float tolerance,
+                SymmetryReport &report
+            );
+
+#endif
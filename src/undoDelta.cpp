@@ -0,0 +1,60 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "undoDelta.h"
+
+#include <vector>
+
+using namespace std;
+
+void encodeRowGaps(const vector<int> &rows, vector<unsigned char> &bytes)
+{
+    bytes.clear();
+    bytes.reserve(rows.size());
+
+    int previousRow = -1;
+
+    for (const int &row : rows)
+    {
+        unsigned int gap = (unsigned int) (row - previousRow - 1);
+
+        while (gap >= 0x80)
+        {
+            bytes.push_back((unsigned char) (gap | 0x80));
+            gap >>= 7;
+        }
+
+        bytes.push_back((unsigned char) gap);
+        previousRow = row;
+    }
+
+    bytes.shrink_to_fit();
+}
+
+void decodeRowGaps(const vector<unsigned char> &bytes, int numberOfRows, vector<int> &rows)
+{
+    rows.resize(numberOfRows);
+
+    size_t offset = 0;
+    int previousRow = -1;
+
+    for (int k = 0; k < numberOfRows; k++)
+    {
+        unsigned int gap = 0;
+        int shift = 0;
+
+        while (offset < bytes.size())
+        {
+            unsigned char byte = bytes[offset++];
+            gap |= (unsigned int) (byte & 0x7f) << shift;
+            shift += 7;
+
+            if ((byte & 0x80) == 0) { break; }
+        }
+
+        previousRow += (int) gap + 1;
+        rows[k] = previousRow;
+    }
+}
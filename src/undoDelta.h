@@ -0,0 +1,131 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef UNDO_DELTA_H
+#define UNDO_DELTA_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/*
+    Packs ascending row indices as varint gaps from the previous row, which
+    takes a byte per row for the clustered edits that flip and mirror make.
+*/
+void        encodeRowGaps(const vector<int> &rows, vector<unsigned char> &bytes);
+void        decodeRowGaps(const vector<unsigned char> &bytes, int numberOfRows, vector<int> &rows);
+
+/*
+    Undo record for an edit of a flat array of rows, such as mesh points or
+    skin weights. Only the rows that the edit changed are kept, along with
+    their values from before the edit, so the record stays small when most
+    of the array is untouched.
+
+    Rows are `rowSize` values that start `stride` values apart, which lets
+    the xyz of 4-float points be compared without the w.
+*/
+template <typename T>
+class RowDelta
+{
+public:
+    /* Records every row that differs between `oldValues` and `newValues`. */
+    void record(const T* oldValues, const T* newValues, int numberOfRows, int rowSize, int stride)
+    {
+        this->recordRows(nullptr, oldValues, newValues, numberOfRows, rowSize, stride);
+    }
+
+    /* 
+        Same as `record` for packed values of a subset of the rows, where the
+        k-th packed row is row `rowIndices[k]`. The indices must be ascending.
+    */
+    void recordRows(const int* rowIndices, const T* oldValues, const T* newValues, int numberOfRows, int rowSize, int stride)
+    {
+        this->clear();
+        this->rowSize = rowSize;
+
+        vector<int> rows;
+
+        for (int r = 0; r < numberOfRows; r++)
+        {
+            const T* oldRow = oldValues + (size_t) r * stride;
+            const T* newRow = newValues + (size_t) r * stride;
+
+            for (int c = 0; c < rowSize; c++)
+            {
+                if (oldRow[c] != newRow[c])
+                {
+                    rows.push_back(rowIndices == nullptr ? r : rowIndices[r]);
+                    this->oldValues.insert(this->oldValues.end(), oldRow, oldRow + rowSize);
+                    break;
+                }
+            }
+        }
+
+        this->count = (int) rows.size();
+        encodeRowGaps(rows, this->encodedRows);
+    }
+
+    /*
+        Takes `rows`, which an edit already knows it changed, and their values
+        from before the edit, packed `rowSize` values per row in `oldValues`.
+        The rows must be ascending. `oldValues` is moved into the record.
+    */
+    void assign(const vector<int> &rows, vector<T> &oldValues, int rowSize)
+    {
+        this->clear();
+        this->rowSize = rowSize;
+
+        this->count = (int) rows.size();
+        encodeRowGaps(rows, this->encodedRows);
+
+        this->oldValues.swap(oldValues);
+    }
+
+    /* Writes the recorded values back into `values`, which has the stride the rows were recorded with. */
+    void restore(T* values, int stride) const
+    {
+        vector<int> rows;
+        this->getRows(rows);
+
+        for (int k = 0; k < this->count; k++)
+        {
+            T* row = values + (size_t) rows[k] * stride;
+            const T* oldRow = this->oldValues.data() + (size_t) k * this->rowSize;
+
+            for (int c = 0; c < this->rowSize; c++) { row[c] = oldRow[c]; }
+        }
+    }
+
+    void getRows(vector<int> &rows) const
+    {
+        decodeRowGaps(this->encodedRows, this->count, rows);
+    }
+
+    /* Old values of the changed rows, packed `rowSize` values per row. */
+    const vector<T>& getOldValues() const   { return oldValues; }
+
+    int     numberOfRows() const            { return count; }
+    bool    empty() const                   { return count == 0; }
+    size_t  memoryUsage() const             { return encodedRows.size() + oldValues.size() * sizeof(T); }
+
+    void clear()
+    {
+        this->count = 0;
+        this->encodedRows.clear();
+        this->encodedRows.shrink_to_fit();
+        this->oldValues.clear();
+        this->oldValues.shrink_to_fit();
+    }
+
+private:
+    int                     rowSize = 0;
+    int                     count = 0;
+
+    vector<unsigned char>   encodedRows;
+    vector<T>               oldValues;
+};
+
+#endif
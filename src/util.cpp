@@ -10,25 +10,73 @@
 
 using namespace std;
 
-vector<int> intersection(vector<int> &a, vector<int> &b)
+int intersection(const IndexRange &a, const IndexRange &b, int* result)
 {
-    vector<int> result(a.size() + b.size());
-    vector<int>::iterator it; 
+    const int* ai = a.begin();
+    const int* bi = b.begin();
 
-    it = set_intersection(
-        a.begin(),
-        a.end(),
-        b.begin(),
-        b.end(),
-        result.begin()
-    );
+    int count = 0;
 
-    result.resize(it - result.begin());
+    while (ai != a.end() && bi != b.end())
+    {
+        if (*ai < *bi)
+        {
+            ai++;
+        } else if (*bi < *ai) {
+            bi++;
+        } else {
+            result[count++] = *ai;
+            ai++;
+            bi++;
+        }
+    }
+
+    return count;
+}
+
+void intersection(const IndexRange &a, const IndexRange &b, vector<int> &result)
+{
+    result.resize(min(a.size(), b.size()));
+
+    if (result.empty()) { return; }
+
+    result.resize(intersection(a, b, result.data()));
+}
+
+vector<int> intersection(const IndexRange &a, const IndexRange &b)
+{
+    vector<int> result;
+    intersection(a, b, result);
 
     return result;    
 }
 
-bool contains(vector<int> &items, int &value)
+int intersectionSize(const IndexRange &a, const IndexRange &b, int &firstItem)
+{
+    const int* ai = a.begin();
+    const int* bi = b.begin();
+
+    int count = 0;
+    firstItem = -1;
+
+    while (ai != a.end() && bi != b.end())
+    {
+        if (*ai < *bi)
+        {
+            ai++;
+        } else if (*bi < *ai) {
+            bi++;
+        } else {
+            if (count++ == 0) { firstItem = *ai; }
+            ai++;
+            bi++;
+        }
+    }
+
+    return count;
+}
+
+bool contains(const IndexRange &items, int value)
 {
     return find(items.begin(), items.end(), value) != items.end();
-}
\ No newline at end of file
+}
@@ -11,7 +11,47 @@
 
 using namespace std;
 
-vector<int> intersection(vector<int> &a, vector<int> &b);
-bool        contains(vector<int> &items, int &value);
+/*
+    Read-only view of a contiguous run of indices, such as one row of an 
+    AdjacencyTable. Implicitly constructed from a vector so that the helpers 
+    below accept either.
+*/
+struct IndexRange
+{
+    const int*      first = nullptr;
+    const int*      last = nullptr;
+
+    IndexRange() {}
+    IndexRange(const int* first, const int* last) : first(first), last(last) {}
+    IndexRange(const vector<int> &items) : first(items.data()), last(items.data() + items.size()) {}
+
+    const int*      begin() const               { return first; }
+    const int*      end() const                 { return last; }
+    size_t          size() const                { return (size_t) (last - first); }
+    bool            empty() const               { return first == last; }
+    const int&      operator[](size_t i) const  { return first[i]; }
+};
+
+/*
+    Intersections of sorted rows of indices. The solver runs them for every
+    edge it visits, so they write into a buffer of the caller instead of 
+    allocating the result.
+*/
+
+/*
+    Writes the items in both `a` and `b` to `result`, which must have room for
+    the smaller of the two, and returns the number of items written.
+*/
+int         intersection(const IndexRange &a, const IndexRange &b, int* result);
+
+/* Overwrites `result` with the items in both ranges, and only allocates if it is too small to hold them. */
+void        intersection(const IndexRange &a, const IndexRange &b, vector<int> &result);
+
+vector<int> intersection(const IndexRange &a, const IndexRange &b);
+
+/* Returns the number of items in both ranges, and sets `firstItem` to the first one, or -1. */
+int         intersectionSize(const IndexRange &a, const IndexRange &b, int &firstItem);
+
+bool        contains(const IndexRange &items, int value);
 
-#endif
\ No newline at end of file
+#endif
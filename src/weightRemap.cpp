@@ -0,0 +1,240 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "meshTopology.h"
+#include "parallel.h"
+#include "weightRemap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Rows are cheap to copy, so each task takes a few thousand of them.
+#define REMAP_GRAIN_SIZE 4096
+
+void getRemapSources(
+    const vector<int> &vertices,
+    const vector<int> &vertexSymmetry,
+    const vector<int> &vertexSides,
+    bool flip,
+    bool mirror,
+    int direction,
+    vector<int> &sourceVertices,
+    vector<char> &useOpposite
+) {
+    int numberOfVertices = (int) vertices.size();
+
+    sourceVertices.resize(numberOfVertices);
+    useOpposite.resize(numberOfVertices);
+
+    for (int k = 0; k < numberOfVertices; k++)
+    {
+        int i = vertices[k];
+        bool opposite = flip || (mirror && vertexSides[i] != 0 && vertexSides[i] != direction);
+
+        sourceVertices[k] = opposite ? vertexSymmetry[i] : i;
+        useOpposite[k] = (char) opposite;
+    }
+}
+
+void remapWeights(
+    const float* sourceWeights, 
+    float* destinationWeights, 
+    const vector<int> &vertices, 
+    const vector<int> &sourceVertices
+) {
+    const int* v = vertices.data();
+    const int* s = sourceVertices.data();
+
+    parallelForRange((int) vertices.size(), REMAP_GRAIN_SIZE, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int k = first; k < last; k++)
+        {
+            destinationWeights[v[k]] = sourceWeights[s[k]];
+        }
+    });
+}
+
+void remapWeightRows(
+    const double* sourceWeights,
+    int numberOfSourceColumns,
+    double* destinationWeights,
+    int numberOfDestinationColumns,
+    const vector<int> &vertices,
+    const vector<int> &sourceVertices,
+    const vector<char> &useOpposite,
+    const vector<int> &columns,
+    const vector<int> &oppositeColumns
+) {
+    int ns = numberOfSourceColumns;
+    int nd = numberOfDestinationColumns;
+
+    // When a column map is the identity, rows can be copied as a block.
+    auto isIdentity = [&](const vector<int> &c) 
+    {
+        if (ns != nd) { return false; }
+
+        for (int j = 0; j < nd; j++) 
+        { 
+            if (c[j] != j) { return false; } 
+        }
+
+        return true;
+    };
+
+    bool columnsAreIdentity = isIdentity(columns);
+    bool oppositeColumnsAreIdentity = isIdentity(oppositeColumns);
+
+    parallelForRange((int) vertices.size(), REMAP_GRAIN_SIZE / max(nd, 1) + 1, [&](int first, int last, int /*threadIndex*/)
+    {
+        for (int k = first; k < last; k++)
+        {
+            const double* sourceRow = sourceWeights + (size_t) sourceVertices[k] * ns;
+            double* destinationRow = destinationWeights + (size_t) vertices[k] * nd;
+
+            bool opposite = useOpposite[k] != 0;
+
+            if (opposite ? oppositeColumnsAreIdentity : columnsAreIdentity)
+            {
+                memcpy(destinationRow, sourceRow, nd * sizeof(double));
+                continue;
+            }
+
+            const int* c = opposite ? oppositeColumns.data() : columns.data();
+
+            for (int j = 0; j < nd; j++)
+            {
+                destinationRow[j] = c[j] == -1 ? 0.0 : sourceRow[c[j]];
+            }
+        }
+    });
+}
+
+void makeColumnTargets(const vector<int> &sourceColumns, int numberOfSourceColumns, AdjacencyTable &targets)
+{
+    targets.offsets.assign(numberOfSourceColumns + 1, 0);
+
+    for (const int &c : sourceColumns)
+    {
+        if (c != -1) { targets.offsets[c + 1]++; }
+    }
+
+    for (int c = 0; c < numberOfSourceColumns; c++)
+    {
+        targets.offsets[c + 1] += targets.offsets[c];
+    }
+
+    targets.indices.resize(targets.offsets[numberOfSourceColumns]);
+    vector<int> cursor(targets.offsets.begin(), targets.offsets.end() - 1);
+
+    for (int j = 0; j < (int) sourceColumns.size(); j++)
+    {
+        int c = sourceColumns[j];
+
+        if (c != -1) { targets.indices[cursor[c]++] = j; }
+    }
+}
+
+void remapSparseWeights(
+    const SparseWeights &source,
+    const vector<int> &sourceRows,
+    const vector<char> &useOpposite,
+    const AdjacencyTable &targets,
+    const AdjacencyTable &oppositeTargets,
+    bool normalize,
+    SparseWeights &result
+) {
+    result.clear();
+    result.offsets.reserve(sourceRows.size() + 1);
+
+    vector<pair<int, double>> row;
+
+    for (size_t r = 0; r < sourceRows.size(); r++)
+    {
+        const AdjacencyTable &columnTargets = useOpposite[r] ? oppositeTargets : targets;
+
+        int s = sourceRows[r];
+        row.clear();
+
+        for (int k = source.offsets[s]; k < source.offsets[s + 1]; k++)
+        {
+            for (const int &j : columnTargets[source.influences[k]])
+            {
+                row.push_back(make_pair(j, source.weights[k]));
+            }
+        }
+
+        sort(row.begin(), row.end());
+
+        double scale = 1.0;
+
+        if (normalize)
+        {
+            double sum = 0.0;
+
+            for (auto &w : row) { sum += w.second; }
+
+            if (sum > 0.0) { scale = 1.0 / sum; }
+        }
+
+        for (auto &w : row)
+        {
+            result.influences.push_back(w.first);
+            result.weights.push_back(w.second * scale);
+        }
+
+        result.offsets.push_back((int) result.influences.size());
+    }
+}
+
+void diffSparseWeights(const SparseWeights &oldWeights, const SparseWeights &newWeights, vector<WeightChange> &changes)
+{
+    changes.clear();
+
+    int numberOfRows = min(oldWeights.numberOfRows(), newWeights.numberOfRows());
+
+    for (int r = 0; r < numberOfRows; r++)
+    {
+        int a = oldWeights.offsets[r];
+        int b = newWeights.offsets[r];
+
+        int lastA = oldWeights.offsets[r + 1];
+        int lastB = newWeights.offsets[r + 1];
+
+        while (a < lastA || b < lastB)
+        {
+            int influenceA = a < lastA ? oldWeights.influences[a] : -1;
+            int influenceB = b < lastB ? newWeights.influences[b] : -1;
+
+            if (b == lastB || (a < lastA && influenceA < influenceB))
+            {
+                if (oldWeights.weights[a] != 0.0)
+                {
+                    changes.push_back({r, influenceA, oldWeights.weights[a], 0.0});
+                }
+
+                a++;
+            } else if (a == lastA || influenceB < influenceA) {
+                if (newWeights.weights[b] != 0.0)
+                {
+                    changes.push_back({r, influenceB, 0.0, newWeights.weights[b]});
+                }
+
+                b++;
+            } else {
+                if (oldWeights.weights[a] != newWeights.weights[b])
+                {
+                    changes.push_back({r, influenceA, oldWeights.weights[a], newWeights.weights[b]});
+                }
+
+                a++;
+                b++;
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_WEIGHT_REMAP_H
+#define POLY_SYMMETRY_WEIGHT_REMAP_H
+
+#include "meshTopology.h"
+
+#include <vector>
+
+using namespace std;
+
+/*
+    Skin weights that only store the nonzero influences of each row. Row `r` 
+    holds the influence columns `influences[offsets[r]]` to 
+    `influences[offsets[r + 1]]` in ascending order, with their weights at 
+    the same positions in `weights`.
+*/
+struct SparseWeights
+{
+    vector<int>     offsets = vector<int>(1, 0);
+    vector<int>     influences;
+    vector<double>  weights;
+
+    int             numberOfRows() const        { return (int) offsets.size() - 1; }
+
+    void            clear()                     { offsets.assign(1, 0); influences.clear(); weights.clear(); }
+};
+
+/* One weight that differs between two SparseWeights. */
+struct WeightChange
+{
+    int             row;
+    int             influence;
+    double          oldWeight;
+    double          newWeight;
+};
+
+/*
+    Works out where each of `vertices` takes its weights from. When flipping, 
+    every vertex takes the weights of its opposite vertex and influences. When 
+    mirroring, vertices on the center and on the `direction` side (1 for left, 
+    -1 for right) keep their own weights and the others are flipped. 
+    Otherwise every vertex keeps its own weights.
+*/
+void        getRemapSources(
+                const vector<int> &vertices,
+                const vector<int> &vertexSymmetry,
+                const vector<int> &vertexSides,
+                bool flip,
+                bool mirror,
+                int direction,
+                vector<int> &sourceVertices,
+                vector<char> &useOpposite
+            );
+
+/*
+    Sets `destinationWeights[vertices[k]]` to `sourceWeights[sourceVertices[k]]`, 
+    in parallel. `vertices` must not contain duplicates.
+*/
+void        remapWeights(
+                const float* sourceWeights, 
+                float* destinationWeights, 
+                const vector<int> &vertices, 
+                const vector<int> &sourceVertices
+            );
+
+/*
+    Dense version of `remapSparseWeights` for weights stored as one row of 
+    `numberOf*Columns` weights per vertex. Row `vertices[k]` of the destination 
+    is gathered from row `sourceVertices[k]` of the source through `columns`, 
+    or `oppositeColumns` where `useOpposite[k]` is set. A column of -1 gets no 
+    weight. Vertices are processed in parallel, and must not contain duplicates.
+*/
+void        remapWeightRows(
+                const double* sourceWeights,
+                int numberOfSourceColumns,
+                double* destinationWeights,
+                int numberOfDestinationColumns,
+                const vector<int> &vertices,
+                const vector<int> &sourceVertices,
+                const vector<char> &useOpposite,
+                const vector<int> &columns,
+                const vector<int> &oppositeColumns
+            );
+
+/*
+    Inverts a destination column -> source column table (-1 for none) into 
+    a table listing the destination columns each source column is copied to.
+*/
+void        makeColumnTargets(const vector<int> &sourceColumns, int numberOfSourceColumns, AdjacencyTable &targets);
+
+/*
+    Builds row `r` of `result` from row `sourceRows[r]` of `source`, copying 
+    each weight to the destination columns listed in `targets`, or in 
+    `oppositeTargets` where `useOpposite[r]` is set. When `normalize` is set, 
+    each new row is scaled to sum to one.
+*/
+void        remapSparseWeights(
+                const SparseWeights &source,
+                const vector<int> &sourceRows,
+                const vector<char> &useOpposite,
+                const AdjacencyTable &targets,
+                const AdjacencyTable &oppositeTargets,
+                bool normalize,
+                SparseWeights &result
+            );
+
+/*
+    Lists every weight that differs between rows of `oldWeights` and 
+    `newWeights`, including weights that have been added or removed.
+*/
+void        diffSparseWeights(const SparseWeights &oldWeights, const SparseWeights &newWeights, vector<WeightChange> &changes);
+
+#endif
@@ -0,0 +1,79 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "wildcard.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+WildcardPattern::WildcardPattern(const string &pattern)
+{
+    size_t first = 0;
+    size_t star = pattern.find('*');
+
+    while (star != string::npos)
+    {
+        segments.push_back(pattern.substr(first, star - first));
+
+        first = star + 1;
+        star = pattern.find('*', first);
+    }
+
+    segments.push_back(pattern.substr(first));
+}
+
+bool WildcardPattern::match(const string &name, string &captured) const
+{
+    captured.clear();
+
+    const string &prefix = segments.front();
+
+    if (segments.size() == 1) { return name == prefix; }
+
+    const string &suffix = segments.back();
+
+    if (name.size() < prefix.size() + suffix.size()) { return false; }
+    if (name.compare(0, prefix.size(), prefix) != 0) { return false; }
+    if (name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) { return false; }
+
+    return this->matchSegments(name, 1, prefix.size(), name.size() - suffix.size(), captured);
+}
+
+/*
+    Matches the wildcard before `segments[segmentIndex]` and everything after 
+    it within [first, last). The wildcard tries the longest run first and 
+    only gives characters back when the rest of the pattern fails to match.
+*/
+bool WildcardPattern::matchSegments(const string &name, size_t segmentIndex, size_t first, size_t last, string &captured) const
+{
+    if (segmentIndex == segments.size() - 1)
+    {
+        captured.append(name, first, last - first);
+        return true;
+    }
+
+    const string &segment = segments[segmentIndex];
+
+    if (last - first < segment.size()) { return false; }
+
+    for (size_t position = last - segment.size() + 1; position-- > first; )
+    {
+        if (name.compare(position, segment.size(), segment) != 0) { continue; }
+
+        size_t capturedLength = captured.size();
+        captured.append(name, first, position - first);
+
+        if (this->matchSegments(name, segmentIndex + 1, position + segment.size(), last, captured))
+        {
+            return true;
+        }
+
+        captured.resize(capturedLength);
+    }
+
+    return false;
+}
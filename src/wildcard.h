@@ -0,0 +1,39 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#ifndef POLY_SYMMETRY_WILDCARD_H
+#define POLY_SYMMETRY_WILDCARD_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+    Name pattern where each '*' matches any run of characters, such as 
+    "L_*" or "*_lf_*". The pattern is split into its literal segments once, 
+    so matching is a prefix and suffix compare plus a search for each inner 
+    segment. Every '*' is greedy, which gives the same captures as replacing 
+    it with "(.*)" in a regular expression.
+*/
+class WildcardPattern
+{
+public:
+                        WildcardPattern(const string &pattern);
+
+    /*
+        Returns true if `name` matches the whole pattern, in which case 
+        `captured` is set to the text matched by all of the wildcards. 
+    */
+    bool                match(const string &name, string &captured) const;
+
+private:
+    bool                matchSegments(const string &name, size_t segmentIndex, size_t first, size_t last, string &captured) const;
+
+private:
+    vector<string>      segments;
+};
+
+#endif